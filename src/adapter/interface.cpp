@@ -23,6 +23,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include <interface.h>
 #include "market/ctp_api_market.h"
 #include "market/tap_api_market.h"
+#include "market/composite_market.h"
 
 #include "trader/ctp_api_trader.h"
 #include "trader/tap_api_trader.h"
@@ -46,6 +47,15 @@ lt::actual_market* create_actual_market(const lt::params& config)
 	return nullptr;
 }
 
+lt::actual_market* create_composite_market(const std::vector<lt::actual_market*>& feeds)
+{
+	if (feeds.empty())
+	{
+		return nullptr;
+	}
+	return new composite_market(_id_excg_map, feeds);
+}
+
 void destory_actual_market(actual_market*& api)
 {
 	if (nullptr != api)
@@ -0,0 +1,166 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "composite_market.h"
+#include <log_wapper.hpp>
+#include <market_journal.hpp>
+
+using namespace lt;
+using namespace lt::driver;
+
+composite_market::composite_market(std::unordered_map<std::string, std::string>& id_excg_map, const std::vector<actual_market*>& feeds)
+	:sync_actual_market(id_excg_map)
+	, _feeds(feeds)
+	, _stats(feeds.size())
+{
+	for (size_t i = 0; i < _feeds.size(); i++)
+	{
+		_feeds[i]->bind_event(market_event_type::MET_TickReceived, std::bind(&composite_market::handle_tick, this, i, std::placeholders::_1));
+	}
+}
+
+composite_market::~composite_market()
+{
+	for (auto& it : _feeds)
+	{
+		it->clear_event();
+		delete it;
+	}
+	_feeds.clear();
+}
+
+bool composite_market::login()
+{
+	size_t login_count = 0;
+	for (size_t i = 0; i < _feeds.size(); i++)
+	{
+		if (_feeds[i]->login())
+		{
+			login_count++;
+		}
+		else
+		{
+			LOG_ERROR("composite_market feed login failed :", i);
+		}
+	}
+	//有一路登录成功就可以交易
+	LOG_INFO("composite_market login :", login_count, _feeds.size());
+	return login_count > 0;
+}
+
+void composite_market::logout()
+{
+	print_stat();
+	for (auto& it : _feeds)
+	{
+		it->logout();
+	}
+	_sequence.clear();
+}
+
+void composite_market::subscribe(const std::set<code_t>& codes)
+{
+	for (auto& it : _feeds)
+	{
+		it->subscribe(codes);
+	}
+}
+
+void composite_market::unsubscribe(const std::set<code_t>& codes)
+{
+	for (auto& it : _feeds)
+	{
+		it->unsubscribe(codes);
+	}
+	for (const auto& code : codes)
+	{
+		_sequence.erase(code);
+	}
+}
+
+void composite_market::update()
+{
+	for (auto& it : _feeds)
+	{
+		it->update();
+	}
+}
+
+void composite_market::handle_tick(size_t index, const std::vector<std::any>& param)
+{
+	if (param.size() < 2)
+	{
+		return;
+	}
+	const auto& tick = std::any_cast<const tick_info&>(param[0]);
+	//没有带接收时间的行情源按处理时间算
+	int64_t receive_time = param.size() >= 3 ? std::any_cast<int64_t>(param[2]) : journal_receive_time();
+	auto it = _sequence.find(tick.id);
+	if (it == _sequence.end())
+	{
+		it = _sequence.insert(std::make_pair(tick.id, sequence_state())).first;
+	}
+	sequence_state& state = it->second;
+	if (tick.trading_day > state.trading_day || (tick.trading_day == state.trading_day && (tick.time > state.time || (tick.time == state.time && tick.volume > state.volume))))
+	{
+		//新行情，第一份直接发布
+		state.trading_day = tick.trading_day;
+		state.time = tick.time;
+		state.volume = tick.volume;
+		state.winner = index;
+		state.receive_time = receive_time;
+		_stats[index].win_count++;
+		this->trigger(market_event_type::MET_TickReceived, param);
+		return;
+	}
+	if (tick.trading_day != state.trading_day || tick.time != state.time || tick.volume != state.volume)
+	{
+		_stats[index].stale_count++;
+		return;
+	}
+	//重复行情：各路队列按顺序处理，后处理的一份可能更早到达，统计按接收时间修正
+	if (receive_time < state.receive_time)
+	{
+		_stats[state.winner].win_count--;
+		_stats[index].win_count++;
+		std::swap(state.winner, index);
+		std::swap(state.receive_time, receive_time);
+	}
+	const int64_t lead = receive_time - state.receive_time;
+	feed_stat& stat = _stats[state.winner];
+	stat.lead_count++;
+	stat.total_lead += lead;
+	if (lead > stat.max_lead)
+	{
+		stat.max_lead = lead;
+	}
+}
+
+void composite_market::print_stat()const
+{
+	for (size_t i = 0; i < _stats.size(); i++)
+	{
+		const feed_stat& stat = _stats[i];
+		const int64_t average_lead = stat.lead_count > 0 ? stat.total_lead / static_cast<int64_t>(stat.lead_count) : 0;
+		LOG_INFO("composite_market feed :", i, "win :", stat.win_count, "lead :", stat.lead_count, "average lead ns :", average_lead, "max lead ns :", stat.max_lead, "stale :", stat.stale_count);
+	}
+}
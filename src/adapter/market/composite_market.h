@@ -0,0 +1,101 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include <define.h>
+#include <market_api.h>
+#include <event_center.hpp>
+
+namespace lt::driver
+{
+	/*
+	*	多路行情仲裁
+	*	同时登录多个行情源，按（合约，交易日，交易所时间，成交量）去重，每条行情只发布最先处理到的一份，
+	*	并按本地接收时间统计每一路领先的次数和领先的时长
+	*/
+	class composite_market : public sync_actual_market
+	{
+		struct feed_stat
+		{
+			//最先到达的次数
+			uint64_t win_count;
+			//被本路领先的副本数
+			uint64_t lead_count;
+			//累计领先时长（纳秒）
+			int64_t total_lead;
+			//最大领先时长（纳秒）
+			int64_t max_lead;
+			//比已发布行情还旧的数据
+			uint64_t stale_count;
+
+			feed_stat() :win_count(0), lead_count(0), total_lead(0), max_lead(0), stale_count(0) {}
+		};
+
+		struct sequence_state
+		{
+			//换日以后时间和累计成交量都从头开始，先比较交易日
+			uint32_t	trading_day;
+			daytm_t		time;
+			uint64_t	volume;
+			//最先到达的行情源和接收时间
+			size_t		winner;
+			int64_t		receive_time;
+
+			sequence_state() :trading_day(0), time(0), volume(0), winner(0), receive_time(0) {}
+		};
+
+	public:
+
+		//feeds的所有权转给composite_market
+		composite_market(std::unordered_map<std::string, std::string>& id_excg_map, const std::vector<actual_market*>& feeds);
+
+		virtual ~composite_market();
+
+	public:
+
+		virtual bool login() override;
+
+		virtual void logout() override;
+
+		virtual void subscribe(const std::set<code_t>& codes) override;
+
+		virtual void unsubscribe(const std::set<code_t>& codes) override;
+
+		virtual void update() override;
+
+	private:
+
+		void handle_tick(size_t index, const std::vector<std::any>& param);
+
+		void print_stat()const;
+
+	private:
+
+		std::vector<actual_market*>		_feeds;
+
+		std::vector<feed_stat>			_stats;
+
+		//按合约记录最近发布的行情序号，只在逻辑线程访问
+		std::map<code_t, sequence_state>	_sequence;
+
+	};
+}
@@ -36,6 +36,9 @@ ctp_api_market::ctp_api_market(std::unordered_map<std::string, std::string>& id_
 	,_reqid(0)
 	,_process_mutex(_mutex)
 	, _is_inited(false)
+	, _instrument_lookup(nullptr)
+	, _trading_day_key(0)
+	, _trading_day(0)
 {
 	try
 	{
@@ -48,6 +51,24 @@ ctp_api_market::ctp_api_market(std::unordered_map<std::string, std::string>& id_
 	{
 		LOG_ERROR("ctp_api_market config error ");
 	}
+	try
+	{
+		const auto& journal_path = config.get<std::string>("journal_path");
+		size_t roll_size = 1024;
+		try
+		{
+			roll_size = config.get<size_t>("journal_roll_size");
+		}
+		catch (...)
+		{
+			//不配置每个文件最大1G
+		}
+		_journal = std::make_shared<market_journal>(journal_path, roll_size * 1024 * 1024);
+	}
+	catch (...)
+	{
+		//不配置不落盘
+	}
 	_market_handle = dll_helper::load_library("thostmduserapi_se");
 	if (_market_handle)
 	{
@@ -83,6 +104,7 @@ bool ctp_api_market::login()
 	{
 		std::filesystem::create_directories(path_buff);
 	}	
+	rebuild_lookup();
 	_md_api = _ctp_creator(path_buff,false,false);
 	_md_api->RegisterSpi(this);
 	_md_api->RegisterFront((char*)_front_addr.c_str());
@@ -103,6 +125,8 @@ void ctp_api_market::logout()
 		_md_api->Release();
 		_md_api = nullptr;
 	}
+	_instrument_lookup.store(nullptr);
+	_lookup_history.clear();
 	_is_inited = false;
 }
 
@@ -129,6 +153,8 @@ void ctp_api_market::OnRspUserLogin( CThostFtdcRspUserLoginField *pRspUserLogin,
 	if(bIsLast)
 	{
 		LOG_INFO("UserLogin : Market data server logined, {%s} {%s}", pRspUserLogin->TradingDay, pRspUserLogin->UserID);
+		//新会话重新解析交易日
+		_trading_day_key = 0;
 		//订阅行情数据
 		do_subscribe();
 		if(!_is_inited)
@@ -158,23 +184,41 @@ void ctp_api_market::OnRtnDepthMarketData( CThostFtdcDepthMarketDataField *pDept
 	{
 		return;
 	}
-	
+	//进入回调就取本地接收时间
+	const int64_t receive_time = journal_receive_time();
 	PROFILE_INFO(pDepthMarketData->InstrumentID);
 	LOG_DEBUG("MarketData =", pDepthMarketData->InstrumentID, pDepthMarketData->LastPrice, pDepthMarketData->UpdateTime, pDepthMarketData->UpdateMillisec);
-	const char * excg_id = pDepthMarketData->ExchangeID;
-	auto excg_it = _id_excg_map.find(pDepthMarketData->InstrumentID);
-	if (excg_it != _id_excg_map.end())
+	const instrument_lookup* lookup = _instrument_lookup.load(std::memory_order_acquire);
+	const code_t* code = lookup ? lookup->find(pDepthMarketData->InstrumentID) : nullptr;
+	if (code == nullptr)
 	{
-		excg_id = excg_it->second.c_str();
+		//不在订阅表里的合约（比如订阅还没生效），按行情里的交易所构造
+		code_t unknown(pDepthMarketData->InstrumentID, pDepthMarketData->ExchangeID);
+		publish_tick(pDepthMarketData, unknown, receive_time);
+	}
+	else
+	{
+		publish_tick(pDepthMarketData, *code, receive_time);
+	}
+}
+
+void ctp_api_market::publish_tick(const CThostFtdcDepthMarketDataField* pDepthMarketData, const code_t& code, int64_t receive_time)
+{
+	uint64_t trading_day_key = 0;
+	std::memcpy(&trading_day_key, pDepthMarketData->TradingDay, sizeof(trading_day_key));
+	if (trading_day_key != _trading_day_key)
+	{
+		_trading_day_key = trading_day_key;
+		_trading_day = static_cast<uint32_t>(std::atoi(pDepthMarketData->TradingDay));
 	}
 	PROFILE_DEBUG(pDepthMarketData->InstrumentID);
 	tick_info tick_data(
-		code_t(pDepthMarketData->InstrumentID, excg_id),
-		make_daytm(pDepthMarketData->UpdateTime, static_cast<uint32_t>(pDepthMarketData->UpdateMillisec)),
+		code,
+		decode_daytm(pDepthMarketData->UpdateTime, static_cast<uint32_t>(pDepthMarketData->UpdateMillisec)),
 		pDepthMarketData->LastPrice,
 		pDepthMarketData->Volume,
 		pDepthMarketData->OpenInterest,
-		std::atoi(pDepthMarketData->TradingDay),
+		_trading_day,
 		{
 			std::make_pair(pDepthMarketData->BidPrice1, pDepthMarketData->BidVolume1),
 			std::make_pair(pDepthMarketData->BidPrice2, pDepthMarketData->BidVolume2),
@@ -200,8 +244,12 @@ void ctp_api_market::OnRtnDepthMarketData( CThostFtdcDepthMarketDataField *pDept
 		pDepthMarketData->PreSettlementPrice
 	);
 
+	if (_journal)
+	{
+		_journal->write(tick_data, extend_data, receive_time);
+	}
 	PROFILE_DEBUG(pDepthMarketData->InstrumentID);
-	this->fire_event(market_event_type::MET_TickReceived, tick_data, extend_data);
+	this->fire_event(market_event_type::MET_TickReceived, tick_data, extend_data, receive_time);
 	PROFILE_DEBUG(pDepthMarketData->InstrumentID);
 }
 
@@ -288,6 +336,7 @@ void ctp_api_market::subscribe(const std::set<code_t>& code_list)
 	{
 		(_id_excg_map)[it.get_id()] = it.get_excg();
 	}
+	rebuild_lookup();
 	do_subscribe();
 }
 
@@ -303,7 +352,13 @@ void ctp_api_market::unsubscribe(const std::set<code_t>& code_list)
 			_id_excg_map.erase(n);
 		}
 	}
+	rebuild_lookup();
 	do_unsubscribe(delete_code_list);
 }
 
-
+void ctp_api_market::rebuild_lookup()
+{
+	auto lookup = std::make_unique<instrument_lookup>(_id_excg_map);
+	_instrument_lookup.store(lookup.get(), std::memory_order_release);
+	_lookup_history.emplace_back(std::move(lookup));
+}
@@ -29,6 +29,8 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include <params.hpp>
 #include <CTP_V6.6.9_20220920/ThostFtdcMdApi.h>
 #include <dll_helper.hpp>
+#include "market_journal.h"
+#include "instrument_lookup.hpp"
 
 namespace lt::driver
 {
@@ -82,6 +84,14 @@ namespace lt::driver
 		void do_subscribe();
 
 		void do_unsubscribe(const std::vector<code_t>& code_list);
+		/*
+		 *	订阅变化后重建合约查找表
+		 */
+		void rebuild_lookup();
+		/*
+		 *	解码并发布行情
+		 */
+		void publish_tick(const CThostFtdcDepthMarketDataField* pDepthMarketData, const code_t& code, int64_t receive_time);
 
 	private:
 
@@ -100,10 +110,21 @@ namespace lt::driver
 
 		bool _is_inited;
 
+		//行情回调线程只读当前的查找表，替换下来的表保留到登出，避免回调里读到已释放的表
+		std::atomic<const instrument_lookup*>			_instrument_lookup;
+		std::vector<std::unique_ptr<instrument_lookup>>	_lookup_history;
+
+		//本次会话的交易日（TradingDay前8字节相同时直接用缓存）
+		uint64_t			_trading_day_key;
+		uint32_t			_trading_day;
+
 		typedef CThostFtdcMdApi* (*market_creator)(const char*, const bool, const bool);
 		market_creator					_ctp_creator;
 		dll_handle						_market_handle;
 
+		//行情落盘（配置了journal_path才开启）
+		std::shared_ptr<market_journal>	_journal;
+
 	};
 }
 
@@ -0,0 +1,104 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include <define.h>
+#include <define_types.hpp>
+#include <unordered_map>
+#include <vector>
+
+namespace lt::driver
+{
+	/*
+	*	已订阅合约查找表（开放寻址，容量为2的幂，装载率不超过1/4）
+	*	订阅时按合约代码字节生成，行情回调里直接拿到构造好的code_t，不再构造std::string和code_t
+	*	表生成以后只读，订阅变化时整表替换
+	*/
+	class instrument_lookup
+	{
+		struct slot
+		{
+			uint64_t hash;
+			code_t code;
+
+			slot() :hash(0) {}
+		};
+
+		std::vector<slot> _slots;
+
+		size_t _mask;
+
+	public:
+
+		instrument_lookup(const std::unordered_map<std::string, std::string>& id_excg_map) :_mask(0)
+		{
+			size_t capacity = 16;
+			while (capacity < id_excg_map.size() * 4)
+			{
+				capacity <<= 1;
+			}
+			_slots.resize(capacity);
+			_mask = capacity - 1;
+			for (const auto& it : id_excg_map)
+			{
+				const uint64_t value = hash(it.first.c_str());
+				size_t index = static_cast<size_t>(value) & _mask;
+				while (_slots[index].hash != 0)
+				{
+					index = (index + 1) & _mask;
+				}
+				_slots[index].hash = value;
+				_slots[index].code = code_t(it.first.c_str(), it.second.c_str());
+			}
+		}
+
+		//没有订阅的合约返回nullptr
+		const code_t* find(const char* id)const
+		{
+			const uint64_t value = hash(id);
+			size_t index = static_cast<size_t>(value) & _mask;
+			while (_slots[index].hash != 0)
+			{
+				if (_slots[index].hash == value && std::strcmp(_slots[index].code.get_id(), id) == 0)
+				{
+					return &_slots[index].code;
+				}
+				index = (index + 1) & _mask;
+			}
+			return nullptr;
+		}
+
+	private:
+
+		//FNV-1a，0保留给空槽位
+		static uint64_t hash(const char* id)
+		{
+			uint64_t value = 14695981039346656037ULL;
+			for (const char* c = id; *c != '\0'; c++)
+			{
+				value ^= static_cast<uint8_t>(*c);
+				value *= 1099511628211ULL;
+			}
+			return value == 0 ? 1 : value;
+		}
+	};
+}
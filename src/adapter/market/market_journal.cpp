@@ -0,0 +1,152 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "market_journal.h"
+#include <filesystem>
+#include <log_wapper.hpp>
+
+using namespace lt;
+using namespace lt::driver;
+
+market_journal::market_journal(const std::string& journal_path, size_t roll_size) :
+	_journal_path(journal_path),
+	_roll_size(roll_size),
+	_thread(nullptr),
+	_is_runing(true),
+	_file_trading_day(0),
+	_file_sequence(0),
+	_file_size(0),
+	_drop_count(0)
+{
+	if (!std::filesystem::exists(_journal_path))
+	{
+		std::filesystem::create_directories(_journal_path);
+	}
+	_thread = new std::thread(&market_journal::run, this);
+}
+
+market_journal::~market_journal()
+{
+	_is_runing = false;
+	if (_thread)
+	{
+		_thread->join();
+		delete _thread;
+		_thread = nullptr;
+	}
+	if (_file.is_open())
+	{
+		_file.close();
+	}
+	if (_drop_count > 0)
+	{
+		LOG_WARNING("market_journal drop record :", _drop_count.load());
+	}
+}
+
+void market_journal::write(const tick_info& tick, const tick_extend& extend, int64_t receive_time)
+{
+	journal_record record(tick, extend, receive_time);
+	if (!_queue.insert(&record))
+	{
+		_drop_count.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void market_journal::run()
+{
+	std::vector<journal_record> batch(JOURNAL_BATCH_SIZE);
+	while (true)
+	{
+		//先读标志再取数据，退出前把队列里剩下的记录写完
+		bool is_runing = _is_runing.load();
+		size_t count = 0;
+		while (count < JOURNAL_BATCH_SIZE && _queue.remove(batch[count]))
+		{
+			count++;
+		}
+		if (count > 0)
+		{
+			write_batch(batch.data(), count);
+			continue;
+		}
+		if (!is_runing)
+		{
+			break;
+		}
+		_file.flush();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+void market_journal::write_batch(const journal_record* records, size_t count)
+{
+	size_t begin = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		if (records[i].trading_day != _file_trading_day || _file_size >= _roll_size)
+		{
+			if (i > begin && _file.is_open())
+			{
+				_file.write(reinterpret_cast<const char*>(records + begin), sizeof(journal_record) * (i - begin));
+			}
+			roll_file(records[i].trading_day);
+			begin = i;
+		}
+		_file_size += sizeof(journal_record);
+	}
+	if (count > begin && _file.is_open())
+	{
+		_file.write(reinterpret_cast<const char*>(records + begin), sizeof(journal_record) * (count - begin));
+	}
+}
+
+void market_journal::roll_file(uint32_t trading_day)
+{
+	if (_file.is_open())
+	{
+		_file.close();
+	}
+	if (trading_day != _file_trading_day)
+	{
+		_file_trading_day = trading_day;
+		_file_sequence = 0;
+	}
+	//同一个交易日重启时接着已有的序号往后写，不覆盖
+	char filename[64] = { 0 };
+	do
+	{
+		sprintf(filename, "%u_%04u.mj", _file_trading_day, _file_sequence++);
+	} while (std::filesystem::exists(std::filesystem::path(_journal_path) / filename));
+	
+	const auto file_path = std::filesystem::path(_journal_path) / filename;
+	_file.open(file_path, std::ios::binary | std::ios::out);
+	if (!_file.is_open())
+	{
+		LOG_ERROR("market_journal cant open file :", file_path.string());
+		return;
+	}
+	journal_header header = { JOURNAL_MAGIC, JOURNAL_VERSION, static_cast<uint32_t>(sizeof(journal_record)), _file_trading_day };
+	_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	_file_size = sizeof(header);
+	LOG_INFO("market_journal roll file :", file_path.string());
+}
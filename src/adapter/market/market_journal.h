@@ -0,0 +1,86 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include <define.h>
+#include <market_journal.hpp>
+#include <ringbuffer.hpp>
+#include <fstream>
+#include <thread>
+#include <atomic>
+
+namespace lt::driver
+{
+	/***
+	*
+	* 行情落盘
+	* 行情回调里只把记录放进SPSC队列（队列满了直接丢弃并计数，不阻塞回调），
+	* 由独立的写线程批量写入文件，交易日变化或者文件超过大小限制时滚动新文件
+	*/
+	class market_journal
+	{
+		static constexpr size_t JOURNAL_QUEUE_SIZE = 16384;
+
+		static constexpr size_t JOURNAL_BATCH_SIZE = 256;
+
+	private:
+
+		std::string _journal_path;
+
+		//单个文件最大字节数
+		size_t _roll_size;
+
+		Ringbuffer<journal_record, JOURNAL_QUEUE_SIZE, false, 64> _queue;
+
+		std::thread* _thread;
+
+		std::atomic<bool> _is_runing;
+
+		std::ofstream _file;
+
+		uint32_t _file_trading_day;
+
+		uint32_t _file_sequence;
+
+		size_t _file_size;
+
+		//队列满丢弃的记录数
+		std::atomic<uint64_t> _drop_count;
+
+	public:
+
+		market_journal(const std::string& journal_path, size_t roll_size);
+
+		~market_journal();
+
+		//行情回调线程调用
+		void write(const tick_info& tick, const tick_extend& extend, int64_t receive_time);
+
+	private:
+
+		void run();
+
+		void write_batch(const journal_record* records, size_t count);
+
+		void roll_file(uint32_t trading_day);
+	};
+}
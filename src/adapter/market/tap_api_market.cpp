@@ -50,6 +50,24 @@ tap_api_market::tap_api_market(std::unordered_map<std::string, std::string>& id_
 	{
 		LOG_ERROR("tap_api_market init error ");
 	}
+	try
+	{
+		const auto& journal_path = config.get<std::string>("journal_path");
+		size_t roll_size = 1024;
+		try
+		{
+			roll_size = config.get<size_t>("journal_roll_size");
+		}
+		catch (...)
+		{
+			//不配置每个文件最大1G
+		}
+		_journal = std::make_shared<market_journal>(journal_path, roll_size * 1024 * 1024);
+	}
+	catch (...)
+	{
+		//不配置不落盘
+	}
 	_market_handle = dll_helper::load_library("TapQuoteAPI");
 	if (_market_handle)
 	{
@@ -158,7 +176,8 @@ void tap_api_market::OnRtnQuote(const TapAPIQuoteWhole* info)noexcept
 	{
 		return;
 	}
-	
+	//进入回调就取本地接收时间
+	const int64_t receive_time = journal_receive_time();
 	PROFILE_INFO(info->Contract.Commodity.CommodityNo);
 	auto tick_data = tick_info(
 		code_t(info->Contract.Commodity.CommodityNo, info->Contract.ContractNo1, info->Contract.Commodity.ExchangeNo),
@@ -191,8 +210,12 @@ void tap_api_market::OnRtnQuote(const TapAPIQuoteWhole* info)noexcept
 		info->QLimitDownPrice,
 		info->QPreSettlePrice
 	);
+	if (_journal)
+	{
+		_journal->write(tick_data, extend_data, receive_time);
+	}
 	PROFILE_DEBUG(tick.id.get_id());
-	this->fire_event(market_event_type::MET_TickReceived, tick_data);
+	this->fire_event(market_event_type::MET_TickReceived, tick_data, extend_data, receive_time);
 }
 
 void tap_api_market::OnRspSubscribeQuote(TAPIUINT32 sessionID, TAPIINT32 errorCode, TAPIYNFLAG isLast, const TapAPIQuoteWhole* info)noexcept
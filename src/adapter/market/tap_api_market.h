@@ -29,6 +29,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include <params.hpp>
 #include <TAP_V9_20200808/TapQuoteAPI.h>
 #include <dll_helper.hpp>
+#include "market_journal.h"
 
 namespace lt::driver
 {
@@ -91,6 +92,9 @@ namespace lt::driver
 
 		dll_handle						_market_handle;
 
+		//行情落盘（配置了journal_path才开启）
+		std::shared_ptr<market_journal>	_journal;
+
 		bool _is_inited;
 		uint32_t _trading_day;
 	};
@@ -23,6 +23,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include "ctp_api_trader.h"
 #include <filesystem>
 #include <time_utils.hpp>
+#include <string_helper.hpp>
 
 using namespace lt;
 using namespace lt::driver;
@@ -30,17 +31,19 @@ using namespace lt::driver;
 ctp_api_trader::ctp_api_trader(std::unordered_map<std::string, std::string>& id_excg_map, const params& config)
 	:asyn_actual_trader(id_excg_map)
 	, _td_api(nullptr)
-	, _reqid(0)
+	, _reqid(LOGIN_REQUEST_ID + 1)
 	, _front_id(0)
 	, _session_id(0)
 	, _order_ref(0)
 	, _is_runing(false)
-	, _process_mutex(_mutex)
+	, _login_timeout(10000)
+	, _query_timeout(5000)
+	, _is_position_reset(false)
+	, _is_order_reset(false)
 	, _is_inited(false)
 	, _is_connected(false)
-	, _is_sync_wait(false)
+	, _primary(nullptr)
 	, _trader_handle(nullptr)
-	, _is_in_query(false)
 {
 	try
 	{
@@ -56,6 +59,22 @@ ctp_api_trader::ctp_api_trader(std::unordered_map<std::string, std::string>& id_
 	{
 		LOG_ERROR("ctp_api_trader config error ");
 	}
+	try
+	{
+		_login_timeout = std::chrono::milliseconds(config.get<uint32_t>("login_timeout"));
+	}
+	catch (...)
+	{
+		//不配置登录超时10秒
+	}
+	try
+	{
+		_query_timeout = std::chrono::milliseconds(config.get<uint32_t>("query_timeout"));
+	}
+	catch (...)
+	{
+		//不配置查询超时5秒
+	}
 	_trader_handle = dll_helper::load_library("thosttraderapi_se");
 	if(_trader_handle)
 	{
@@ -87,7 +106,8 @@ bool ctp_api_trader::login()
 {
 	_is_runing = true;
 	char path_buff[64];
-	sprintf(path_buff,"td_flow/%s/%s/", _broker_id.c_str(), _userid.c_str());
+	//同一个账号的热备会话使用单独的流文件目录
+	sprintf(path_buff, _primary.load() ? "td_flow/%s/%s/standby/" : "td_flow/%s/%s/", _broker_id.c_str(), _userid.c_str());
 	if (!std::filesystem::exists(path_buff))
 	{
 		std::filesystem::create_directories(path_buff);
@@ -99,11 +119,18 @@ bool ctp_api_trader::login()
 	_td_api->SubscribePrivateTopic(THOST_TERT_QUICK);
 	_td_api->SubscribePublicTopic(THOST_TERT_QUICK);
 	_td_api->RegisterFront(const_cast<char*>(_front_addr.c_str()));
+	_request_tracker.begin(LOGIN_REQUEST_ID);
 	_td_api->Init();
 	LOG_INFO("ctp_api_trader init ");
-	_process_signal.wait(_process_mutex);
+	int32_t result = _request_tracker.wait(LOGIN_REQUEST_ID, std::chrono::steady_clock::now() + _login_timeout);
+	if (result != 0)
+	{
+		LOG_ERROR("ctp_api_trader login failed :", result);
+		return false;
+	}
 	_is_inited = true ;
 	submit_settlement();
+	prepare_order_template();
 	LOG_INFO("ctp_api_trader login");
 	return true ;
 }
@@ -113,7 +140,7 @@ void ctp_api_trader::logout()
 	_is_runing = false;
 	do_logout();
 	
-	_reqid = 0;
+	_reqid = LOGIN_REQUEST_ID + 1;
 	
 	_front_id = 0;		//前置编号
 	_session_id = 0;	//会话编号
@@ -122,11 +149,13 @@ void ctp_api_trader::logout()
 
 	_position_info.clear();
 	_order_info.clear();
+	_order_template.clear();
 	
-	_is_in_query.exchange(false);
+	_request_tracker.abort_all();
+	_is_position_reset.store(false);
+	_is_order_reset.store(false);
 	_is_inited = false;
 	_is_connected = false;
-	_is_sync_wait.exchange(false);
 
 	if (_td_api)
 	{
@@ -180,76 +209,65 @@ bool ctp_api_trader::do_logout()
 	return true;
 }
 
-bool ctp_api_trader::query_positions(bool is_sync)
+uint32_t ctp_api_trader::query_positions(std::chrono::steady_clock::time_point deadline)
 {
-	if (_td_api == nullptr)
-	{
-		return false;
-	}
-	bool expected = false;
-	if (!_is_in_query.compare_exchange_weak(expected, true))
-	{
-		LOG_ERROR("ctp trader _is_in_query not return");
-		return false;
-	}
 	CThostFtdcQryInvestorPositionField req;
 	memset(&req, 0, sizeof(req));
 	strcpy(req.BrokerID, _broker_id.c_str());
 	strcpy(req.InvestorID, _userid.c_str());
-	auto iResult = _td_api->ReqQryInvestorPosition(&req, genreqid());
-	if (iResult != 0)
-	{
-		LOG_ERROR("ReqQryInvestorPosition failed:", iResult);
-		while (!_is_in_query.exchange(false));
-		return false;
-	}
-	
-	if(is_sync)
-	{
-		while (!_is_sync_wait.exchange(true));
-		_process_signal.wait(_process_mutex);
-	}
-	return true ;
+	_is_position_reset.store(true);
+	return send_query("ReqQryInvestorPosition", deadline, [this, &req](uint32_t request_id)->int {
+		return _td_api->ReqQryInvestorPosition(&req, request_id);
+	});
 }
 
-bool ctp_api_trader::query_orders(bool is_sync)
+uint32_t ctp_api_trader::query_orders(std::chrono::steady_clock::time_point deadline)
 {
-	if (_td_api == nullptr)
-	{
-		return false;
-	}
-	bool expected = false;
-	if (!_is_in_query.compare_exchange_weak(expected, true))
-	{
-		LOG_ERROR("ctp mini trader _is_in_query not return");
-		return false;
-	}
 	CThostFtdcQryOrderField req;
 	memset(&req, 0, sizeof(req));
 	strcpy(req.BrokerID, _broker_id.c_str());
 	strcpy(req.InvestorID, _userid.c_str());
-	auto iResult = _td_api->ReqQryOrder(&req, genreqid());
-	if (iResult != 0)
+	_is_order_reset.store(true);
+	return send_query("ReqQryOrder", deadline, [this, &req](uint32_t request_id)->int {
+		return _td_api->ReqQryOrder(&req, request_id);
+	});
+}
+
+uint32_t ctp_api_trader::send_query(const char* name, std::chrono::steady_clock::time_point deadline, const std::function<int(uint32_t)>& request)
+{
+	if (_td_api == nullptr)
 	{
-		LOG_ERROR("ReqQryOrder failed:", iResult);
-		while (!_is_in_query.exchange(false));
-		return false;
+		return 0;
 	}
-	if (is_sync)
+	uint32_t request_id = genreqid();
+	_request_tracker.begin(request_id);
+	auto backoff = std::chrono::milliseconds(10);
+	for (;;)
 	{
-		while (!_is_sync_wait.exchange(true));
-		_process_signal.wait(_process_mutex);
+		int iResult = request(request_id);
+		if (iResult == 0)
+		{
+			return request_id;
+		}
+		if ((iResult != -2 && iResult != -3) || std::chrono::steady_clock::now() + backoff > deadline)
+		{
+			LOG_ERROR("ctp_api_trader query failed :", name, iResult);
+			_request_tracker.complete(request_id, iResult);
+			return 0;
+		}
+		LOG_DEBUG("ctp_api_trader query flow control :", name, iResult);
+		std::this_thread::sleep_for(backoff);
+		backoff = std::min(backoff * 2, std::chrono::milliseconds(200));
 	}
-	return true ;
 }
 
 void ctp_api_trader::OnFrontConnected()noexcept
 {
 	LOG_INFO("ctp_api_trader OnFrontConnected ");
 	_is_connected = true ;
-	if (_is_runing)
+	if (_is_runing && !do_auth())
 	{
-		do_auth();
+		_request_tracker.complete(LOGIN_REQUEST_ID, -1);
 	}
 }
 
@@ -257,6 +275,11 @@ void ctp_api_trader::OnFrontDisconnected(int nReason)noexcept
 {
 	LOG_INFO("ctp_api_trader FrontDisconnected : Reason ->", nReason);
 	_is_connected = false ;
+	if (_is_inited)
+	{
+		//登录以后断线，等待中的查询不会再有应答
+		_request_tracker.abort_all();
+	}
 }
 
 void ctp_api_trader::OnRspAuthenticate(CThostFtdcRspAuthenticateField *pRspAuthenticateField, CThostFtdcRspInfoField *pRspInfo, int nRequestID, bool bIsLast)noexcept
@@ -264,9 +287,13 @@ void ctp_api_trader::OnRspAuthenticate(CThostFtdcRspAuthenticateField *pRspAuthe
 	if (pRspInfo && pRspInfo->ErrorID)
 	{
 		LOG_ERROR("ctp_api_trader OnRspAuthenticate Error :", pRspInfo->ErrorID, pRspInfo->ErrorMsg);
+		_request_tracker.complete(LOGIN_REQUEST_ID, pRspInfo->ErrorID);
 		return ;
 	}
-	do_login();
+	if (!do_login())
+	{
+		_request_tracker.complete(LOGIN_REQUEST_ID, -1);
+	}
 }
 
 void ctp_api_trader::OnRspUserLogin(CThostFtdcRspUserLoginField *pRspUserLogin, CThostFtdcRspInfoField *pRspInfo, int nRequestID, bool bIsLast)noexcept
@@ -274,6 +301,7 @@ void ctp_api_trader::OnRspUserLogin(CThostFtdcRspUserLoginField *pRspUserLogin,
 	if (pRspInfo && pRspInfo->ErrorID)
 	{
 		LOG_ERROR("ctp_api_trader OnRspUserLogin Error : ", pRspInfo->ErrorID, pRspInfo->ErrorMsg);
+		_request_tracker.complete(LOGIN_REQUEST_ID, pRspInfo->ErrorID);
 		return;
 	}
 
@@ -290,9 +318,9 @@ void ctp_api_trader::OnRspUserLogin(CThostFtdcRspUserLoginField *pRspUserLogin,
 		_order_ref = atoi(pRspUserLogin->MaxOrderRef);
 	}
 
-	if (bIsLast&&!_is_inited)
+	if (bIsLast)
 	{
-		_process_signal.notify_all();
+		_request_tracker.complete(LOGIN_REQUEST_ID, 0);
 	}
 
 }
@@ -313,7 +341,7 @@ void ctp_api_trader::OnRspSettlementInfoConfirm(CThostFtdcSettlementInfoConfirmF
 	}
 	if (bIsLast)
 	{
-		_process_signal.notify_all();
+		_request_tracker.complete(nRequestID, pRspInfo ? pRspInfo->ErrorID : 0);
 	}
 }
 
@@ -326,7 +354,7 @@ void ctp_api_trader::OnRspOrderInsert(CThostFtdcInputOrderField *pInputOrder, CT
 	if (pInputOrder && pRspInfo)
 	{
 		estid_t estid = generate_estid(_front_id, _session_id, strtol(pInputOrder->OrderRef, NULL, 10));
-		this->fire_event(trader_event_type::TET_OrderError, error_type::ET_PLACE_ORDER, estid, (uint8_t)pRspInfo->ErrorID);
+		this->dispatch_event(trader_event_type::TET_OrderError, error_type::ET_PLACE_ORDER, estid, (uint8_t)pRspInfo->ErrorID);
 	}
 }
 
@@ -339,20 +367,20 @@ void ctp_api_trader::OnRspOrderAction(CThostFtdcInputOrderActionField *pInputOrd
 	if (pInputOrderAction && pRspInfo)
 	{
 		estid_t estid = generate_estid(pInputOrderAction->FrontID, pInputOrderAction->SessionID, strtol(pInputOrderAction->OrderRef, NULL, 10));
-		this->fire_event(trader_event_type::TET_OrderError, error_type::ET_CANCEL_ORDER, estid, (uint8_t)pRspInfo->ErrorID);
+		this->dispatch_event(trader_event_type::TET_OrderError, error_type::ET_CANCEL_ORDER, estid, (uint8_t)pRspInfo->ErrorID);
 	}
 }
 
 void ctp_api_trader::OnRspQryInvestorPosition(CThostFtdcInvestorPositionField *pInvestorPosition, CThostFtdcRspInfoField *pRspInfo, int nRequestID, bool bIsLast)noexcept
 {
-	if (_is_in_query)
+	if (_is_position_reset.exchange(false))
 	{
-		while (!_is_in_query.exchange(false));
 		_position_info.clear();
 	}
 	if (pRspInfo && pRspInfo->ErrorID != 0)
 	{
 		LOG_ERROR("OnRspQryInvestorPosition \tErrorID = [%d] ErrorMsg = [%s]", pRspInfo->ErrorID, pRspInfo->ErrorMsg);
+		_request_tracker.complete(nRequestID, pRspInfo->ErrorID);
 		return;
 	}
 	
@@ -408,21 +436,25 @@ void ctp_api_trader::OnRspQryInvestorPosition(CThostFtdcInvestorPositionField *p
 		}
 		_position_info[code] = pos;
 	}
-	if (bIsLast && _is_sync_wait)
+	if (bIsLast)
 	{
-		while (!_is_sync_wait.exchange(false));
-		_process_signal.notify_all();
+		_request_tracker.complete(nRequestID, 0);
 	}
 }
 
 
 void ctp_api_trader::OnRspQryOrder(CThostFtdcOrderField *pOrder, CThostFtdcRspInfoField *pRspInfo, int nRequestID, bool bIsLast)noexcept
 {
-	if (_is_in_query)
+	if (_is_order_reset.exchange(false))
 	{
-		while (!_is_in_query.exchange(false));
 		_order_info.clear();
 	}
+	if (pRspInfo && pRspInfo->ErrorID != 0)
+	{
+		LOG_ERROR("OnRspQryOrder \tErrorID =", pRspInfo->ErrorID, "ErrorMsg =", pRspInfo->ErrorMsg);
+		_request_tracker.complete(nRequestID, pRspInfo->ErrorID);
+		return;
+	}
 	if (pOrder&& pOrder->VolumeTotal>0&& pOrder->OrderStatus!= THOST_FTDC_OST_Canceled&& pOrder->OrderStatus != THOST_FTDC_OST_AllTraded)
 	{
 		estid_t estid = generate_estid(pOrder->FrontID, pOrder->SessionID,strtoul(pOrder->OrderRef,NULL,10));
@@ -439,15 +471,16 @@ void ctp_api_trader::OnRspQryOrder(CThostFtdcOrderField *pOrder, CThostFtdcRspIn
 		LOG_INFO("OnRspQryOrder", pOrder->InstrumentID, estid, pOrder->FrontID, pOrder->SessionID, pOrder->OrderRef, pOrder->LimitPrice);
 	}
 
-	if (bIsLast && _is_sync_wait)
+	if (bIsLast)
 	{
-		while (!_is_sync_wait.exchange(false));
-		_process_signal.notify_all();
+		_request_tracker.complete(nRequestID, 0);
 	}
 }
 
 void ctp_api_trader::OnRspError(CThostFtdcRspInfoField *pRspInfo, int nRequestID, bool bIsLast)noexcept
 {
+	//同步请求出错时不用等到超时
+	_request_tracker.complete(nRequestID, pRspInfo ? pRspInfo->ErrorID : -1);
 	if(!_is_inited)
 	{
 		return ;
@@ -455,7 +488,7 @@ void ctp_api_trader::OnRspError(CThostFtdcRspInfoField *pRspInfo, int nRequestID
 	if (pRspInfo)
 	{
 		LOG_ERROR("OnRspError \tErrorID = ", pRspInfo->ErrorID, " ErrorMsg =",  pRspInfo->ErrorMsg);
-		this->fire_event(trader_event_type::TET_OrderError,error_type::ET_OTHER_ERROR, INVALID_ESTID, (uint8_t)pRspInfo->ErrorID);
+		this->dispatch_event(trader_event_type::TET_OrderError,error_type::ET_OTHER_ERROR, INVALID_ESTID, (uint8_t)pRspInfo->ErrorID);
 	}
 
 }
@@ -473,9 +506,22 @@ void ctp_api_trader::OnRtnOrder(CThostFtdcOrderField *pOrder)noexcept
 	auto offset = wrap_offset_type(pOrder->CombOffsetFlag[0]);
 	auto is_today = (THOST_FTDC_OF_CloseToday == pOrder->CombOffsetFlag[0]);
 	LOG_INFO("OnRtnOrder", estid, pOrder->FrontID, pOrder->SessionID, pOrder->InstrumentID, direction, offset, pOrder->OrderStatus);
-
+	auto lock = lock_standby();
 	if (pOrder->OrderStatus == THOST_FTDC_OST_Canceled || pOrder->OrderStatus == THOST_FTDC_OST_AllTraded)
 	{
+		if (_primary.load(std::memory_order_relaxed))
+		{
+			order_info finished;
+			finished.code = code;
+			finished.create_time = make_daytm(pOrder->InsertTime, 0U);
+			finished.estid = estid;
+			finished.direction = direction;
+			finished.offset = offset;
+			finished.last_volume = pOrder->VolumeTotal;
+			finished.total_volume = pOrder->VolumeTotal + pOrder->VolumeTraded;
+			finished.price = pOrder->LimitPrice;
+			record_finished(finished, pOrder->OrderStatus == THOST_FTDC_OST_Canceled);
+		}
 		auto it = _order_info.find(estid);
 		if (it != _order_info.end())
 		{	
@@ -485,17 +531,17 @@ void ctp_api_trader::OnRtnOrder(CThostFtdcOrderField *pOrder)noexcept
 				uint32_t deal_valume = order.last_volume - pOrder->VolumeTotal;
 				order.last_volume = pOrder->VolumeTotal;
 				//触发 deal 事件
-				this->fire_event(trader_event_type::TET_OrderDeal, estid, deal_valume, (uint32_t)(pOrder->VolumeTotal));
+				this->dispatch_event(trader_event_type::TET_OrderDeal, estid, deal_valume, (uint32_t)(pOrder->VolumeTotal));
 			}
 			if (pOrder->OrderStatus == THOST_FTDC_OST_Canceled)
 			{
 				LOG_INFO("OnRtnOrder fire_event ET_OrderCancel", estid, code.get_id(), direction, offset);
-				this->fire_event(trader_event_type::TET_OrderCancel, estid, code, offset, direction, pOrder->LimitPrice, (uint32_t)pOrder->VolumeTotal, (uint32_t)(pOrder->VolumeTraded + pOrder->VolumeTotal));
+				this->dispatch_event(trader_event_type::TET_OrderCancel, estid, code, offset, direction, pOrder->LimitPrice, (uint32_t)pOrder->VolumeTotal, (uint32_t)(pOrder->VolumeTraded + pOrder->VolumeTotal));
 			}
 			if (pOrder->OrderStatus == THOST_FTDC_OST_AllTraded)
 			{
 				LOG_INFO("OnRtnOrder fire_event ET_OrderTrade", estid, code.get_id(), direction, offset);
-				this->fire_event(trader_event_type::TET_OrderTrade, estid, code, offset, direction, pOrder->LimitPrice, (uint32_t)(pOrder->VolumeTraded + pOrder->VolumeTotal));
+				this->dispatch_event(trader_event_type::TET_OrderTrade, estid, code, offset, direction, pOrder->LimitPrice, (uint32_t)(pOrder->VolumeTraded + pOrder->VolumeTotal));
 			}
 			_order_info.erase(it);
 		}
@@ -515,11 +561,11 @@ void ctp_api_trader::OnRtnOrder(CThostFtdcOrderField *pOrder)noexcept
 			entrust.offset = offset;
 			entrust.price = pOrder->LimitPrice;
 			_order_info.insert(std::make_pair(estid, entrust));
-			this->fire_event(trader_event_type::TET_OrderPlace, entrust);
+			this->dispatch_event(trader_event_type::TET_OrderPlace, entrust);
 			if (pOrder->VolumeTraded > 0)
 			{
 				//触发 deal 事件
-				this->fire_event(trader_event_type::TET_OrderDeal, estid, (uint32_t)pOrder->VolumeTotal, (uint32_t)(pOrder->VolumeTotal));
+				this->dispatch_event(trader_event_type::TET_OrderDeal, estid, (uint32_t)pOrder->VolumeTotal, (uint32_t)(pOrder->VolumeTotal));
 			}
 		}
 		else
@@ -530,7 +576,7 @@ void ctp_api_trader::OnRtnOrder(CThostFtdcOrderField *pOrder)noexcept
 				uint32_t deal_volume = entrust.last_volume - pOrder->VolumeTotal;
 				entrust.last_volume = pOrder->VolumeTotal;
 				//触发 deal 事件
-				this->fire_event(trader_event_type::TET_OrderDeal, estid, deal_volume, (uint32_t)(pOrder->VolumeTotal));
+				this->dispatch_event(trader_event_type::TET_OrderDeal, estid, deal_volume, (uint32_t)(pOrder->VolumeTotal));
 
 			}
 			else
@@ -560,12 +606,13 @@ void ctp_api_trader::OnErrRtnOrderInsert(CThostFtdcInputOrderField *pInputOrder,
 	{
 		LOG_ERROR("OnErrRtnOrderInsert", pInputOrder->InstrumentID, pInputOrder->VolumeTotalOriginal, pRspInfo->ErrorMsg);
 		estid_t estid = generate_estid(_front_id, _session_id, strtol(pInputOrder->OrderRef,NULL,10));
+		auto lock = lock_standby();
 		auto it = _order_info.find(estid);
 		if(it != _order_info.end())
 		{
 			_order_info.erase(it);
 		}
-		this->fire_event(trader_event_type::TET_OrderError, error_type::ET_PLACE_ORDER,estid, (uint8_t)pRspInfo->ErrorID);
+		this->dispatch_event(trader_event_type::TET_OrderError, error_type::ET_PLACE_ORDER,estid, (uint8_t)pRspInfo->ErrorID);
 	}
 }
 void ctp_api_trader::OnErrRtnOrderAction(CThostFtdcOrderActionField* pOrderAction, CThostFtdcRspInfoField* pRspInfo)noexcept
@@ -581,7 +628,7 @@ void ctp_api_trader::OnErrRtnOrderAction(CThostFtdcOrderActionField* pOrderActio
 		{
 			LOG_ERROR("OnErrRtnOrderAction ", pOrderAction->OrderRef, pOrderAction->RequestID, pOrderAction->SessionID, pOrderAction->FrontID);
 			estid_t estid = generate_estid(pOrderAction->FrontID, pOrderAction->SessionID, strtol(pOrderAction->OrderRef, NULL, 10));
-			this->fire_event(trader_event_type::TET_OrderError, error_type::ET_CANCEL_ORDER, estid, (uint8_t)pRspInfo->ErrorID);
+			this->dispatch_event(trader_event_type::TET_OrderError, error_type::ET_CANCEL_ORDER, estid, (uint8_t)pRspInfo->ErrorID);
 		}
 	}
 	
@@ -638,69 +685,23 @@ estid_t ctp_api_trader::place_order(offset_type offset, direction_type direction
 		return INVALID_ESTID;
 	}
 	estid_t estid = generate_estid();
-	
-	CThostFtdcInputOrderField req;
-	memset(&req, 0, sizeof(req));
-	strcpy(req.BrokerID, _broker_id.c_str());
-	strcpy(req.InvestorID, _userid.c_str());
-
-	strcpy(req.InstrumentID, code.get_id());
-	strcpy(req.ExchangeID, code.get_excg());
+	//拷贝模板，只修改价格、数量和报单引用
+	CThostFtdcInputOrderField req = get_order_template(code).insert[order_template_index(direction, offset, flag)];
 
 	uint32_t order_ref = 0, season_id = 0, front_id = 0;
 	extract_estid(estid, front_id, season_id, order_ref);
 	///报单引用
-	sprintf(req.OrderRef, "%u", order_ref);
-
-	if(price != .0F)
-	{
-		///报单价格条件: 限价
-		req.OrderPriceType = THOST_FTDC_OPT_LimitPrice;
-
-	}
-	else
-	{
-		req.OrderPriceType = THOST_FTDC_OPT_BestPrice;
-	}
-	///买卖方向: 
-	req.Direction = convert_direction_offset(direction, offset);
-	///组合开平标志: 开仓
-	req.CombOffsetFlag[0] = convert_offset_type(code,volume,offset, direction);
-	///组合投机套保标志
-	req.CombHedgeFlag[0] = THOST_FTDC_HF_Speculation;
+	string_helper::format_uint(req.OrderRef, order_ref);
+	///报单价格条件: 限价/最优价
+	req.OrderPriceType = price != .0F ? THOST_FTDC_OPT_LimitPrice : THOST_FTDC_OPT_BestPrice;
 	///价格
 	req.LimitPrice = price;
-	///数量: 1
+	///数量
 	req.VolumeTotalOriginal = volume;
-
-	if (flag == order_flag::OF_NOR)
-	{
-		req.TimeCondition = THOST_FTDC_TC_GFD;
-		req.VolumeCondition = THOST_FTDC_VC_AV;
-		req.MinVolume = 1;
-	}
-	else if (flag == order_flag::OF_FAK)
-	{
-		req.TimeCondition = THOST_FTDC_TC_IOC;
-		req.VolumeCondition = THOST_FTDC_VC_AV;
-		req.MinVolume = 1;
-	}
-	else if (flag == order_flag::OF_FOK)
+	if (flag == order_flag::OF_FOK)
 	{
-		req.TimeCondition = THOST_FTDC_TC_IOC;
-		req.VolumeCondition = THOST_FTDC_VC_CV;
 		req.MinVolume = volume;
 	}
-
-
-	///触发条件: 立即
-	req.ContingentCondition = THOST_FTDC_CC_Immediately;
-	///强平原因: 非强平
-	req.ForceCloseReason = THOST_FTDC_FCC_NotForceClose;
-	///自动挂起标志: 否
-	req.IsAutoSuspend = 0;
-	///用户强评标志: 否
-	req.UserForceClose = 0;
 	PROFILE_DEBUG(code.get_id());
 	int iResult = _td_api->ReqOrderInsert(&req, genreqid());
 	if (iResult != 0)
@@ -728,29 +729,13 @@ bool ctp_api_trader::cancel_order(estid_t estid)
 	auto& order = it->second;
 	uint32_t frontid = 0, sessionid = 0, orderref = 0;
 	extract_estid(estid, frontid, sessionid, orderref);
-	CThostFtdcInputOrderActionField req;
-	memset(&req, 0, sizeof(req));
-	strcpy(req.BrokerID, _broker_id.c_str());
-	strcpy(req.InvestorID, _userid.c_str());
-	strcpy(req.UserID, _userid.c_str());
+	CThostFtdcInputOrderActionField req = get_order_template(order.code).action;
 	///报单引用
-	sprintf(req.OrderRef, "%u", orderref);
-	///请求编号
+	string_helper::format_uint(req.OrderRef, orderref);
 	///前置编号
 	req.FrontID = frontid;
 	///会话编号
 	req.SessionID = sessionid;
-	///操作标志
-	req.ActionFlag = convert_action_flag(action_flag::AF_CANCEL);
-	///合约代码
-	strcpy(req.InstrumentID, order.code.get_id());
-
-	//req.LimitPrice = change.price;
-
-	//req.VolumeChange = (int)change.volume;
-
-	//strcpy_s(req.OrderSysID, change.estid.c_str());
-	strcpy(req.ExchangeID, order.code.get_excg());
 	LOG_INFO("ctp_api_trader ReqOrderAction :", req.ExchangeID, req.InstrumentID, req.FrontID, req.SessionID, req.OrderRef, req.BrokerID, req.InvestorID, req.UserID, estid);
 	int iResult = _td_api->ReqOrderAction(&req, genreqid());
 	if (iResult != 0)
@@ -762,6 +747,84 @@ bool ctp_api_trader::cancel_order(estid_t estid)
 }
 
 
+void ctp_api_trader::prepare_order_template()
+{
+	for (const auto& it : _id_excg_map)
+	{
+		get_order_template(code_t(it.first.c_str(), it.second.c_str()));
+	}
+	LOG_INFO("ctp_api_trader prepare_order_template :", _order_template.size());
+}
+
+const ctp_api_trader::order_template& ctp_api_trader::get_order_template(const code_t& code)
+{
+	auto it = _order_template.find(code);
+	if (it != _order_template.end())
+	{
+		return it->second;
+	}
+	//没有提前生成的合约第一次下单时生成
+	auto& result = _order_template[code];
+	build_order_template(code, result);
+	return result;
+}
+
+void ctp_api_trader::build_order_template(const code_t& code, order_template& result)
+{
+	CThostFtdcInputOrderField insert;
+	memset(&insert, 0, sizeof(insert));
+	strcpy(insert.BrokerID, _broker_id.c_str());
+	strcpy(insert.InvestorID, _userid.c_str());
+	strcpy(insert.InstrumentID, code.get_id());
+	strcpy(insert.ExchangeID, code.get_excg());
+	///组合投机套保标志
+	insert.CombHedgeFlag[0] = THOST_FTDC_HF_Speculation;
+	///触发条件: 立即
+	insert.ContingentCondition = THOST_FTDC_CC_Immediately;
+	///强平原因: 非强平
+	insert.ForceCloseReason = THOST_FTDC_FCC_NotForceClose;
+	///自动挂起标志: 否
+	insert.IsAutoSuspend = 0;
+	///用户强评标志: 否
+	insert.UserForceClose = 0;
+	insert.MinVolume = 1;
+	foreach_order_template([this, &code, &insert, &result](size_t index, direction_type direction, offset_type offset, order_flag flag)->void {
+		auto& req = result.insert[index];
+		req = insert;
+		///买卖方向
+		req.Direction = convert_direction_offset(direction, offset);
+		///组合开平标志
+		req.CombOffsetFlag[0] = convert_offset_type(code, 0, offset, direction);
+		if (flag == order_flag::OF_NOR)
+		{
+			req.TimeCondition = THOST_FTDC_TC_GFD;
+			req.VolumeCondition = THOST_FTDC_VC_AV;
+		}
+		else if (flag == order_flag::OF_FAK)
+		{
+			req.TimeCondition = THOST_FTDC_TC_IOC;
+			req.VolumeCondition = THOST_FTDC_VC_AV;
+		}
+		else if (flag == order_flag::OF_FOK)
+		{
+			//最小成交量在下单时填委托数量
+			req.TimeCondition = THOST_FTDC_TC_IOC;
+			req.VolumeCondition = THOST_FTDC_VC_CV;
+		}
+	});
+
+	auto& action = result.action;
+	memset(&action, 0, sizeof(action));
+	strcpy(action.BrokerID, _broker_id.c_str());
+	strcpy(action.InvestorID, _userid.c_str());
+	strcpy(action.UserID, _userid.c_str());
+	///操作标志
+	action.ActionFlag = convert_action_flag(action_flag::AF_CANCEL);
+	///合约代码
+	strcpy(action.InstrumentID, code.get_id());
+	strcpy(action.ExchangeID, code.get_excg());
+}
+
 uint32_t ctp_api_trader::get_trading_day()const 
 {
 	if(_td_api)
@@ -773,18 +836,23 @@ uint32_t ctp_api_trader::get_trading_day()const
 
 std::shared_ptr<trader_data> ctp_api_trader::get_trader_data() 
 {
-	auto result = std::make_shared<trader_data>();
-	if (!query_positions(true))
+	auto deadline = std::chrono::steady_clock::now() + _query_timeout;
+	//持仓和委托查询先全部发出再一起等待应答
+	uint32_t position_request = query_positions(deadline);
+	uint32_t order_request = query_orders(deadline);
+	if (position_request == 0 || order_request == 0)
 	{
-		LOG_ERROR("query_positions error");
-		return result;
+		LOG_ERROR("ctp_api_trader get_trader_data request error");
+		return nullptr;
 	}
-	std::this_thread::sleep_for(std::chrono::seconds(1));
-	if (!query_orders(true))
+	int32_t position_result = _request_tracker.wait(position_request, deadline);
+	int32_t order_result = _request_tracker.wait(order_request, deadline);
+	if (position_result != 0 || order_result != 0)
 	{
-		LOG_ERROR("query_orders error");
-		return result;
+		LOG_ERROR("ctp_api_trader get_trader_data query error :", position_result, order_result);
+		return nullptr;
 	}
+	auto result = std::make_shared<trader_data>();
 	for (auto it : _order_info)
 	{
 		result->orders.emplace_back(it.second);
@@ -796,6 +864,113 @@ std::shared_ptr<trader_data> ctp_api_trader::get_trader_data()
 	return result ;
 }
 
+bool ctp_api_trader::set_standby(const actual_trader* primary)
+{
+	if (primary == this)
+	{
+		return false;
+	}
+	std::lock_guard<std::mutex> lock(_standby_mutex);
+	_finished_order.clear();
+	_finished_sequence.clear();
+	_primary.store(primary, std::memory_order_release);
+	LOG_INFO("ctp_api_trader set_standby :", primary != nullptr);
+	return true;
+}
+
+void ctp_api_trader::take_over(const entrust_map& known, const std::function<bool(estid_t)>& is_pending)
+{
+	//持锁补发，回调线程的回报要么已经在镜像里，要么在解除热备以后正常派发，事件队列的写入也不会并发
+	std::lock_guard<std::mutex> lock(_standby_mutex);
+	size_t replay_count = 0;
+	for (const auto& it : known)
+	{
+		const order_info& order = it.second;
+		auto live = _order_info.find(it.first);
+		if (live != _order_info.end())
+		{
+			if (live->second.last_volume < order.last_volume)
+			{
+				this->fire_event(trader_event_type::TET_OrderDeal, it.first, order.last_volume - live->second.last_volume, live->second.last_volume);
+				replay_count++;
+			}
+			continue;
+		}
+		auto finished = _finished_order.find(it.first);
+		if (finished != _finished_order.end())
+		{
+			replay_finished(finished->second, order.last_volume);
+			replay_count++;
+			continue;
+		}
+		LOG_WARNING("ctp_api_trader take_over order not found :", it.first, order.code.get_id(), order.last_volume);
+	}
+	//上层没有收到委托回报的订单先补发委托回报
+	for (const auto& it : _order_info)
+	{
+		if (known.find(it.first) != known.end())
+		{
+			continue;
+		}
+		order_info entrust = it.second;
+		entrust.last_volume = entrust.total_volume;
+		this->fire_event(trader_event_type::TET_OrderPlace, entrust);
+		if (it.second.last_volume < entrust.total_volume)
+		{
+			this->fire_event(trader_event_type::TET_OrderDeal, it.first, entrust.total_volume - it.second.last_volume, it.second.last_volume);
+		}
+		replay_count++;
+	}
+	for (const auto& it : _finished_order)
+	{
+		//已经处理过完成回报的订单不在known里，只补发上层还在等待的订单
+		if (known.find(it.first) != known.end() || !is_pending(it.first))
+		{
+			continue;
+		}
+		order_info entrust = it.second.order;
+		entrust.last_volume = entrust.total_volume;
+		this->fire_event(trader_event_type::TET_OrderPlace, entrust);
+		replay_finished(it.second, entrust.total_volume);
+		replay_count++;
+	}
+	_finished_order.clear();
+	_finished_sequence.clear();
+	_primary.store(nullptr, std::memory_order_release);
+	LOG_INFO("ctp_api_trader take_over replay :", replay_count);
+}
+
+void ctp_api_trader::record_finished(const order_info& order, bool is_canceled)
+{
+	if (_finished_order.find(order.estid) == _finished_order.end())
+	{
+		_finished_sequence.emplace_back(order.estid);
+	}
+	_finished_order[order.estid] = { order, is_canceled };
+	while (_finished_sequence.size() > MAX_FINISHED_ORDER)
+	{
+		_finished_order.erase(_finished_sequence.front());
+		_finished_sequence.pop_front();
+	}
+}
+
+void ctp_api_trader::replay_finished(const finished_order& finished, uint32_t known_volume)
+{
+	const order_info& order = finished.order;
+	if (order.last_volume < known_volume)
+	{
+		this->fire_event(trader_event_type::TET_OrderDeal, order.estid, known_volume - order.last_volume, order.last_volume);
+	}
+	if (finished.is_canceled)
+	{
+		this->fire_event(trader_event_type::TET_OrderCancel, order.estid, order.code, order.offset, order.direction, order.price, order.last_volume, order.total_volume);
+	}
+	else
+	{
+		this->fire_event(trader_event_type::TET_OrderTrade, order.estid, order.code, order.offset, order.direction, order.price, order.total_volume);
+	}
+}
+
 void ctp_api_trader::submit_settlement() 
 {
 	if (_td_api == nullptr)
@@ -812,11 +987,17 @@ void ctp_api_trader::submit_settlement()
 	//fmt::format_to(req.ConfirmDate, "{}", TimeUtils::getCurDate());
 	//memcpy(req.ConfirmTime, TimeUtils::getLocalTime().c_str(), 8);
 
-	int iResult = _td_api->ReqSettlementInfoConfirm(&req, genreqid());
+	uint32_t request_id = genreqid();
+	_request_tracker.begin(request_id);
+	int iResult = _td_api->ReqSettlementInfoConfirm(&req, request_id);
 	if (iResult != 0)
 	{
 		LOG_ERROR("ctp_api_trader submit_settlement request failed: %d", iResult);
+		return;
+	}
+	int32_t result = _request_tracker.wait(request_id, std::chrono::steady_clock::now() + _query_timeout);
+	if (result != 0)
+	{
+		LOG_ERROR("ctp_api_trader submit_settlement failed :", result);
 	}
-	while (!_is_sync_wait.exchange(true));
-	_process_signal.wait(_process_mutex);
 }
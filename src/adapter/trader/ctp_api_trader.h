@@ -22,6 +22,8 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 */
 #pragma once
 #include <queue>
+#include <deque>
+#include <mutex>
 #include <stdint.h>
 #include <thread>
 #include <define.h>
@@ -29,9 +31,11 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include <trader_api.h>
 #include <define_types.hpp>
 #include <params.hpp>
-#include <condition_variable>
+#include <functional>
 #include <CTP_V6.6.9_20220920/ThostFtdcTraderApi.h>
 #include <dll_helper.hpp>
+#include "order_template.hpp"
+#include "request_tracker.hpp"
 
 namespace lt::driver
 {
@@ -46,6 +50,32 @@ namespace lt::driver
 			AF_MODIFY = '3',	//修改
 		};
 
+		//登录流程（连接、认证、登录）跨多个请求，用保留的请求号0跟踪，genreqid从1开始
+		static constexpr uint32_t LOGIN_REQUEST_ID = 0;
+
+		/*
+		 *	合约下单模板（除价格、数量、报单引用以外的字段都预先填好）
+		 */
+		struct order_template
+		{
+			std::array<CThostFtdcInputOrderField, ORDER_TEMPLATE_COUNT> insert;
+
+			CThostFtdcInputOrderActionField action;
+		};
+
+		/*
+		 *	热备期间完成的委托（撤销或全部成交），order.last_volume是完成时的剩余数量
+		 */
+		struct finished_order
+		{
+			order_info order;
+
+			bool is_canceled;
+		};
+
+		//热备最多保留的已完成委托，只需要覆盖主会话断线到接管之间的回报
+		static constexpr size_t MAX_FINISHED_ORDER = 1024;
+
 	public:
 
 		ctp_api_trader(std::unordered_map<std::string, std::string>& id_excg_map, const params& config);
@@ -71,6 +101,10 @@ namespace lt::driver
 
 		virtual std::shared_ptr<trader_data> get_trader_data() override;
 
+		virtual bool set_standby(const actual_trader* primary) override;
+
+		virtual void take_over(const entrust_map& known, const std::function<bool(estid_t)>& is_pending) override;
+
 		//////////////////////////////////////////////////////////////////////////
 		//CTP交易接口实现
 	public:
@@ -115,12 +149,23 @@ namespace lt::driver
 
 		bool do_logout();
 
-		bool query_positions(bool is_sync);
+		//发送查询，返回请求号（失败返回0），应答通过_request_tracker等待
+		uint32_t query_positions(std::chrono::steady_clock::time_point deadline);
 
-		bool query_orders(bool is_sync);
+		uint32_t query_orders(std::chrono::steady_clock::time_point deadline);
+
+		//柜台流控（-2未处理请求超限/-3每秒请求超限）时退避重试直到超时
+		uint32_t send_query(const char* name, std::chrono::steady_clock::time_point deadline, const std::function<int(uint32_t)>& request);
 
 		void submit_settlement();
 
+		//登录后为已知合约预先生成模板
+		void prepare_order_template();
+
+		const order_template& get_order_template(const code_t& code);
+
+		void build_order_template(const code_t& code, order_template& result);
+
 
 	private:
 
@@ -216,6 +261,32 @@ namespace lt::driver
 			return _reqid.fetch_add(1);
 		}
 
+		//热备会话只更新订单镜像，接管时按镜像补发回报（take_over），之后才进入事件队列
+		template<typename... Types>
+		inline void dispatch_event(trader_event_type type, const Types&... args)
+		{
+			if (_primary.load(std::memory_order_acquire))
+			{
+				return;
+			}
+			this->fire_event(type, args...);
+		}
+
+		//只有热备会话的回报会和接管并发，主会话不加锁；接管以后不会再回到热备，加锁后按_primary重新判断
+		inline std::unique_lock<std::mutex> lock_standby()
+		{
+			std::unique_lock<std::mutex> lock(_standby_mutex, std::defer_lock);
+			if (_primary.load(std::memory_order_acquire))
+			{
+				lock.lock();
+			}
+			return lock;
+		}
+
+		void record_finished(const order_info& order, bool is_canceled);
+
+		void replay_finished(const finished_order& finished, uint32_t known_volume);
+
 	protected:
 
 		CThostFtdcTraderApi* _td_api;
@@ -240,16 +311,26 @@ namespace lt::driver
 		std::map<code_t, position_seed>		_position_info;
 		//
 		entrust_map							_order_info;
+		//下单模板
+		std::map<code_t, order_template>	_order_template;
 
 		bool								_is_runing;
 
-		std::mutex _mutex;
-		std::unique_lock<std::mutex>	_process_mutex;
-		std::condition_variable			_process_signal;
-		std::atomic<bool>				_is_in_query;
-		bool							_is_inited;
-		bool							_is_connected;
-		std::atomic<bool>				_is_sync_wait;
+		//同步请求（登录、结算确认、查询）的应答跟踪
+		request_tracker					_request_tracker;
+		std::chrono::milliseconds		_login_timeout;
+		std::chrono::milliseconds		_query_timeout;
+		//查询的第一条应答到达时清空旧数据
+		std::atomic<bool>				_is_position_reset;
+		std::atomic<bool>				_is_order_reset;
+		std::atomic<bool>				_is_inited;
+		std::atomic<bool>				_is_connected;
+		//不为空时是它的热备会话
+		std::atomic<const actual_trader*>	_primary;
+		//订单镜像和已完成委托在回调线程更新，接管时在实时线程读取
+		std::mutex							_standby_mutex;
+		std::map<estid_t, finished_order>	_finished_order;
+		std::deque<estid_t>					_finished_sequence;
 		typedef CThostFtdcTraderApi* (*trader_creator)(const char*);
 		trader_creator					_ctp_creator;
 		dll_handle						_trader_handle;
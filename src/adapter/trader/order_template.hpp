@@ -0,0 +1,58 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include <define.h>
+#include <define_types.hpp>
+
+namespace lt::driver
+{
+	/*
+	*	下单模板
+	*	每个合约按 方向(2)*开平(3)*订单类型(3) 预先填好委托结构体，
+	*	下单时拷贝模板，只改价格、数量和报单引用
+	*/
+	constexpr size_t ORDER_TEMPLATE_COUNT = 2 * 3 * 3;
+
+	inline size_t order_template_index(direction_type direction, offset_type offset, order_flag flag)
+	{
+		return (static_cast<size_t>(direction) - static_cast<size_t>(direction_type::DT_LONG)) * 9
+			+ (static_cast<size_t>(offset) - static_cast<size_t>(offset_type::OT_OPEN)) * 3
+			+ (static_cast<size_t>(flag) - static_cast<size_t>(order_flag::OF_NOR));
+	}
+
+	//遍历所有模板组合
+	template<typename F>
+	inline void foreach_order_template(F&& cursor)
+	{
+		for (auto direction : { direction_type::DT_LONG, direction_type::DT_SHORT })
+		{
+			for (auto offset : { offset_type::OT_OPEN, offset_type::OT_CLOSE, offset_type::OT_CLSTD })
+			{
+				for (auto flag : { order_flag::OF_NOR, order_flag::OF_FAK, order_flag::OF_FOK })
+				{
+					cursor(order_template_index(direction, offset, flag), direction, offset, flag);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,149 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include <define.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace lt::driver
+{
+	/*
+	*	同步请求跟踪（按请求号匹配应答），替代condition_variable等待
+	*	应答回调线程只做一次原子比较交换，不加锁不阻塞；
+	*	等待线程先让出CPU自旋，再退避睡眠，直到完成、超时或者被中止
+	*	多个请求可以先全部发出再依次等待，查询之间不用串行
+	*/
+	class request_tracker
+	{
+	public:
+
+		//等待中
+		static constexpr int32_t RS_PENDING = INT32_MIN;
+		//超时
+		static constexpr int32_t RS_TIMEOUT = INT32_MIN + 1;
+		//断线或者登出中止
+		static constexpr int32_t RS_ABORTED = INT32_MIN + 2;
+
+	private:
+
+		static constexpr size_t SLOT_COUNT = 64;
+
+		static constexpr uint32_t SPIN_COUNT = 1000;
+
+		struct alignas(64) request_slot
+		{
+			std::atomic<uint32_t> request_id;
+			//RS_*或者柜台返回的错误码（0表示成功）
+			std::atomic<int32_t> state;
+		};
+
+		std::array<request_slot, SLOT_COUNT> _slots;
+
+	public:
+
+		request_tracker()
+		{
+			for (auto& it : _slots)
+			{
+				it.request_id.store(0, std::memory_order_relaxed);
+				it.state.store(RS_ABORTED, std::memory_order_relaxed);
+			}
+		}
+
+		/*
+		*	发送请求之前登记，应答可能在请求函数返回之前到达
+		*/
+		void begin(uint32_t request_id)
+		{
+			auto& slot = _slots[request_id % SLOT_COUNT];
+			slot.state.store(RS_PENDING, std::memory_order_relaxed);
+			slot.request_id.store(request_id, std::memory_order_release);
+		}
+
+		/*
+		*	应答回调里调用，error_code为0表示成功
+		*	超时以后到达的应答返回false
+		*/
+		bool complete(uint32_t request_id, int32_t error_code)
+		{
+			auto& slot = _slots[request_id % SLOT_COUNT];
+			if (slot.request_id.load(std::memory_order_acquire) != request_id)
+			{
+				return false;
+			}
+			int32_t expected = RS_PENDING;
+			return slot.state.compare_exchange_strong(expected, error_code, std::memory_order_acq_rel);
+		}
+
+		/*
+		*	等待应答，返回错误码或者RS_TIMEOUT/RS_ABORTED
+		*	返回之后回调线程在complete之前写入的数据对等待线程可见
+		*/
+		int32_t wait(uint32_t request_id, std::chrono::steady_clock::time_point deadline)
+		{
+			auto& slot = _slots[request_id % SLOT_COUNT];
+			for (uint32_t i = 0;; i++)
+			{
+				if (slot.request_id.load(std::memory_order_acquire) != request_id)
+				{
+					return RS_ABORTED;
+				}
+				int32_t state = slot.state.load(std::memory_order_acquire);
+				if (state != RS_PENDING)
+				{
+					return state;
+				}
+				if (std::chrono::steady_clock::now() >= deadline)
+				{
+					if (slot.state.compare_exchange_strong(state, RS_TIMEOUT, std::memory_order_acq_rel))
+					{
+						return RS_TIMEOUT;
+					}
+					return state;
+				}
+				if (i < SPIN_COUNT)
+				{
+					std::this_thread::yield();
+				}
+				else
+				{
+					std::this_thread::sleep_for(std::chrono::microseconds(100));
+				}
+			}
+		}
+
+		/*
+		*	断线或者登出时中止所有等待中的请求
+		*/
+		void abort_all()
+		{
+			for (auto& it : _slots)
+			{
+				int32_t expected = RS_PENDING;
+				it.state.compare_exchange_strong(expected, RS_ABORTED, std::memory_order_acq_rel);
+			}
+		}
+	};
+}
@@ -23,6 +23,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include "tap_api_trader.h"
 #include <filesystem>
 #include <time_utils.hpp>
+#include <string_helper.hpp>
 #include "../../api/TAP_V9_20200808/TapAPIError.h"
 
 using namespace lt;
@@ -35,11 +36,12 @@ tap_api_trader::tap_api_trader(std::unordered_map<std::string, std::string>& id_
 	, _order_ref(0)
 	, _login_time(0)
 	, _is_runing(false)
-	, _process_mutex(_mutex)
+	, _login_timeout(10000)
+	, _query_timeout(5000)
+	, _is_position_reset(false)
+	, _is_order_reset(false)
 	, _is_inited(false)
 	, _is_connected(false)
-	, _is_sync_wait(false)
-	, _is_in_query(false)
 {
 	try
 	{
@@ -54,6 +56,23 @@ tap_api_trader::tap_api_trader(std::unordered_map<std::string, std::string>& id_
 	{
 		LOG_ERROR("tap trader init error ");
 	}
+	try
+	{
+		_login_timeout = std::chrono::milliseconds(config.get<uint32_t>("login_timeout"));
+	}
+	catch (...)
+	{
+		//不配置登录超时10秒
+	}
+	try
+	{
+		_query_timeout = std::chrono::milliseconds(config.get<uint32_t>("query_timeout"));
+	}
+	catch (...)
+	{
+		//不配置查询超时5秒
+	}
+	memset(&_cancel_template, 0, sizeof(_cancel_template));
 	_trader_handle = dll_helper::load_library("TapTradeAPI");
 	if (_trader_handle)
 	{
@@ -120,6 +139,7 @@ bool tap_api_trader::login()
 	stLoginAuth.ISModifyPassword = APIYNFLAG_NO;
 	stLoginAuth.ISDDA = APIYNFLAG_NO;
 	stLoginAuth.NoticeIgnoreFlag = TAPI_NOTICE_IGNORE_FUND | TAPI_NOTICE_IGNORE_FILL | TAPI_NOTICE_IGNORE_POSITION | TAPI_NOTICE_IGNORE_CLOSE | TAPI_NOTICE_IGNORE_POSITIONPROFIT;
+	_request_tracker.begin(LOGIN_REQUEST_ID);
 	iErr = _td_api->Login(&stLoginAuth);
 	if (TAPIERROR_SUCCEED != iErr)
 	{
@@ -128,9 +148,15 @@ bool tap_api_trader::login()
 	}
 
 	LOG_INFO("ctp_api_trader init ");
-	_process_signal.wait(_process_mutex);
+	int32_t result = _request_tracker.wait(LOGIN_REQUEST_ID, std::chrono::steady_clock::now() + _login_timeout);
+	if (result != 0)
+	{
+		LOG_ERROR("tap trader login failed :", result);
+		return false;
+	}
 
 	_is_inited = true;
+	prepare_order_template();
 	return true ;
 }
 
@@ -145,10 +171,13 @@ void tap_api_trader::logout()
 
 	_position_info.clear();
 	_order_info.clear();
+	_order_template.clear();
 
+	_request_tracker.abort_all();
+	_is_position_reset.store(false);
+	_is_order_reset.store(false);
 	_is_inited = false;
 	_is_connected = false;
-	_is_sync_wait.exchange(false);
 
 	if (_td_api)
 	{
@@ -159,62 +188,48 @@ void tap_api_trader::logout()
 
 
 
-bool tap_api_trader::query_positions(bool is_sync)
+bool tap_api_trader::query_positions()
 {
 	if (_td_api == nullptr)
 	{
 		LOG_ERROR("tap trader api nullptr");
 		return false;
 	}
-	if(_is_in_query)
-	{
-		LOG_ERROR("tap trader query_positions _is_in_query true");
-		return false;
-	}
-	LOG_INFO("tap trader query_positions :", is_sync);
+	LOG_INFO("tap trader query_positions");
 	TapAPIPositionQryReq qryReq;
-	auto err = _td_api->QryPosition(&_reqid, &qryReq);
+	_is_position_reset.store(true);
+	_request_tracker.begin(POSITION_REQUEST_ID);
+	TAPIUINT32 session_id = 0;
+	auto err = _td_api->QryPosition(&session_id, &qryReq);
 	if(err != TAPIERROR_SUCCEED)
 	{
 		LOG_ERROR("tap trader QryPosition Error:", err);
+		_request_tracker.complete(POSITION_REQUEST_ID, err);
 		return false;
 	}
-	while (_is_in_query.exchange(true));
-	if (is_sync)
-	{
-		while (!_is_sync_wait.exchange(true));
-		_process_signal.wait(_process_mutex);
-	}
 	return true;
 }
 
-bool tap_api_trader::query_orders(bool is_sync)
+bool tap_api_trader::query_orders()
 {
 	if (_td_api == nullptr)
 	{
 		LOG_ERROR("tap trader api nullptr");
 		return false;
 	}
-	if (_is_in_query)
-	{
-		LOG_ERROR("tap trader query_orders _is_in_query true");
-		return false;
-	}
-	LOG_INFO("tap trader query_orders :", is_sync);
+	LOG_INFO("tap trader query_orders");
 	TapAPIOrderQryReq qryReq;
 	qryReq.OrderQryType = TAPI_ORDER_QRY_TYPE_UNENDED;
-	auto err = _td_api->QryOrder(&_reqid,&qryReq);
+	_is_order_reset.store(true);
+	_request_tracker.begin(ORDER_REQUEST_ID);
+	TAPIUINT32 session_id = 0;
+	auto err = _td_api->QryOrder(&session_id, &qryReq);
 	if (err != TAPIERROR_SUCCEED)
 	{
 		LOG_ERROR("tap trader QryOrder Error:", err);
+		_request_tracker.complete(ORDER_REQUEST_ID, err);
 		return false;
 	}
-	while (_is_in_query.exchange(true));
-	if (is_sync)
-	{
-		while (!_is_sync_wait.exchange(true));
-		_process_signal.wait(_process_mutex);
-	}
 	return true;
 }
 
@@ -236,17 +251,22 @@ void tap_api_trader::OnRspLogin(TAPIINT32 errorCode, const TapAPITradeLoginRspIn
 	}
 	else {
 		LOG_ERROR("登录失败，错误码:", errorCode);
-		//_process_signal.notify_all();
+		_request_tracker.complete(LOGIN_REQUEST_ID, errorCode);
 	}
 }
 void tap_api_trader::OnAPIReady()noexcept
 {
 	LOG_INFO("OnAPIReady :", _ip.c_str(), _port);
-	_process_signal.notify_all();
+	_request_tracker.complete(LOGIN_REQUEST_ID, 0);
 }
 void tap_api_trader::OnDisconnect(TAPIINT32 reasonCode)noexcept
 {
 	_is_connected = false;
+	if (_is_inited)
+	{
+		//登录以后断线，等待中的查询不会再有应答
+		_request_tracker.abort_all();
+	}
 }
 
 void tap_api_trader::OnRtnOrder(const TapAPIOrderInfoNotice* notice)noexcept
@@ -381,9 +401,8 @@ void tap_api_trader::OnRspQryOrder(TAPIUINT32 sessionID, TAPIINT32 errorCode, TA
 	{
 		LOG_ERROR("OnRspQryOrder : ", errorCode);
 	}
-	if (_is_in_query)
+	if (_is_order_reset.exchange(false))
 	{
-		while (!_is_in_query.exchange(false));
 		_order_info.clear();
 	}
 	if(info && info->OrderState != TAPI_ORDER_STATE_FAIL && info->OrderState != TAPI_ORDER_STATE_CANCELED && info->OrderState != TAPI_ORDER_STATE_FINISHED)
@@ -411,17 +430,20 @@ void tap_api_trader::OnRspQryOrder(TAPIUINT32 sessionID, TAPIINT32 errorCode, TA
 		
 	}
 	
-	if(isLast == APIYNFLAG_YES && _is_sync_wait)
+	if(isLast == APIYNFLAG_YES)
 	{
-		_process_signal.notify_all();
+		_request_tracker.complete(ORDER_REQUEST_ID, errorCode);
 	}
 }
 
 void tap_api_trader::OnRspQryPosition(TAPIUINT32 sessionID, TAPIINT32 errorCode, TAPIYNFLAG isLast, const TapAPIPositionInfo* info)noexcept
 {
-	if (_is_in_query)
+	if(errorCode != TAPIERROR_SUCCEED)
+	{
+		LOG_ERROR("OnRspQryPosition : ", errorCode);
+	}
+	if (_is_position_reset.exchange(false))
 	{
-		while (!_is_in_query.exchange(false));
 		_position_info.clear();
 	}
 	if(info)
@@ -462,9 +484,9 @@ void tap_api_trader::OnRspQryPosition(TAPIUINT32 sessionID, TAPIINT32 errorCode,
 			}
 		}
 	}
-	if (isLast == APIYNFLAG_YES && _is_sync_wait)
+	if (isLast == APIYNFLAG_YES)
 	{
-		_process_signal.notify_all();
+		_request_tracker.complete(POSITION_REQUEST_ID, errorCode);
 	}
 }
 
@@ -492,59 +514,13 @@ estid_t tap_api_trader::place_order(offset_type offset, direction_type direction
 	PROFILE_DEBUG(code.get_id());
 	LOG_INFO("ctp_api_trader place_order %s %d", code.get_id(), volume);
 
-	TapAPINewOrder stNewOrder;
-	memset(&stNewOrder, 0, sizeof(stNewOrder));
 	auto extid = generate_estid();
-	strcpy(stNewOrder.AccountNo, _userid.c_str());
-	strcpy(stNewOrder.ExchangeNo, code.get_excg());
-	stNewOrder.CommodityType = TAPI_COMMODITY_TYPE_FUTURES;
-	strcpy(stNewOrder.CommodityNo, code.get_cmdtid());
-	snprintf(stNewOrder.ContractNo, 11, "%d", code.get_cmdtno());
-	strcpy(stNewOrder.StrikePrice, "");
-	stNewOrder.CallOrPutFlag = TAPI_CALLPUT_FLAG_NONE;
-	strcpy(stNewOrder.ContractNo2, "");
-	strcpy(stNewOrder.StrikePrice2, "");
-	stNewOrder.CallOrPutFlag2 = TAPI_CALLPUT_FLAG_NONE;
-	if(price > .0)
-	{
-		stNewOrder.OrderType = TAPI_ORDER_TYPE_LIMIT;
-	}
-	else
-	{
-		stNewOrder.OrderType = TAPI_ORDER_TYPE_MARKET;
-	}
-	
-	stNewOrder.OrderSource = TAPI_ORDER_SOURCE_ESUNNY_API;
-	if(flag == order_flag::OF_FAK)
-	{
-		stNewOrder.TimeInForce = TAPI_ORDER_TIMEINFORCE_FAK;
-	}
-	else if(flag == order_flag::OF_FOK)
-	{
-		stNewOrder.TimeInForce = TAPI_ORDER_TIMEINFORCE_FOK;
-	}
-	else
-	{
-		stNewOrder.TimeInForce = TAPI_ORDER_TIMEINFORCE_GFD;
-	}
-	strcpy(stNewOrder.ExpireTime, "");
-	stNewOrder.IsRiskOrder = APIYNFLAG_NO;
-	stNewOrder.OrderSide = convert_direction_offset(direction, offset);
-	stNewOrder.PositionEffect = convert_offset_type(code, volume,offset, direction);
-	stNewOrder.PositionEffect2 = TAPI_PositionEffect_NONE;
-	strcpy(stNewOrder.InquiryNo, "");
-	stNewOrder.HedgeFlag = TAPI_HEDGEFLAG_T;
+	//拷贝模板，只修改价格、数量和引用
+	TapAPINewOrder stNewOrder = get_order_template(code)[order_template_index(direction, offset, flag)];
+	stNewOrder.OrderType = price > .0 ? TAPI_ORDER_TYPE_LIMIT : TAPI_ORDER_TYPE_MARKET;
 	stNewOrder.OrderPrice = price;
 	stNewOrder.OrderQty = volume;
-	snprintf(stNewOrder.RefString, 51, "%llu", extid);
-	stNewOrder.TacticsType = TAPI_TACTICS_TYPE_NONE;
-	stNewOrder.TriggerCondition = TAPI_TRIGGER_CONDITION_NONE;
-	stNewOrder.TriggerPriceType = TAPI_TRIGGER_PRICE_NONE;
-	stNewOrder.AddOneIsValid = APIYNFLAG_NO;
-	stNewOrder.OrderQty2;
-	stNewOrder.HedgeFlag2 = TAPI_HEDGEFLAG_NONE;
-	stNewOrder.MarketLevel = TAPI_MARKET_LEVEL_0;
-	stNewOrder.FutureAutoCloseFlag = APIYNFLAG_NO; // V9.0.2.0 20150520
+	string_helper::format_uint(stNewOrder.RefString, extid);
 
 	auto iErr = _td_api->InsertOrder(&_reqid, &stNewOrder);
 	if (TAPIERROR_SUCCEED != iErr) {
@@ -570,11 +546,11 @@ bool tap_api_trader::cancel_order(estid_t estid)
 		LOG_ERROR("cancel_order order invalid : %llu", estid);
 		return false;
 	}
-	TapAPIOrderCancelReq cancel ;
+	TapAPIOrderCancelReq cancel = _cancel_template;
 	auto& order = it->second;
 	strcpy(cancel.OrderNo, order.OrderNo);
 	cancel.ServerFlag = order.ServerFlag;
-	snprintf(cancel.RefString, 51, "%llu", estid);
+	string_helper::format_uint(cancel.RefString, estid);
 	
 	LOG_INFO("CancelOrder :", cancel.OrderNo, cancel.ServerFlag, cancel.RefString);
 	auto iResult = _td_api->CancelOrder(&_reqid, &cancel);
@@ -586,6 +562,70 @@ bool tap_api_trader::cancel_order(estid_t estid)
 	return true;
 }
 
+void tap_api_trader::prepare_order_template()
+{
+	for (const auto& it : _id_excg_map)
+	{
+		get_order_template(code_t(it.first.c_str(), it.second.c_str()));
+	}
+	LOG_INFO("tap_api_trader prepare_order_template :", _order_template.size());
+}
+
+const tap_api_trader::order_template& tap_api_trader::get_order_template(const code_t& code)
+{
+	auto it = _order_template.find(code);
+	if (it != _order_template.end())
+	{
+		return it->second;
+	}
+	//没有提前生成的合约第一次下单时生成
+	auto& result = _order_template[code];
+	build_order_template(code, result);
+	return result;
+}
+
+void tap_api_trader::build_order_template(const code_t& code, order_template& result)
+{
+	TapAPINewOrder stNewOrder;
+	memset(&stNewOrder, 0, sizeof(stNewOrder));
+	strcpy(stNewOrder.AccountNo, _userid.c_str());
+	strcpy(stNewOrder.ExchangeNo, code.get_excg());
+	stNewOrder.CommodityType = TAPI_COMMODITY_TYPE_FUTURES;
+	strcpy(stNewOrder.CommodityNo, code.get_cmdtid());
+	snprintf(stNewOrder.ContractNo, 11, "%d", code.get_cmdtno());
+	stNewOrder.CallOrPutFlag = TAPI_CALLPUT_FLAG_NONE;
+	stNewOrder.CallOrPutFlag2 = TAPI_CALLPUT_FLAG_NONE;
+	stNewOrder.OrderSource = TAPI_ORDER_SOURCE_ESUNNY_API;
+	stNewOrder.IsRiskOrder = APIYNFLAG_NO;
+	stNewOrder.PositionEffect2 = TAPI_PositionEffect_NONE;
+	stNewOrder.HedgeFlag = TAPI_HEDGEFLAG_T;
+	stNewOrder.TacticsType = TAPI_TACTICS_TYPE_NONE;
+	stNewOrder.TriggerCondition = TAPI_TRIGGER_CONDITION_NONE;
+	stNewOrder.TriggerPriceType = TAPI_TRIGGER_PRICE_NONE;
+	stNewOrder.AddOneIsValid = APIYNFLAG_NO;
+	stNewOrder.HedgeFlag2 = TAPI_HEDGEFLAG_NONE;
+	stNewOrder.MarketLevel = TAPI_MARKET_LEVEL_0;
+	stNewOrder.FutureAutoCloseFlag = APIYNFLAG_NO; // V9.0.2.0 20150520
+	foreach_order_template([this, &code, &stNewOrder, &result](size_t index, direction_type direction, offset_type offset, order_flag flag)->void {
+		auto& req = result[index];
+		req = stNewOrder;
+		if (flag == order_flag::OF_FAK)
+		{
+			req.TimeInForce = TAPI_ORDER_TIMEINFORCE_FAK;
+		}
+		else if (flag == order_flag::OF_FOK)
+		{
+			req.TimeInForce = TAPI_ORDER_TIMEINFORCE_FOK;
+		}
+		else
+		{
+			req.TimeInForce = TAPI_ORDER_TIMEINFORCE_GFD;
+		}
+		req.OrderSide = convert_direction_offset(direction, offset);
+		req.PositionEffect = convert_offset_type(code, 0, offset, direction);
+	});
+}
+
 uint32_t tap_api_trader::get_trading_day()const
 {
 	if (_td_api)
@@ -597,18 +637,21 @@ uint32_t tap_api_trader::get_trading_day()const
 
 std::shared_ptr<trader_data> tap_api_trader::get_trader_data()
 {
-	auto result = std::make_shared<trader_data>();
-	if (!query_positions(true))
+	auto deadline = std::chrono::steady_clock::now() + _query_timeout;
+	//持仓和委托查询先全部发出再一起等待应答
+	if (!query_positions() || !query_orders())
 	{
-		LOG_ERROR("query_positions error");
-		return result;
+		LOG_ERROR("tap trader get_trader_data request error");
+		return nullptr;
 	}
-	if (!query_orders(true))
+	int32_t position_result = _request_tracker.wait(POSITION_REQUEST_ID, deadline);
+	int32_t order_result = _request_tracker.wait(ORDER_REQUEST_ID, deadline);
+	if (position_result != TAPIERROR_SUCCEED || order_result != TAPIERROR_SUCCEED)
 	{
-		LOG_ERROR("query_orders error");
-		return result;
+		LOG_ERROR("tap trader get_trader_data query error :", position_result, order_result);
+		return nullptr;
 	}
-	
+	auto result = std::make_shared<trader_data>();
 	for (auto it : _order_info)
 	{
 		result->orders.emplace_back(it.second);
@@ -28,9 +28,11 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include <log_wapper.hpp>
 #include <trader_api.h>
 #include <params.hpp>
-#include <condition_variable>
+#include <chrono>
 #include <TAP_V9_20200808/TapTradeAPI.h>
 #include <dll_helper.hpp>
+#include "order_template.hpp"
+#include "request_tracker.hpp"
 
 
 namespace lt::driver
@@ -43,6 +45,14 @@ namespace lt::driver
 			TAPISTR_20					OrderNo;						///< 委托编码
 		};
 
+		//合约下单模板（除价格、数量、引用以外的字段都预先填好）
+		typedef std::array<TapAPINewOrder, ORDER_TEMPLATE_COUNT> order_template;
+
+		//TAP的请求号在请求函数返回时才拿到，应答可能先到，按请求类型跟踪
+		static constexpr uint32_t LOGIN_REQUEST_ID = 0;
+		static constexpr uint32_t POSITION_REQUEST_ID = 1;
+		static constexpr uint32_t ORDER_REQUEST_ID = 2;
+
 	public:
 
 		tap_api_trader(std::unordered_map<std::string, std::string>& id_excg_map, const params& config);
@@ -108,9 +118,17 @@ namespace lt::driver
 
 	private:
 
-		bool query_positions(bool is_sync);
+		//发送查询，应答通过_request_tracker等待
+		bool query_positions();
+
+		//登录后为已知合约预先生成模板
+		void prepare_order_template();
+
+		const order_template& get_order_template(const code_t& code);
+
+		void build_order_template(const code_t& code, order_template& result);
 
-		bool query_orders(bool is_sync);
+		bool query_orders();
 
 	private:
 
@@ -222,18 +240,24 @@ namespace lt::driver
 		entrust_map						_order_info;
 		//
 		std::map<estid_t, order_index>	_order_index;
+		//下单模板
+		std::map<code_t, order_template>	_order_template;
+		//撤单模板
+		TapAPIOrderCancelReq			_cancel_template;
 
 		bool					_is_runing;
 
 
-		std::mutex _mutex;
-		std::unique_lock<std::mutex>	_process_mutex;
-		std::condition_variable			_process_signal;
+		//同步请求（登录、查询）的应答跟踪
+		request_tracker					_request_tracker;
+		std::chrono::milliseconds		_login_timeout;
+		std::chrono::milliseconds		_query_timeout;
+		//查询的第一条应答到达时清空旧数据
+		std::atomic<bool>				_is_position_reset;
+		std::atomic<bool>				_is_order_reset;
 
 		bool							_is_inited;
 		bool							_is_connected;
-		std::atomic<bool>				_is_sync_wait;
-		std::atomic<bool>				_is_in_query;
 
 		typedef ITapTradeAPI* (*trader_creator)(const TapAPIApplicationInfo* appInfo, TAPIINT32& iResult);
 		trader_creator					_tap_creator;
@@ -0,0 +1,162 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <define.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <interface.h>
+
+/*
+*	统计market_simulator发布阶段的内存分配次数
+*	用法：tick_frame_benchmark [合约数量] [秒数]
+*/
+
+static std::atomic<uint64_t> _alloc_count(0);
+
+void* operator new(size_t size)
+{
+	_alloc_count.fetch_add(1, std::memory_order_relaxed);
+	void* ptr = std::malloc(size ? size : 1);
+	if (ptr == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+	std::free(ptr);
+}
+
+static void write_tick_file(const std::string& filename, const char* id, uint32_t trading_day, uint32_t seconds)
+{
+	std::ofstream file(filename);
+	uint64_t volume = 0;
+	for (uint32_t i = 0; i < seconds; i++)
+	{
+		uint32_t second = 9 * 3600 + i;
+		char time_str[16] = { 0 };
+		sprintf(time_str, "%02u:%02u:%02u", second / 3600, (second % 3600) / 60, second % 60);
+		for (uint32_t tick = 0; tick < 1000; tick += 500)
+		{
+			volume += 3;
+			double_t price = 4000 + (i % 20);
+			std::string cell[44];
+			std::fill(std::begin(cell), std::end(cell), "0");
+			cell[0] = std::to_string(trading_day);
+			cell[1] = id;
+			cell[4] = std::to_string(price);
+			cell[5] = cell[8] = cell[9] = cell[10] = cell[14] = std::to_string(4000);
+			cell[11] = std::to_string(volume);
+			cell[13] = std::to_string(100000);
+			cell[16] = std::to_string(4400);
+			cell[17] = std::to_string(3600);
+			cell[20] = time_str;
+			cell[21] = std::to_string(tick);
+			for (size_t level = 0; level < 5; level++)
+			{
+				cell[22 + level * 4] = std::to_string(price - 1 - level);
+				cell[23 + level * 4] = std::to_string(10);
+				cell[24 + level * 4] = std::to_string(price + 1 + level);
+				cell[25 + level * 4] = std::to_string(10);
+			}
+			for (size_t c = 0; c < 44; c++)
+			{
+				file << cell[c] << (c + 1 < 44 ? "," : "\n");
+			}
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	uint32_t instrument_count = argc > 1 ? std::atoi(argv[1]) : 8;
+	uint32_t seconds = argc > 2 ? std::atoi(argv[2]) : 3600;
+	const uint32_t trading_day = 20220801;
+
+	auto root = std::filesystem::temp_directory_path() / "lightning_tick_frame_benchmark";
+	std::filesystem::create_directories(root);
+	std::set<lt::code_t> codes;
+	for (uint32_t i = 0; i < instrument_count; i++)
+	{
+		char id[16] = { 0 };
+		sprintf(id, "rb%04u", 2200 + i);
+		write_tick_file((root / (std::string(id) + "_" + std::to_string(trading_day) + ".csv")).string(), id, trading_day, seconds);
+		codes.insert(lt::code_t(id, EXCHANGE_ID_SHFE));
+	}
+
+	std::map<std::string, std::string> config;
+	config["interval"] = "1";
+	config["loader_type"] = "csv";
+	config["csv_data_path"] = (root / "%s_%d.csv").string();
+	lt::dummy_market* market = create_dummy_market(lt::params(config));
+
+	uint64_t tick_count = 0;
+	uint64_t frame_count = 0;
+	market->bind_event(lt::market_event_type::MET_TickFrame, [&tick_count, &frame_count](const std::vector<std::any>& param)->void {
+		const lt::tick_frame* frame = std::any_cast<const lt::tick_frame*>(param[0]);
+		tick_count += frame->size();
+		frame_count++;
+	});
+	market->subscribe(codes);
+	market->play(trading_day, [](const std::vector<const lt::tick_info*>&)->void {});
+	//第一次update加载数据
+	market->update();
+	if (market->is_finished())
+	{
+		std::cout << "no tick loaded" << std::endl;
+		return -1;
+	}
+
+	uint64_t begin_alloc = _alloc_count.load();
+	auto begin_time = std::chrono::steady_clock::now();
+	while (!market->is_finished())
+	{
+		market->update();
+	}
+	auto use_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin_time).count();
+	uint64_t alloc_count = _alloc_count.load() - begin_alloc;
+
+	std::cout << "instruments : " << instrument_count << std::endl;
+	std::cout << "ticks : " << tick_count << " frames : " << frame_count << std::endl;
+	std::cout << "publish allocations : " << alloc_count << std::endl;
+	if (frame_count > 0 && tick_count > 0)
+	{
+		std::cout << "allocations per frame : " << static_cast<double_t>(alloc_count) / frame_count << std::endl;
+		std::cout << "allocations per tick : " << static_cast<double_t>(alloc_count) / tick_count << std::endl;
+		std::cout << "ns per tick : " << use_time * 1000.0 / tick_count << std::endl;
+	}
+	destory_dummy_market(market);
+	std::filesystem::remove_all(root);
+	return 0;
+}
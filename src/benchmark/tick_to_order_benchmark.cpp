@@ -0,0 +1,347 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <define.h>
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <dll_helper.hpp>
+#include <log_wapper.hpp>
+#include <runtime_engine.h>
+#include <strategy.h>
+#include <receiver.h>
+#include <engine.h>
+#include <time_utils.hpp>
+#include <loopback_api.h>
+
+/*
+*	端到端延迟测试：回环柜台推送行情 -> 适配器 -> 策略下单 -> ReqOrderInsert
+*	用法：tick_to_order_benchmark [秒数] [行情间隔微秒] [逻辑线程循环间隔微秒] [行情日志目录] [ctp|tap]
+*	逻辑线程默认忙等，核心数不足时行情线程会被饿死，默认改为100微秒
+*	行情日志目录为空时回环柜台按订阅合约生成模拟行情，接口默认ctp
+*	每笔报单按触发它的那笔行情计时：行情钩子按发送顺序记下测试合约每笔行情的发送时刻
+*	策略下单前记下行情时间和累计成交量，行情间隔小于1毫秒时同一毫秒内的行情靠成交量区分
+*/
+
+//最多保留的行情发送时刻，只用来找触发报单的那笔行情
+static constexpr size_t MAX_PENDING_TICK = 4096;
+
+struct pending_tick
+{
+	lt::daytm_t time;
+
+	uint64_t volume;
+
+	int64_t send_ns;
+};
+
+//测试合约的合约编号，只记录这个合约的行情
+static std::string _tick_id;
+
+static std::atomic<uint64_t> _tick_count(0);
+
+static std::mutex _tick_mutex;
+
+//按发送顺序排列
+static std::deque<pending_tick> _tick_send_ns;
+
+//策略下单前写入触发报单的行情
+static std::mutex _trigger_mutex;
+
+static lt::daytm_t _trigger_time = 0;
+
+static uint64_t _trigger_volume = 0;
+
+static std::atomic<uint64_t> _unmatched_count(0);
+
+static std::mutex _latency_mutex;
+
+static std::vector<int64_t> _latency;
+
+static int64_t steady_ns()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void record_tick(const std::string& id, lt::daytm_t time, uint64_t volume)
+{
+	int64_t send_ns = steady_ns();
+	_tick_count.fetch_add(1, std::memory_order_relaxed);
+	if (id != _tick_id)
+	{
+		return;
+	}
+	std::lock_guard<std::mutex> lock(_tick_mutex);
+	_tick_send_ns.push_back({ time, volume, send_ns });
+	if (_tick_send_ns.size() > MAX_PENDING_TICK)
+	{
+		_tick_send_ns.pop_front();
+	}
+}
+
+static void record_trigger(const lt::tick_info& tick)
+{
+	std::lock_guard<std::mutex> lock(_trigger_mutex);
+	_trigger_time = tick.time;
+	_trigger_volume = tick.volume;
+}
+
+static void record_order()
+{
+	int64_t order_ns = steady_ns();
+	lt::daytm_t trigger_time = 0;
+	uint64_t trigger_volume = 0;
+	{
+		std::lock_guard<std::mutex> lock(_trigger_mutex);
+		trigger_time = _trigger_time;
+		trigger_volume = _trigger_volume;
+	}
+	int64_t delta = 0;
+	{
+		std::lock_guard<std::mutex> lock(_tick_mutex);
+		auto it = std::find_if(_tick_send_ns.begin(), _tick_send_ns.end(), [trigger_time, trigger_volume](const pending_tick& tick)->bool {
+			return tick.time == trigger_time && tick.volume == trigger_volume;
+		});
+		if (it == _tick_send_ns.end())
+		{
+			_unmatched_count.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		delta = order_ns - it->send_ns;
+		//更早的行情不会再触发报单
+		_tick_send_ns.erase(_tick_send_ns.begin(), it + 1);
+	}
+	std::lock_guard<std::mutex> lock(_latency_mutex);
+	_latency.emplace_back(delta);
+}
+
+//行情时间的解析和ctp_api_market/tap_api_market一致
+static void on_loopback_tick(const CThostFtdcDepthMarketDataField* tick)
+{
+	record_tick(tick->InstrumentID, lt::decode_daytm(tick->UpdateTime, static_cast<uint32_t>(tick->UpdateMillisec)), static_cast<uint64_t>(tick->Volume));
+}
+
+static void on_loopback_order(const CThostFtdcInputOrderField* /*order*/)
+{
+	record_order();
+}
+
+static void on_tap_tick(const TapAPIQuoteWhole* tick)
+{
+	record_tick(std::string(tick->Contract.Commodity.CommodityNo) + tick->Contract.ContractNo1, lt::make_daytm(tick->DateTimeStamp + 11, true), static_cast<uint64_t>(tick->QTotalQty));
+}
+
+static void on_tap_order(const TapAPINewOrder* /*order*/)
+{
+	record_order();
+}
+
+/*
+*	每笔行情交替下单和撤单，挂单价格远离盘口不会成交
+*	委托回报以后才撤单，撤单回报之前只发一次撤单
+*/
+class latency_strategy : public lt::hft::strategy, public lt::hft::tick_receiver
+{
+	lt::code_t _code;
+
+	lt::estid_t _order;
+
+	bool _is_entrusted;
+
+	bool _is_canceling;
+
+public:
+
+	latency_strategy(lt::hft::straid_t id, lt::hft::engine* engine, const lt::code_t& code) :
+		lt::hft::strategy(id, engine, true, true),
+		_code(code),
+		_order(INVALID_ESTID),
+		_is_entrusted(false),
+		_is_canceling(false)
+	{}
+
+	virtual void on_init(lt::hft::subscriber& suber) override
+	{
+		suber.regist_tick_receiver(_code, this);
+	}
+
+	virtual void on_tick(const lt::tick_info& tick) override
+	{
+		if (_order == INVALID_ESTID)
+		{
+			double_t price = get_proximate_price(_code, tick.buy_price() - get_price_step(_code) * 50);
+			record_trigger(tick);
+			_order = buy_open(_code, 1, price);
+		}
+		else if (_is_entrusted && !_is_canceling)
+		{
+			cancel_order(_order);
+			_is_canceling = true;
+		}
+	}
+
+	virtual void on_entrust(const lt::order_info& order) override
+	{
+		if (order.estid == _order)
+		{
+			_is_entrusted = true;
+		}
+	}
+
+	virtual void on_cancel(lt::estid_t estid, const lt::code_t& code, lt::offset_type offset, lt::direction_type direction, double_t price, uint32_t cancel_volume, uint32_t total_volume) override
+	{
+		if (estid == _order)
+		{
+			_order = INVALID_ESTID;
+			_is_entrusted = false;
+			_is_canceling = false;
+		}
+	}
+
+	virtual void on_trade(lt::estid_t estid, const lt::code_t& code, lt::offset_type offset, lt::direction_type direction, double_t price, uint32_t volume) override
+	{
+		if (estid == _order)
+		{
+			_order = INVALID_ESTID;
+			_is_entrusted = false;
+			_is_canceling = false;
+		}
+	}
+
+	virtual void on_error(lt::error_type type, lt::estid_t estid, const lt::error_code error) override
+	{
+		if (type == lt::error_type::ET_PLACE_ORDER && estid == _order)
+		{
+			_order = INVALID_ESTID;
+			_is_entrusted = false;
+			_is_canceling = false;
+		}
+	}
+};
+
+static void write_config(const std::filesystem::path& root, const char* code, uint32_t loop_interval, bool is_tap)
+{
+	std::ofstream(root / "section.csv") << "id,begin,end,day_or_night\n"
+		<< "1,21:00:00,02:30:00,0\n"
+		<< "2,09:00:00,15:00:00,1\n";
+	std::ofstream(root / "price_step.csv") << "code,price_step,\n" << code << ",1,\n";
+	std::ofstream(root / "runtime.ini") << "[include]\n"
+		<< "section_config = " << (root / "section.csv").string() << "\n"
+		<< "price_step = " << (root / "price_step.csv").string() << "\n"
+		<< "[actual_market]\n"
+		<< (is_tap ? "market = tap_api\nip = 127.0.0.1\nport = 0\n" : "market = ctp_api\nfront = tcp://127.0.0.1:0\nbroker = loopback\n")
+		<< "userid = loopback\npasswd = loopback\nauthcode = loopback\n"
+		<< "[actual_trader]\n"
+		<< (is_tap ? "trader = tap_api\nip = 127.0.0.1\nport = 0\n" : "trader = ctp_api\nfront = tcp://127.0.0.1:0\nbroker = loopback\n")
+		<< "userid = loopback\npasswd = loopback\n"
+		<< "appid = loopback\nauthcode = loopback\nproduct = lightning\n"
+		<< "[control]\n"
+		<< "bind_cpu_core = -1\nloop_interval = " << loop_interval << "\nprocess_priority = -1\nthread_priority = -1\n";
+}
+
+static int64_t percentile(const std::vector<int64_t>& sorted, double_t ratio)
+{
+	size_t index = static_cast<size_t>(ratio * (sorted.size() - 1));
+	return sorted[index];
+}
+
+int main(int argc, char* argv[])
+{
+	uint32_t seconds = argc > 1 ? std::atoi(argv[1]) : 10;
+	uint32_t interval_us = argc > 2 ? std::atoi(argv[2]) : 1000;
+	uint32_t loop_interval = argc > 3 ? std::atoi(argv[3]) : (std::thread::hardware_concurrency() > 2 ? 0 : 100);
+	const char* journal_path = argc > 4 ? argv[4] : "";
+	const bool is_tap = argc > 5 && std::string(argv[5]) == "tap";
+	const char* code = "SHFE.rb2410";
+
+	_tick_id = lt::code_t(code).get_id();
+
+	//先按完整路径加载回环柜台，适配器再按库名加载时拿到的是同一个库
+	dll_handle market_handle = dll_helper::load_library(is_tap ? LOOPBACK_TAP_MARKET_LIBRARY : LOOPBACK_MARKET_LIBRARY);
+	dll_handle trader_handle = dll_helper::load_library(is_tap ? LOOPBACK_TAP_TRADER_LIBRARY : LOOPBACK_TRADER_LIBRARY);
+	if (market_handle == nullptr || trader_handle == nullptr)
+	{
+		std::cout << "loopback library load error" << std::endl;
+		return -1;
+	}
+	//两种接口导出同名函数，钩子按接口转换
+	auto market_config = reinterpret_cast<loopback_market_config_fn>(dll_helper::get_symbol(market_handle, LOOPBACK_MARKET_CONFIG));
+	auto market_hook = dll_helper::get_symbol(market_handle, LOOPBACK_MARKET_HOOK);
+	auto trader_config = reinterpret_cast<loopback_trader_config_fn>(dll_helper::get_symbol(trader_handle, LOOPBACK_TRADER_CONFIG));
+	auto trader_hook = dll_helper::get_symbol(trader_handle, LOOPBACK_TRADER_HOOK);
+	if (market_config == nullptr || market_hook == nullptr || trader_config == nullptr || trader_hook == nullptr)
+	{
+		std::cout << "loopback symbol not found" << std::endl;
+		return -1;
+	}
+	market_config(journal_path, interval_us);
+	trader_config(100, 100);
+	if (is_tap)
+	{
+		reinterpret_cast<loopback_tap_market_hook_fn>(market_hook)(on_tap_tick);
+		reinterpret_cast<loopback_tap_trader_hook_fn>(trader_hook)(on_tap_order);
+	}
+	else
+	{
+		reinterpret_cast<loopback_market_hook_fn>(market_hook)(on_loopback_tick);
+		reinterpret_cast<loopback_trader_hook_fn>(trader_hook)(on_loopback_order);
+	}
+
+	auto root = std::filesystem::temp_directory_path() / "lightning_tick_to_order_benchmark";
+	std::filesystem::create_directories(root);
+	write_config(root, code, loop_interval, is_tap);
+	init_log((root / "log").string().c_str(), 128);
+	_latency.reserve(static_cast<size_t>(seconds) * 1000000 / std::max(interval_us, 1U));
+	{
+		auto app = std::make_shared<lt::hft::runtime_engine>((root / "runtime.ini").string().c_str());
+		std::vector<std::shared_ptr<lt::hft::strategy>> strategys;
+		strategys.emplace_back(std::make_shared<latency_strategy>(1, app.get(), lt::code_t(code)));
+		app->start_trading(strategys);
+		std::this_thread::sleep_for(std::chrono::seconds(seconds));
+		app->stop_trading();
+	}
+
+	std::vector<int64_t> sorted;
+	{
+		std::lock_guard<std::mutex> lock(_latency_mutex);
+		sorted = _latency;
+	}
+	std::cout << "ticks : " << _tick_count.load() << " orders : " << sorted.size() << " unmatched : " << _unmatched_count.load() << std::endl;
+	if (!sorted.empty())
+	{
+		std::sort(sorted.begin(), sorted.end());
+		std::cout << "tick to order p50 : " << percentile(sorted, 0.5) << " ns" << std::endl;
+		std::cout << "tick to order p99 : " << percentile(sorted, 0.99) << " ns" << std::endl;
+		std::cout << "tick to order p99.9 : " << percentile(sorted, 0.999) << " ns" << std::endl;
+		std::cout << "tick to order max : " << sorted.back() << " ns" << std::endl;
+	}
+	std::filesystem::remove_all(root);
+	return 0;
+}
@@ -23,6 +23,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include "arbitrage_strategy.h"
 #include "time_utils.hpp"
 #include <string_helper.hpp>
+#include <binary_stream.hpp>
 
 using namespace lt;
 using namespace lt::hft;
@@ -82,14 +83,8 @@ void arbitrage_strategy::on_entrust(const order_info& order)
 	{
 		if (_order_data.order_estids[i] == order.estid)
 		{
-			set_cancel_condition(order.estid, [this](estid_t estid)->bool {
-
-				if (is_close_coming())
-				{
-					return true;
-				}
-				return false;
-				});
+			//ǰҵ
+			set_cancel_at(order.estid, make_daytm("14:58:00", 0U));
 			regist_order_listener(order.estid);
 			break;
 		}
@@ -200,6 +195,34 @@ void arbitrage_strategy::on_destroy(unsubscriber& unsuber)
 	unsuber.unregist_tick_receiver(_code2, this);
 }
 
+void arbitrage_strategy::on_save(std::vector<uint8_t>& data)
+{
+	lt::binary_writer writer(data);
+	for (size_t i = 0; i < PSRDT_ORDER_COUNT; i++)
+	{
+		writer.write(_order_data.order_estids[i]);
+	}
+	writer.write(static_cast<uint8_t>(_order_data.a_state)).write(static_cast<uint8_t>(_order_data.t_state));
+}
+
+void arbitrage_strategy::on_load(const std::vector<uint8_t>& data)
+{
+	persist_data order_data;
+	uint8_t a_state = 0;
+	uint8_t t_state = 0;
+	lt::binary_reader reader(data);
+	for (size_t i = 0; i < PSRDT_ORDER_COUNT; i++)
+	{
+		reader.read(order_data.order_estids[i]);
+	}
+	if (reader.read(a_state) && reader.read(t_state) && reader.eof())
+	{
+		order_data.a_state = static_cast<arbitrage_state>(a_state);
+		order_data.t_state = static_cast<trade_state>(t_state);
+		_order_data = order_data;
+	}
+}
+
 void arbitrage_strategy::on_update()
 {
 	if (_order_data.a_state == arbitrage_state::AS_BUY_INTEREST)
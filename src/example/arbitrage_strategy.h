@@ -75,6 +75,12 @@ public:
 		_offset(offset)
 
 	{
+		for (size_t i = 0; i < PSRDT_ORDER_COUNT; i++)
+		{
+			_order_data.order_estids[i] = INVALID_ESTID;
+		}
+		_order_data.a_state = arbitrage_state::AS_INVALID;
+		_order_data.t_state = trade_state::TS_INVALID;
 	};
 
 	virtual ~arbitrage_strategy()
@@ -130,6 +136,16 @@ public:
 	 */
 	virtual void on_destroy(lt::hft::unsubscriber& unsuber)override;
 
+	/*
+	 *	־û
+	 */
+	virtual void on_save(std::vector<uint8_t>& data) override;
+
+	/*
+	 *	ָ־û
+	 */
+	virtual void on_load(const std::vector<uint8_t>& data) override;
+
 	/*
 	 *	ÿ֡
 	 */
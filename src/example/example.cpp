@@ -26,6 +26,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include <thread>
 #include "runtime_engine.h"
 #include "evaluate_engine.h"
+#include "parameter_sweep.h"
 #include "marketing_strategy.h"
 #include <time_utils.hpp>
 #include "orderflow_strategy.h"
@@ -40,15 +41,7 @@ void start_runtime(const char* account_config)
 	strategys.emplace_back(std::make_shared<marketing_strategy>(2, app.get(), "SHFE.hc2210", 1, 1));
 	strategys.emplace_back(std::make_shared<orderflow_strategy>(3, app.get(), "SHFE.rb2210", 1, 1, 3, 3, 10));
 	strategys.emplace_back(std::make_shared<orderflow_strategy>(4, app.get(), "SHFE.hc2210", 1, 1, 3, 3, 10));
-	app->set_trading_filter([app](const lt::code_t& code, lt::offset_type offset, lt::direction_type direction, uint32_t count, double_t price, lt::order_flag flag)->bool {
-		auto now = app->get_last_time();
-		auto last_order = app->last_order_time();
-		if (now - last_order < 1)
-		{
-			return false;
-		}
-		return true;
-		});
+	//下单频率限制在runtime.ini的[control]里配置（session_order_limit等）
 	app->start_trading(strategys);
 	time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
 	time_t delta_seconds = lt::make_datetime(app->get_trading_day(), "15:00:00") - now;
@@ -74,11 +67,37 @@ void start_evaluate(const char* account_config, const std::vector<uint32_t>& tra
 	}
 }
 
+void start_sweep(const char* account_config, const std::vector<uint32_t>& trading_days)
+{
+	std::vector<lt::params> combinations;
+	for (uint32_t open_once = 1; open_once <= 3; open_once++)
+	{
+		for (double_t open_delta = 1; open_delta <= 5; open_delta++)
+		{
+			std::map<std::string, std::string> param;
+			param["open_delta"] = std::to_string(open_delta);
+			param["open_once"] = std::to_string(open_once);
+			combinations.emplace_back(param);
+		}
+	}
+	lt::hft::parameter_sweep sweep(account_config);
+	sweep.run(combinations, trading_days, [](lt::hft::evaluate_engine* app, const lt::params& param)->std::vector<std::shared_ptr<lt::hft::strategy>> {
+		std::vector<std::shared_ptr<lt::hft::strategy>> strategys;
+		strategys.emplace_back(std::make_shared<marketing_strategy>(1, app, "SHFE.rb2210", param.get<double_t>("open_delta"), param.get<uint32_t>("open_once")));
+		return strategys;
+	});
+	sweep.save_result("./sweep_result.csv");
+}
 
 int main(int argc, char* argv[])
 {
 	init_log("./log", 128);
-	if (argc > 1)
+	if (argc > 1 && std::strcmp(argv[1], "sweep") == 0)
+	{
+		std::vector<uint32_t> trading_days{ 20220801, 20220802, 20220803, 20220804, 20220805 };
+		start_sweep("evaluate.ini", trading_days);
+	}
+	else if (argc > 1)
 	{
 		start_runtime("runtime.ini");
 	}
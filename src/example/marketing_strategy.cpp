@@ -23,6 +23,8 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include "marketing_strategy.h"
 #include "time_utils.hpp"
 #include <string_helper.hpp>
+#include <binary_stream.hpp>
+#include <sstream>
 
 using namespace lt;
 using namespace lt::hft;
@@ -93,14 +95,8 @@ void marketing_strategy::on_entrust(const order_info& order)
 
 	if (order.estid == _order_data.buy_order || order.estid == _order_data.sell_order)
 	{
-		set_cancel_condition(order.estid, [this](estid_t estid)->bool {
-
-			if (is_close_coming())
-			{
-				return true;
-			}
-			return false;
-			});
+		//ǰҵ
+		set_cancel_at(order.estid, make_daytm("14:58:00", 0U));
 	}
 }
 
@@ -155,6 +151,26 @@ void marketing_strategy::on_destroy(unsubscriber& unsuber)
 	unsuber.unregist_tick_receiver(_code, this);
 }
 
+void marketing_strategy::on_save(std::vector<uint8_t>& data)
+{
+	std::ostringstream random_state;
+	random_state << _random_engine;
+	lt::binary_writer writer(data);
+	writer.write(_order_data.sell_order).write(_order_data.buy_order).write(random_state.str());
+}
+
+void marketing_strategy::on_load(const std::vector<uint8_t>& data)
+{
+	persist_data order_data;
+	std::string random_state;
+	lt::binary_reader reader(data);
+	if (reader.read(order_data.sell_order) && reader.read(order_data.buy_order) && reader.read(random_state) && reader.eof())
+	{
+		_order_data = order_data;
+		std::istringstream(random_state) >> _random_engine;
+	}
+}
+
 bool marketing_strategy::is_close_coming()const {
 	return make_daytm("14:58:00", 0U) < get_last_time();
 }
\ No newline at end of file
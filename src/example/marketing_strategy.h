@@ -45,7 +45,8 @@ public:
 		_open_delta(open_detla),
 		_random(0, 1)
 	{
-
+		_order_data.buy_order = INVALID_ESTID;
+		_order_data.sell_order = INVALID_ESTID;
 	};
 
 	~marketing_strategy()
@@ -101,6 +102,16 @@ public:
 	 */
 	virtual void on_destroy(lt::hft::unsubscriber& unsuber)override;
 
+	/*
+	 *	־û
+	 */
+	virtual void on_save(std::vector<uint8_t>& data) override;
+
+	/*
+	 *	ָ־û
+	 */
+	virtual void on_load(const std::vector<uint8_t>& data) override;
+
 
 private:
 
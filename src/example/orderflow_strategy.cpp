@@ -24,6 +24,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include "orderflow_strategy.h"
 #include "time_utils.hpp"
 #include <string_helper.hpp>
+#include <binary_stream.hpp>
 
 using namespace lt;
 using namespace lt::hft;
@@ -37,13 +38,17 @@ void orderflow_strategy::on_init(subscriber& suber)
 void orderflow_strategy::on_bar(const lt::bar_info& bar)
 {
 
-	auto unbalance = bar.get_unbalance(_multiple);
+	if (_demand_mask.size() < bar.ladder_volume.size())
+	{
+		_demand_mask.resize(bar.ladder_volume.size());
+		_supply_mask.resize(bar.ladder_volume.size());
+	}
+	auto unbalance = bar.get_unbalance(_multiple, _demand_mask.data(), _supply_mask.data(), _demand_mask.size());
 	if(_order_data.buy_order == INVALID_ESTID)
 	{
 		//可以买入的
 		//需求失衡，说明有买方力量大于卖方力量，顺势而为则买入
-		auto ub = unbalance.first;
-		if(ub->size() > _threshold)
+		if(unbalance.demand > _threshold)
 		{
 			try_buy();
 		}
@@ -52,8 +57,7 @@ void orderflow_strategy::on_bar(const lt::bar_info& bar)
 	{
 		//可以卖出的
 		//需求失衡，说明有买方力量大于买方力量，顺势而为则卖出
-		auto ub = unbalance.second;
-		if (ub->size() > _threshold)
+		if (unbalance.supply > _threshold)
 		{
 			try_sell();
 		}
@@ -67,14 +71,8 @@ void orderflow_strategy::on_entrust(const order_info& order)
 
 	if (order.estid == _order_data.buy_order || order.estid == _order_data.sell_order)
 	{
-		set_cancel_condition(order.estid, [this](estid_t estid)->bool {
-
-			if (is_close_coming())
-			{
-				return true;
-			}
-			return false;
-			});
+		//收盘前撤掉挂单
+		set_cancel_at(order.estid, make_daytm("14:58:00", 0U));
 	}
 }
 
@@ -127,6 +125,22 @@ void orderflow_strategy::on_destroy(unsubscriber& unsuber)
 	unsuber.unregist_bar_receiver(_code, _period, this);
 }
 
+void orderflow_strategy::on_save(std::vector<uint8_t>& data)
+{
+	lt::binary_writer writer(data);
+	writer.write(_order_data.trading_day).write(_order_data.sell_order).write(_order_data.buy_order);
+}
+
+void orderflow_strategy::on_load(const std::vector<uint8_t>& data)
+{
+	persist_data order_data;
+	lt::binary_reader reader(data);
+	if (reader.read(order_data.trading_day) && reader.read(order_data.sell_order) && reader.read(order_data.buy_order) && reader.eof())
+	{
+		_order_data = order_data;
+	}
+}
+
 void orderflow_strategy::try_buy()
 {
 	const auto& market = get_market_info(_code);
@@ -170,8 +184,3 @@ void orderflow_strategy::try_sell()
 		_order_data.sell_order = sell_open(_code, _open_once, market.last_tick_info.buy_price());
 	}
 }
-
-
-bool orderflow_strategy::is_close_coming()const {
-	return make_daytm("14:58:00", 0U) < get_last_time();
-}
\ No newline at end of file
@@ -47,6 +47,9 @@ public:
 		_threshold(threshold),
 		_position_limit(position_limit)
 	{
+		_order_data.trading_day = 0;
+		_order_data.buy_order = INVALID_ESTID;
+		_order_data.sell_order = INVALID_ESTID;
 	};
 
 	~orderflow_strategy()
@@ -103,9 +106,17 @@ public:
 	 */
 	virtual void on_destroy(lt::hft::unsubscriber& unsuber)override;
 
-private:
+	/*
+	 *	־û
+	 */
+	virtual void on_save(std::vector<uint8_t>& data) override;
 
-	bool is_close_coming() const;
+	/*
+	 *	ָ־û
+	 */
+	virtual void on_load(const std::vector<uint8_t>& data) override;
+
+private:
 
 private:
 
@@ -133,5 +144,10 @@ private:
 
 	persist_data _order_data;
 
+	//ʧǻ壬bar֮临
+	std::vector<uint8_t> _demand_mask;
+
+	std::vector<uint8_t> _supply_mask;
+
 };
 
@@ -22,30 +22,28 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 */
 #include "bar_generator.h"
 #include "time_utils.hpp"
+#include <log_wapper.hpp>
 
 using namespace lt::hft ;
 
 void bar_generator::insert_tick(const tick_info& tick)
 {
-	if (tick.time / ONE_MINUTE_MILLISECONDS - _minute >= _period)
+	const uint32_t current_minute = static_cast<uint32_t>(tick.time / ONE_MINUTE_MILLISECONDS);
+	if (current_minute - _minute >= 1)
 	{
 		//合成
 		if (_minute > 0)
 		{
-			for (auto it : _bar_callback)
-			{
-				it->on_bar(_bar);
-			}
+			compose(current_minute);
 		}
-		_minute = (tick.time / ONE_MINUTE_MILLISECONDS);
+		_minute = current_minute;
 		_bar.clear();
 	}
 	uint32_t delta_volume = static_cast<uint32_t>(tick.volume - _prev_volume);
 	if(_bar.open == .0F)
 	{
-		_poc_data.clear();
 		_bar.id = tick.id;
-		_bar.period = _period;
+		_bar.period = 1;
 		_bar.open = tick.price;
 		_bar.close = tick.price;
 		_bar.high = tick.price;
@@ -53,8 +51,12 @@ void bar_generator::insert_tick(const tick_info& tick)
 		_bar.time = _minute * ONE_MINUTE_MILLISECONDS;
 		_bar.volume = delta_volume;
 		_bar.price_step = _price_step ;
-		_poc_data[tick.price] = delta_volume;
 		_bar.poc = tick.price;
+		if (_price_step <= .0 && !_is_step_warned)
+		{
+			LOG_WARNING("bar_generator price step invalid, poc use last price : ", tick.id.get_id());
+			_is_step_warned = true;
+		}
 	}
 	else 
 	{
@@ -62,48 +64,76 @@ void bar_generator::insert_tick(const tick_info& tick)
 		_bar.low = std::min(_bar.low, tick.price);
 		_bar.close = tick.price;
 		_bar.volume += delta_volume;
-		_poc_data[tick.price] += delta_volume;
-	}
-
-	if(_poc_data[tick.price]> _poc_data[_bar.poc])
-	{
-		_bar.poc = tick.price;
 	}
+	uint32_t buy_volume = 0;
+	uint32_t sell_volume = 0;
 	if(tick.price == tick.buy_price())
 	{
 		//主动卖出
-		_bar.price_sell_volume[tick.price] += delta_volume;
+		sell_volume = delta_volume;
 		_bar.delta -= delta_volume;
 	}
 	if (tick.price == tick.sell_price())
 	{
 		//主动买出
-		_bar.price_buy_volume[tick.price] += delta_volume;
+		buy_volume = delta_volume;
 		_bar.delta += delta_volume;
 	}
+	_bar.add_ladder_volume(tick.price, delta_volume, buy_volume, sell_volume);
 
 	_prev_volume = tick.volume;
 }
 
-void bar_generator::add_receiver(bar_receiver * receiver)
+void bar_generator::compose(uint32_t current_minute)
 {
-	auto it = _bar_callback.find(receiver);
-	if (it == _bar_callback.end())
+	for (auto& it : _period_bar)
 	{
-		_bar_callback.insert(receiver);
+		auto& node = it.second;
+		if (it.first == 1)
+		{
+			for (auto rcv : node.receiver)
+			{
+				rcv->on_bar(_bar);
+			}
+			continue;
+		}
+		if (node.bar.open == .0)
+		{
+			node.minute = _minute;
+		}
+		node.bar.merge(_bar);
+		node.bar.period = it.first;
+		if (current_minute - node.minute >= it.first)
+		{
+			for (auto rcv : node.receiver)
+			{
+				rcv->on_bar(node.bar);
+			}
+			node.bar.clear();
+		}
 	}
 }
 
-void bar_generator::remove_receiver(bar_receiver* receiver)
+void bar_generator::add_receiver(uint32_t period, bar_receiver * receiver)
 {
-	auto it = _bar_callback.find(receiver);
-	if(it != _bar_callback.end())
+	_period_bar[period].receiver.insert(receiver);
+}
+
+void bar_generator::remove_receiver(uint32_t period, bar_receiver* receiver)
+{
+	auto it = _period_bar.find(period);
+	if (it == _period_bar.end())
 	{
-		_bar_callback.erase(receiver);
+		return;
+	}
+	it->second.receiver.erase(receiver);
+	if (it->second.receiver.empty())
+	{
+		_period_bar.erase(it);
 	}
 }
 
 bool bar_generator::invalid()const
 {
-	return _bar_callback.empty();
-}
\ No newline at end of file
+	return _period_bar.empty();
+}
@@ -30,14 +30,26 @@ namespace lt::hft
 	/***
 	*
 	* bar 生成器
+	* 每个合约一个，tick只合成1分钟bar，其他周期在1分钟bar完成时由1分钟bar合并而来
+	* 所以每个tick的开销和订阅了多少个周期无关
 	*/
 	class bar_generator
 	{
+		struct period_bar
+		{
+			lt::bar_info bar;
 
-	private:
+			//bar开始的分钟
+			uint32_t minute;
+
+			std::set<lt::hft::bar_receiver*> receiver;
 
-		uint32_t _period;
+			period_bar() :minute(0) {}
+		};
+
+	private:
 
+		//1分钟bar
 		lt::bar_info _bar;
 
 		uint32_t _minute;
@@ -46,21 +58,28 @@ namespace lt::hft
 
 		double_t _price_step;
 
-		std::map<double_t, uint32_t> _poc_data;
+		//最小变动价位无效时只提示一次
+		bool _is_step_warned;
 
-		std::set<lt::hft::bar_receiver*> _bar_callback;
+		//按周期订阅
+		std::map<uint32_t, period_bar> _period_bar;
 
 	public:
 
-		bar_generator(uint32_t period, double_t price_step) :_period(period), _price_step(price_step), _minute(0), _prev_volume(0) {}
+		bar_generator(double_t price_step) :_minute(0), _prev_volume(0), _price_step(price_step), _is_step_warned(false) {}
 
 		void insert_tick(const tick_info& tick);
 
-		void add_receiver(lt::hft::bar_receiver* receiver);
+		void add_receiver(uint32_t period, lt::hft::bar_receiver* receiver);
 
-		void remove_receiver(lt::hft::bar_receiver* receiver);
+		void remove_receiver(uint32_t period, lt::hft::bar_receiver* receiver);
 
 		bool invalid()const;
+
+	private:
+
+		//1分钟bar完成，合成各个周期
+		void compose(uint32_t current_minute);
 	};
 
 }
@@ -0,0 +1,270 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "cancel_scheduler.h"
+#include <log_wapper.hpp>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+using namespace lt;
+using namespace lt::hft;
+
+namespace
+{
+	//最低位1的位置，bits不为0
+	inline uint32_t lowest_bit(uint64_t bits)
+	{
+#ifdef _MSC_VER
+		unsigned long index = 0;
+		_BitScanForward64(&index, bits);
+		return static_cast<uint32_t>(index);
+#else
+		return static_cast<uint32_t>(__builtin_ctzll(bits));
+#endif
+	}
+}
+
+timing_wheel::timing_wheel() :_level0_mask{}, _current(0), _size(0)
+{
+}
+
+void timing_wheel::schedule(estid_t estid, daytm_t due)
+{
+	_size++;
+	if (due <= _current)
+	{
+		_expired.push_back({ estid, due });
+		return;
+	}
+	place({ estid, due }, _current);
+}
+
+void timing_wheel::advance(daytm_t now, const std::function<void(estid_t, daytm_t)>& callback)
+{
+	if (!_expired.empty())
+	{
+		std::vector<timer_entry> expired;
+		expired.swap(_expired);
+		_size -= expired.size();
+		for (const auto& it : expired)
+		{
+			callback(it.estid, it.due);
+		}
+	}
+	while (_current < now)
+	{
+		if (_size == _expired.size())
+		{
+			//没有等待中的条目，直接跳到now
+			_current = now;
+			break;
+		}
+		const daytm_t next = _current + 1;
+		if ((next & SLOT_MASK) == 0)
+		{
+			cascade(next);
+		}
+		const uint32_t slot = next_slot(next & SLOT_MASK);
+		const daytm_t block_end = next | SLOT_MASK;
+		if (slot == SLOT_COUNT)
+		{
+			//本块剩下的槽位都是空的
+			_current = std::min(now, block_end);
+			continue;
+		}
+		const daytm_t due = (next & ~SLOT_MASK) | slot;
+		if (due > now)
+		{
+			_current = now;
+			break;
+		}
+		_current = due;
+		fire_slot(slot, callback);
+	}
+}
+
+void timing_wheel::reset(daytm_t now)
+{
+	for (auto& level : _slots)
+	{
+		for (auto& slot : level)
+		{
+			slot.clear();
+		}
+	}
+	_level0_mask.fill(0);
+	_expired.clear();
+	_current = now;
+	_size = 0;
+}
+
+void timing_wheel::place(const timer_entry& entry, daytm_t reference)
+{
+	const daytm_t diff = entry.due ^ reference;
+	size_t level = 0;
+	while (level + 1 < LEVEL_COUNT && (diff >> (LEVEL_BITS * (level + 1))) != 0)
+	{
+		level++;
+	}
+	const uint32_t slot = (entry.due >> (LEVEL_BITS * level)) & SLOT_MASK;
+	_slots[level][slot].push_back(entry);
+	if (level == 0)
+	{
+		_level0_mask[slot / 64U] |= (1ULL << (slot % 64U));
+	}
+}
+
+void timing_wheel::cascade(daytm_t boundary)
+{
+	//从低位全是0的最高一层开始往下分配
+	size_t top = 1;
+	while (top + 1 < LEVEL_COUNT && (boundary & ((1U << (LEVEL_BITS * (top + 1))) - 1U)) == 0)
+	{
+		top++;
+	}
+	for (size_t level = top; level > 0; level--)
+	{
+		const uint32_t slot = (boundary >> (LEVEL_BITS * level)) & SLOT_MASK;
+		if (_slots[level][slot].empty())
+		{
+			continue;
+		}
+		std::vector<timer_entry> entries;
+		entries.swap(_slots[level][slot]);
+		for (const auto& it : entries)
+		{
+			place(it, boundary);
+		}
+	}
+}
+
+uint32_t timing_wheel::next_slot(uint32_t from)const
+{
+	for (uint32_t word = from / 64U; word < _level0_mask.size(); word++)
+	{
+		uint64_t bits = _level0_mask[word];
+		if (word == from / 64U)
+		{
+			bits &= (~0ULL << (from % 64U));
+		}
+		if (bits != 0)
+		{
+			return word * 64U + lowest_bit(bits);
+		}
+	}
+	return SLOT_COUNT;
+}
+
+void timing_wheel::fire_slot(uint32_t slot, const std::function<void(estid_t, daytm_t)>& callback)
+{
+	std::vector<timer_entry> entries;
+	entries.swap(_slots[0][slot]);
+	_level0_mask[slot / 64U] &= ~(1ULL << (slot % 64U));
+	_size -= entries.size();
+	for (const auto& it : entries)
+	{
+		callback(it.estid, it.due);
+	}
+}
+
+void cancel_scheduler::cancel_at(estid_t estid, daytm_t time)
+{
+	//超过time才触发，和 time < get_last_time() 的判断一致
+	const daytm_t due = time + 1;
+	_timer_index[estid] = due;
+	_wheel.schedule(estid, due);
+}
+
+void cancel_scheduler::cancel_if_price_moves(estid_t estid, const code_t& code, double_t price, double_t distance)
+{
+	_price_condition[code].push_back({ estid, price, distance });
+	_price_index.insert(estid);
+}
+
+void cancel_scheduler::remove(estid_t estid)
+{
+	_timer_index.erase(estid);
+	_price_index.erase(estid);
+}
+
+void cancel_scheduler::clear()
+{
+	_wheel.reset(0);
+	_timer_index.clear();
+	_price_condition.clear();
+	_price_index.clear();
+}
+
+void cancel_scheduler::advance(daytm_t now, const std::function<void(estid_t)>& callback)
+{
+	if (_timer_index.empty() && !_wheel.empty())
+	{
+		//剩下的都是已经移除的条目
+		_wheel.reset(now);
+	}
+	_wheel.advance(now, [this, &callback](estid_t estid, daytm_t due) {
+		auto it = _timer_index.find(estid);
+		if (it == _timer_index.end() || it->second != due)
+		{
+			return;
+		}
+		_timer_index.erase(it);
+		callback(estid);
+		});
+}
+
+void cancel_scheduler::check_price(const code_t& code, double_t last_price, const std::function<void(estid_t)>& callback)
+{
+	auto it = _price_condition.find(code);
+	if (it == _price_condition.end())
+	{
+		return;
+	}
+	std::vector<estid_t> triggered;
+	auto& conditions = it->second;
+	size_t keep = 0;
+	for (size_t i = 0; i < conditions.size(); i++)
+	{
+		const price_condition& condition = conditions[i];
+		if (_price_index.find(condition.estid) == _price_index.end())
+		{
+			continue;
+		}
+		if (std::fabs(last_price - condition.price) > condition.distance)
+		{
+			_price_index.erase(condition.estid);
+			triggered.emplace_back(condition.estid);
+			continue;
+		}
+		conditions[keep++] = condition;
+	}
+	conditions.resize(keep);
+	if (conditions.empty())
+	{
+		_price_condition.erase(it);
+	}
+	for (auto estid : triggered)
+	{
+		callback(estid);
+	}
+}
@@ -0,0 +1,162 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include <define.h>
+#include <define_types.hpp>
+#include <array>
+
+namespace lt::hft
+{
+	/*
+	*	分层时间轮，按行情时间（毫秒）触发
+	*	4层每层256个槽位，覆盖整个daytm_t范围；条目按到期时间和当前时间最高不同的字节放在对应层，
+	*	时间走到256毫秒的整数倍时把上层对应槽位的条目往下层分配，第0层的槽位到期直接触发
+	*	推进时用第0层的占用位图跳过空槽位，每次只处理到期的条目
+	*/
+	class timing_wheel
+	{
+		static constexpr uint32_t LEVEL_BITS = 8U;
+
+		static constexpr uint32_t SLOT_COUNT = 1U << LEVEL_BITS;
+
+		static constexpr uint32_t SLOT_MASK = SLOT_COUNT - 1U;
+
+		static constexpr size_t LEVEL_COUNT = 4U;
+
+		struct timer_entry
+		{
+			estid_t estid;
+
+			daytm_t due;
+		};
+
+		std::array<std::array<std::vector<timer_entry>, SLOT_COUNT>, LEVEL_COUNT> _slots;
+
+		//第0层槽位是否有条目
+		std::array<uint64_t, SLOT_COUNT / 64U> _level0_mask;
+
+		//加入时已经到期的条目，下一次推进时触发
+		std::vector<timer_entry> _expired;
+
+		//这个时间以及之前的条目都已经触发
+		daytm_t _current;
+
+		size_t _size;
+
+	public:
+
+		timing_wheel();
+
+		bool empty()const
+		{
+			return _size == 0;
+		}
+
+		void schedule(estid_t estid, daytm_t due);
+
+		/*
+		*	推进到now，到期的条目按到期时间顺序回调(estid, due)
+		*/
+		void advance(daytm_t now, const std::function<void(estid_t, daytm_t)>& callback);
+
+		/*
+		*	清空所有条目，时间从now开始
+		*/
+		void reset(daytm_t now);
+
+	private:
+
+		void place(const timer_entry& entry, daytm_t reference);
+
+		void cascade(daytm_t boundary);
+
+		//第0层从from开始第一个有条目的槽位，没有返回SLOT_COUNT
+		uint32_t next_slot(uint32_t from)const;
+
+		void fire_slot(uint32_t slot, const std::function<void(estid_t, daytm_t)>& callback);
+	};
+
+	/*
+	*	撤单条件调度
+	*	定时撤单（cancel_at/cancel_after）放在时间轮里，价格偏离撤单按合约分组只在该合约来行情时检查；
+	*	订单结束或者移除条件时只删除索引，时间轮和价格表里剩下的条目在触发时跳过
+	*	只在实时线程访问（分片线程通过context加锁访问）
+	*/
+	class cancel_scheduler
+	{
+		struct price_condition
+		{
+			estid_t estid;
+
+			double_t price;
+
+			double_t distance;
+		};
+
+		timing_wheel _wheel;
+
+		//有效的定时撤单和到期时间
+		std::map<estid_t, daytm_t> _timer_index;
+
+		std::map<code_t, std::vector<price_condition>> _price_condition;
+
+		//有效的价格偏离撤单
+		std::set<estid_t> _price_index;
+
+	public:
+
+		/*
+		*	行情时间超过time以后撤单
+		*/
+		void cancel_at(estid_t estid, daytm_t time);
+
+		/*
+		*	最新价和price的差超过distance时撤单
+		*/
+		void cancel_if_price_moves(estid_t estid, const code_t& code, double_t price, double_t distance);
+
+		void remove(estid_t estid);
+
+		void clear();
+
+		bool has_timer()const
+		{
+			return !_timer_index.empty() || !_wheel.empty();
+		}
+
+		bool has_price_condition()const
+		{
+			return !_price_index.empty();
+		}
+
+		/*
+		*	时间推进到now，到期的订单交给callback撤单
+		*/
+		void advance(daytm_t now, const std::function<void(estid_t)>& callback);
+
+		/*
+		*	合约来行情时检查价格偏离，满足条件的订单交给callback撤单
+		*/
+		void check_price(const code_t& code, double_t last_price, const std::function<void(estid_t)>& callback);
+	};
+}
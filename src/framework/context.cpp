@@ -27,15 +27,51 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include <params.hpp>
 #include <time_utils.hpp>
 #include <process_helper.hpp>
+#include <binary_stream.hpp>
 #include "trading_section.h"
-#include "price_step.h"
+#include "flow_control.h"
+#include "risk_check.h"
+#include "cancel_scheduler.h"
+#include "strategy_ledger.h"
+#include <instrument_table.hpp>
 
 using namespace lt;
 using namespace lt::hft ;
 
+//当前线程是否为策略分片线程
+static thread_local bool is_worker_thread = false;
+
+//分片线程上设置的撤单条件，条件里通常会读策略状态，只在设置它的分片线程上检查
+static thread_local std::map<estid_t, std::function<bool(estid_t)>> worker_condition;
+
+//分片线程访问上下文状态时加锁，实时线程在update中已经持有锁
+class worker_guard
+{
+	spin_mutex* _mutex;
+
+public:
+
+	worker_guard(spin_mutex& mutex) :_mutex(is_worker_thread ? &mutex : nullptr)
+	{
+		if (_mutex)
+		{
+			_mutex->lock();
+		}
+	}
+
+	~worker_guard()
+	{
+		if (_mutex)
+		{
+			_mutex->unlock();
+		}
+	}
+};
+
 context::context(lifecycle_listener* lifecycle):
 	_market(nullptr),
 	_trader(nullptr),
+	_standby_trader(nullptr),
 	_is_runing(false),
 	_realtime_thread(nullptr),
 	_tick_callback(nullptr),
@@ -44,7 +80,11 @@ context::context(lifecycle_listener* lifecycle):
 	_loop_interval(1),
 	_last_tick_time(0),
 	_thread_priority(0),
-	_lifecycle_listener(lifecycle)
+	_shard_count(0),
+	_snapshot_dirty(true),
+	_lifecycle_listener(lifecycle),
+	_cancel_scheduler(std::make_shared<cancel_scheduler>()),
+	_strategy_ledger(std::make_shared<strategy_ledger>())
 {
 }
 context::~context()
@@ -58,10 +98,45 @@ void context::init(const params& control_config, const params& include_config, m
 	_bind_cpu_core = control_config.get<int16_t>("bind_cpu_core");
 	_loop_interval = control_config.get<uint32_t>("loop_interval");
 	_thread_priority = control_config.get<int16_t>("thread_priority");
+	try
+	{
+		_shard_count = control_config.get<uint32_t>("shard_count");
+	}
+	catch (...)
+	{
+		_shard_count = 0;
+	}
 	const auto& ps_config = include_config.get<std::string>("price_step");
-	_ps_config = std::make_shared<price_step>(ps_config);
+	std::string contract_config, instrument_cache;
+	try
+	{
+		contract_config = include_config.get<std::string>("contract_config");
+	}
+	catch (...)
+	{
+	}
+	try
+	{
+		instrument_cache = include_config.get<std::string>("instrument_cache");
+	}
+	catch (...)
+	{
+	}
+	_instrument_table = std::make_shared<instrument_table>();
+	_instrument_table->init(ps_config, contract_config, instrument_cache);
 	auto section_config = include_config.get<std::string>("section_config");
 	_section_config = std::make_shared<trading_section>(section_config);
+	_flow_control = std::make_shared<flow_control>(control_config);
+	_risk_control = std::make_shared<risk_control>();
+	_risk_control->init(control_config);
+	try
+	{
+		//没有归属的持仓（比如重启前的持仓没有账本）交给这个策略
+		_strategy_ledger->set_default_owner(control_config.get<uint32_t>("ledger_owner"));
+	}
+	catch (...)
+	{
+	}
 	int16_t process_priority = control_config.get<int16_t>("process_priority");
 	if(static_cast<int16_t>(PriorityLevel::LowPriority) <= process_priority && process_priority <= static_cast<int16_t>(PriorityLevel::RealtimePriority))
 	{
@@ -89,6 +164,7 @@ bool context::load_data()
 	}
 	_position_info.clear();
 	_order_info.clear();
+	_snapshot_dirty = true;
 	for (const auto& it : trader_data->orders)
 	{
 		auto& pos = _position_info[it.code];
@@ -139,6 +215,8 @@ bool context::load_data()
 		pos.history_long.postion = it.history_long;
 		pos.history_short.postion = it.history_short;
 	}
+	//策略账本按柜台持仓重新分配，没有结束的订单重新记账
+	_strategy_ledger->reconcile(_position_info, trader_data->orders);
 	return true;
 }
 
@@ -156,15 +234,12 @@ bool context::start_service()
 	_is_runing = true;
 	if(_trader)
 	{
-		_trader->bind_event(trader_event_type::TET_OrderCancel, std::bind(&context::handle_cancel, this, std::placeholders::_1));
-		_trader->bind_event(trader_event_type::TET_OrderPlace, std::bind(&context::handle_entrust, this, std::placeholders::_1));
-		_trader->bind_event(trader_event_type::TET_OrderDeal, std::bind(&context::handle_deal, this, std::placeholders::_1));
-		_trader->bind_event(trader_event_type::TET_OrderTrade, std::bind(&context::handle_trade, this, std::placeholders::_1));
-		_trader->bind_event(trader_event_type::TET_OrderError, std::bind(&context::handle_error, this, std::placeholders::_1));
+		bind_trader_event();
 	}
 	if(_market)
 	{
 		_market->bind_event(market_event_type::MET_TickReceived, std::bind(&context::handle_tick, this, std::placeholders::_1));
+		_market->bind_event(market_event_type::MET_TickFrame, std::bind(&context::handle_tick_frame, this, std::placeholders::_1));
 	}
 	
 	_realtime_thread = new std::thread([this]()->void{
@@ -189,6 +264,11 @@ bool context::start_service()
 		{
 			_lifecycle_listener->on_init();
 		}
+		{
+			//策略都登记了账本以后再分配没有归属的持仓
+			std::lock_guard<spin_mutex> lock(_mutex);
+			_strategy_ledger->assign_unattributed();
+		}
 		while (_is_runing/* || !_trader->is_idle()*/)
 		{
 			auto begin = std::chrono::system_clock::now();
@@ -210,6 +290,9 @@ bool context::start_service()
 
 void context::update()
 {
+	std::lock_guard<spin_mutex> lock(_mutex);
+	check_failover();
+	handle_request();
 	if (_market)
 	{
 		_market->update();
@@ -220,12 +303,24 @@ void context::update()
 		{
 			_trader->update();
 		}
+		if (_flow_control && _flow_control->deferred_size() > 0)
+		{
+			process_deferred_cancel();
+		}
+		if (_flow_control && _flow_control->deferred_place_size() > 0)
+		{
+			process_deferred_place();
+		}
 		if (_lifecycle_listener)
 		{
 			_lifecycle_listener->on_update();
 		}
 		this->check_condition();
 	}
+	if (_snapshot_dirty)
+	{
+		publish_snapshot();
+	}
 }
 
 bool context::stop_service()
@@ -245,13 +340,67 @@ bool context::stop_service()
 	{
 		_trader->clear_event();
 	}
+	if (_standby_trader)
+	{
+		_standby_trader->clear_event();
+	}
 	if(_market)
 	{
 		_market->clear_event();
 	}
+	if (_risk_control && _risk_control->is_enabled())
+	{
+		_risk_control->print_statistic();
+	}
 	return true ;
 }
 
+void context::set_standby_trader(actual_trader* standby)
+{
+	if (_trader == nullptr || standby == nullptr)
+	{
+		LOG_ERROR("context set_standby_trader trader null");
+		return;
+	}
+	if (!standby->set_standby(static_cast<actual_trader*>(_trader)))
+	{
+		LOG_ERROR("context set_standby_trader standby not supported");
+		return;
+	}
+	_standby_trader = standby;
+}
+
+void context::bind_trader_event()
+{
+	_trader->bind_event(trader_event_type::TET_OrderCancel, std::bind(&context::handle_cancel, this, std::placeholders::_1));
+	_trader->bind_event(trader_event_type::TET_OrderPlace, std::bind(&context::handle_entrust, this, std::placeholders::_1));
+	_trader->bind_event(trader_event_type::TET_OrderDeal, std::bind(&context::handle_deal, this, std::placeholders::_1));
+	_trader->bind_event(trader_event_type::TET_OrderTrade, std::bind(&context::handle_trade, this, std::placeholders::_1));
+	_trader->bind_event(trader_event_type::TET_OrderError, std::bind(&context::handle_error, this, std::placeholders::_1));
+}
+
+void context::check_failover()
+{
+	if (_standby_trader == nullptr || _trader == nullptr || _trader->is_usable() || !_standby_trader->is_usable())
+	{
+		return;
+	}
+	actual_trader* failed = static_cast<actual_trader*>(_trader);
+	//断线前已经收到的回报先处理完
+	failed->update();
+	failed->clear_event();
+	//热备会话按订单镜像补发断线前后主会话没有送到的回报，绑定以后在本次update里处理
+	_standby_trader->take_over(_order_info, [this](estid_t estid)->bool {
+		return _order_listener.find(estid) != _order_listener.end();
+	});
+	_trader = _standby_trader;
+	bind_trader_event();
+	//断线的会话重连以后作为新的热备
+	failed->set_standby(_standby_trader);
+	_standby_trader = failed;
+	LOG_WARNING("context trader failover to standby session");
+}
+
 
 order_statistic context::get_all_statistic()const
 {
@@ -267,15 +416,58 @@ order_statistic context::get_all_statistic()const
 	return all_statistic;
 }
 
+uint64_t context::read_snapshot(context_snapshot& result)const
+{
+	return _snapshot.read(result);
+}
+
 void context::set_cancel_condition(estid_t estid, std::function<bool(estid_t)> callback)
 {
 	if (estid != INVALID_ESTID)
 	{
 		LOG_DEBUG("set_cancel_condition : ", estid);
+		if (is_worker_thread)
+		{
+			worker_condition[estid] = callback;
+			return;
+		}
 		_need_check_condition[estid] = callback;
 	}
 }
 
+void context::set_cancel_at(estid_t estid, daytm_t time)
+{
+	if (estid != INVALID_ESTID)
+	{
+		worker_guard guard(_mutex);
+		_cancel_scheduler->cancel_at(estid, time);
+	}
+}
+
+void context::set_cancel_after(estid_t estid, uint32_t milliseconds)
+{
+	if (estid != INVALID_ESTID)
+	{
+		worker_guard guard(_mutex);
+		_cancel_scheduler->cancel_at(estid, _last_tick_time + milliseconds);
+	}
+}
+
+void context::set_cancel_if_price_moves(estid_t estid, double_t distance)
+{
+	if (estid != INVALID_ESTID)
+	{
+		worker_guard guard(_mutex);
+		auto it = _order_info.find(estid);
+		if (it == _order_info.end())
+		{
+			LOG_WARNING("set_cancel_if_price_moves order not found : ", estid);
+			return;
+		}
+		_cancel_scheduler->cancel_if_price_moves(estid, it->second.code, it->second.price, distance);
+	}
+}
+
 const tick_info& context::get_previous_tick(const code_t& code)
 {
 	const auto it = _previous_tick.find(code);
@@ -288,6 +480,24 @@ const tick_info& context::get_previous_tick(const code_t& code)
 
 estid_t context::place_order(order_listener* listener, offset_type offset, direction_type direction, const code_t& code, uint32_t count, double_t price, order_flag flag)
 {
+	if (is_worker_thread)
+	{
+		//交给实时线程执行，等待结果
+		order_request request;
+		request.listener = listener;
+		request.offset = offset;
+		request.direction = direction;
+		request.code = code;
+		request.count = count;
+		request.price = price;
+		request.flag = flag;
+		_order_request.push(&request);
+		while (!request.finished.load(std::memory_order_acquire))
+		{
+			std::this_thread::yield();
+		}
+		return request.estid;
+	}
 	LOG_INFO("context place order : ", code.get_id(), offset, direction, price, count);
 	PROFILE_DEBUG(code.get_id());
 	if (!this->_trader)
@@ -295,7 +505,7 @@ estid_t context::place_order(order_listener* listener, offset_type offset, direc
 		LOG_ERROR("place order this->_trader null");
 		return false;
 	}
-	if (!is_in_trading())
+	if (!is_in_trading(code))
 	{
 		LOG_WARNING("place order code not in trading", code.get_id());
 		return INVALID_ESTID;
@@ -309,12 +519,45 @@ estid_t context::place_order(order_listener* listener, offset_type offset, direc
 			return INVALID_ESTID;
 		}
 	}
+	if (_risk_control && _risk_control->is_enabled())
+	{
+		const auto position_it = _position_info.find(code);
+		const auto market_it = _market_info.find(code);
+		const risk_state state{
+			position_it != _position_info.end() ? &position_it->second : nullptr,
+			market_it != _market_info.end() ? &market_it->second : nullptr,
+			market_it != _market_info.end() ? market_it->second.instrument : get_instrument(code),
+			_order_info
+		};
+		if (!_risk_control->check({ code, offset, direction, count, price, flag }, state))
+		{
+			return INVALID_ESTID;
+		}
+	}
+	//账本行号同时是流控的策略下标
+	const uint32_t ledger_row = _strategy_ledger->get_row(listener);
+	instrument_index instrument = INVALID_INSTRUMENT_INDEX;
+	if (_flow_control && _flow_control->is_enabled())
+	{
+		instrument = _instrument_table ? _instrument_table->get_index(code) : INVALID_INSTRUMENT_INDEX;
+		if (!_flow_control->can_place(instrument, ledger_row, offset, _statistic_info[code], _last_tick_time))
+		{
+			_flow_control->defer_place(listener, code, instrument, ledger_row, offset);
+			return INVALID_ESTID;
+		}
+	}
 
 	estid_t estid = this->_trader->place_order(offset, direction, code, count, price, flag);
 	if (estid != INVALID_ESTID)
 	{
-		_order_listener[estid] = listener;
+		_order_listener[estid] = get_listener_proxy(listener);
+		_strategy_ledger->bind_order(estid, ledger_row);
+		if (_flow_control && _flow_control->is_enabled())
+		{
+			_flow_control->commit_place(instrument, ledger_row);
+		}
 		_statistic_info[code].place_order_amount++;
+		_snapshot_dirty = true;
 	}
 	PROFILE_DEBUG(code.get_id());
 	return estid ;
@@ -322,6 +565,18 @@ estid_t context::place_order(order_listener* listener, offset_type offset, direc
 
 bool context::cancel_order(estid_t estid)
 {
+	if (is_worker_thread)
+	{
+		order_request request;
+		request.is_cancel = true;
+		request.estid = estid;
+		_order_request.push(&request);
+		while (!request.finished.load(std::memory_order_acquire))
+		{
+			std::this_thread::yield();
+		}
+		return request.result;
+	}
 
 	if(estid == INVALID_ESTID)
 	{
@@ -337,12 +592,33 @@ bool context::cancel_order(estid_t estid)
 		LOG_WARNING("cancel order not in trading ", estid);
 		return false;
 	}
+	if (_flow_control && _flow_control->is_enabled() && !_flow_control->try_cancel(_last_tick_time))
+	{
+		auto it = _order_info.find(estid);
+		if (it == _order_info.end())
+		{
+			return false;
+		}
+		//超过撤单频率，放进延迟队列在后面的update里补发
+		_flow_control->defer_cancel(estid, it->second.create_time);
+		return true;
+	}
 	LOG_INFO("context cancel_order : ", estid);
 	return this->_trader->cancel_order(estid);
 }
 
 const position_info& context::get_position(const code_t& code)const
 {
+	if (is_worker_thread)
+	{
+		//分片线程返回线程内副本，引用在下一次获取同一合约之前有效
+		static thread_local std::map<code_t, position_info> worker_position;
+		std::lock_guard<spin_mutex> lock(_mutex);
+		const auto& it = _position_info.find(code);
+		auto& result = worker_position[code];
+		result = (it != _position_info.end()) ? it->second : default_position;
+		return result;
+	}
 	const auto& it = _position_info.find(code);
 	if (it != _position_info.end())
 	{
@@ -351,8 +627,55 @@ const position_info& context::get_position(const code_t& code)const
 	return default_position;
 }
 
+uint32_t context::regist_strategy_ledger(const order_listener* listener, uint32_t straid)
+{
+	worker_guard guard(_mutex);
+	return _strategy_ledger->regist_owner(listener, straid);
+}
+
+uint32_t context::get_ledger_column(const code_t& code)
+{
+	worker_guard guard(_mutex);
+	return _strategy_ledger->get_column(code);
+}
+
+const position_info& context::get_strategy_position(uint32_t ledger_row, uint32_t ledger_column)const
+{
+	if (is_worker_thread)
+	{
+		//分片线程返回线程内副本，引用在下一次获取同一策略同一合约之前有效
+		static thread_local std::map<uint64_t, position_info> worker_position;
+		std::lock_guard<spin_mutex> lock(_mutex);
+		auto& result = worker_position[(static_cast<uint64_t>(ledger_row) << 32) | ledger_column];
+		result = _strategy_ledger->get_position(ledger_row, ledger_column);
+		return result;
+	}
+	return _strategy_ledger->get_position(ledger_row, ledger_column);
+}
+
+void context::save_ledger(std::vector<uint8_t>& data)const
+{
+	worker_guard guard(_mutex);
+	_strategy_ledger->save(data);
+}
+
+bool context::load_ledger(const std::vector<uint8_t>& data)
+{
+	worker_guard guard(_mutex);
+	return _strategy_ledger->load(data);
+}
+
 const order_info& context::get_order(estid_t estid)const
 {
+	if (is_worker_thread)
+	{
+		//分片线程返回线程内副本，引用在下一次调用之前有效
+		static thread_local order_info worker_order;
+		std::lock_guard<spin_mutex> lock(_mutex);
+		auto it = _order_info.find(estid);
+		worker_order = (it != _order_info.end()) ? it->second : default_order;
+		return worker_order;
+	}
 	auto it = _order_info.find(estid);
 	if (it != _order_info.end())
 	{
@@ -363,6 +686,7 @@ const order_info& context::get_order(estid_t estid)const
 
 void context::find_orders(std::vector<order_info>& order_result, std::function<bool(const order_info&)> func) const
 {
+	worker_guard guard(_mutex);
 	for (auto& it : _order_info)
 	{
 		if (func(it.second))
@@ -374,6 +698,7 @@ void context::find_orders(std::vector<order_info>& order_result, std::function<b
 
 uint32_t context::get_total_position() const
 {
+	worker_guard guard(_mutex);
 	uint32_t total = 0;
 	for (const auto& it : _position_info)
 	{
@@ -381,7 +706,7 @@ uint32_t context::get_total_position() const
 	}
 	return total;
 }
-void context::subscribe(const std::set<code_t>& tick_data, std::function<void(const tick_info&)> tick_callback)
+void context::subscribe(const std::set<code_t>& tick_data, std::function<void(const tick_info&, const tick_info&)> tick_callback)
 {
 	this->_tick_callback = tick_callback;
 	if(this->_market)
@@ -400,16 +725,27 @@ void context::unsubscribe(const std::set<code_t>& tick_data)
 
 daytm_t context::get_last_time()
 {
+	worker_guard guard(_mutex);
 	return _last_tick_time;
 }
 
 daytm_t context::last_order_time()
 {
+	worker_guard guard(_mutex);
 	return _last_order_time;
 }
 
 const order_statistic& context::get_order_statistic(const code_t& code)const
 {
+	if (is_worker_thread)
+	{
+		static thread_local std::map<code_t, order_statistic> worker_statistic;
+		std::lock_guard<spin_mutex> lock(_mutex);
+		auto it = _statistic_info.find(code);
+		auto& result = worker_statistic[code];
+		result = (it != _statistic_info.end()) ? it->second : default_statistic;
+		return result;
+	}
 	auto it = _statistic_info.find(code);
 	if(it != _statistic_info.end())
 	{
@@ -421,6 +757,7 @@ const order_statistic& context::get_order_statistic(const code_t& code)const
 
 uint32_t context::get_trading_day()const
 {
+	worker_guard guard(_mutex);
 	if(!this->_trader)
 	{
 		return -0U;
@@ -448,10 +785,29 @@ bool context::is_in_trading()const
 	return _section_config->is_in_trading(_last_tick_time);
 }
 
+bool context::is_in_trading(const code_t& code)const
+{
+	if (_section_config == nullptr)
+	{
+		LOG_FATAL("section config not init");
+		return false;
+	}
+	return _section_config->is_in_trading(code, _last_tick_time);
+}
+
 
 
 const market_info& context::get_market_info(const code_t& id)const
 {
+	if (is_worker_thread)
+	{
+		static thread_local std::map<code_t, market_info> worker_market;
+		std::lock_guard<spin_mutex> lock(_mutex);
+		auto it = _market_info.find(id);
+		auto& result = worker_market[id];
+		result = (it != _market_info.end()) ? it->second : default_market;
+		return result;
+	}
 	auto it = _market_info.find(id);
 	if (it == _market_info.end())
 	{
@@ -463,6 +819,7 @@ const market_info& context::get_market_info(const code_t& id)const
 
 uint32_t context::get_total_pending()
 {
+	worker_guard guard(_mutex);
 	uint32_t res = 0;
 	for (auto& it : _position_info)
 	{
@@ -476,14 +833,53 @@ void context::check_crossday()
 	_last_tick_time = 0U;
 	_market_info.clear();
 	_statistic_info.clear();
+	//订单当日有效，换日以后行情时间从头开始
+	_cancel_scheduler->clear();
+	if (_flow_control)
+	{
+		_flow_control->clear();
+	}
 	_last_order_time = get_last_time();
+	_snapshot_dirty = true;
 	LOG_INFO("trading ready");
 }
 
+void context::process_deferred_cancel()
+{
+	estid_t estid = INVALID_ESTID;
+	while (_flow_control->peek_deferred(estid))
+	{
+		if (_order_info.find(estid) == _order_info.end())
+		{
+			//订单已经结束
+			_flow_control->pop_deferred();
+			continue;
+		}
+		if (!_flow_control->try_cancel(_last_tick_time))
+		{
+			break;
+		}
+		_flow_control->pop_deferred();
+		LOG_INFO("context deferred cancel_order : ", estid);
+		_trader->cancel_order(estid);
+	}
+}
+
+void context::process_deferred_place()
+{
+	_flow_control->release_place(_last_tick_time, [this](const code_t& code)->const order_statistic& {
+		return _statistic_info[code];
+	}, [this](order_listener* listener, const code_t& code)->void {
+		LOG_INFO("context flow_control reopen : ", code.get_id());
+		get_listener_proxy(listener)->on_error(error_type::ET_PLACE_ORDER, INVALID_ESTID, error_code::EC_FlowControl);
+	});
+}
+
 void context::handle_entrust(const std::vector<std::any>& param)
 {
 	if (param.size() >= 1)
 	{
+		_snapshot_dirty = true;
 		order_info order = std::any_cast<order_info>(param[0]);
 		_order_info[order.estid] = (order);
 		if (order.offset == offset_type::OT_OPEN)
@@ -495,6 +891,7 @@ void context::handle_entrust(const std::vector<std::any>& param)
 			//平仓冻结仓位
 			frozen_deduction(order.code, order.direction, order.offset, order.total_volume);
 		}
+		_strategy_ledger->entrust(order);
 		auto it = _order_listener.find(order.estid);
 		if(it != _order_listener.end() && it->second)
 		{
@@ -510,6 +907,7 @@ void context::handle_deal(const std::vector<std::any>& param)
 {
 	if (param.size() >= 3)
 	{
+		_snapshot_dirty = true;
 		estid_t estid = std::any_cast<estid_t>(param[0]);
 		uint32_t deal_volume = std::any_cast<uint32_t>(param[1]);
 		uint32_t last_volume = std::any_cast<uint32_t>(param[2]);
@@ -517,6 +915,7 @@ void context::handle_deal(const std::vector<std::any>& param)
 		if (it != _order_info.end())
 		{
 			calculate_position(it->second.code, it->second.direction, it->second.offset, deal_volume, it->second.price);
+			_strategy_ledger->deal(it->second, deal_volume);
 			it->second.last_volume = last_volume;
 		}
 		auto listener_iter = _order_listener.find(estid);
@@ -531,6 +930,7 @@ void context::handle_trade(const std::vector<std::any>& param)
 {
 	if (param.size() >= 6)
 	{
+		_snapshot_dirty = true;
 
 		estid_t estid = std::any_cast<estid_t>(param[0]);
 		code_t code = std::any_cast<code_t>(param[1]);
@@ -549,11 +949,8 @@ void context::handle_trade(const std::vector<std::any>& param)
 			listener_iter->second->on_trade(estid, code, offset, direction, price, trade_volume);
 			_order_listener.erase(listener_iter);
 		}
-		auto odit = _need_check_condition.find(estid);
-		if (odit != _need_check_condition.end())
-		{
-			_need_check_condition.erase(odit);
-		}
+		_strategy_ledger->unbind_order(estid);
+		remove_condition(estid);
 		_statistic_info[code].trade_amount++;
 	}
 }
@@ -562,6 +959,7 @@ void context::handle_cancel(const std::vector<std::any>& param)
 {
 	if (param.size() >= 7)
 	{
+		_snapshot_dirty = true;
 		estid_t estid = std::any_cast<estid_t>(param[0]);
 		code_t code = std::any_cast<code_t>(param[1]);
 		offset_type offset = std::any_cast<offset_type>(param[2]);
@@ -581,6 +979,7 @@ void context::handle_cancel(const std::vector<std::any>& param)
 			{
 				unfreeze_deduction(code, direction, offset, cancel_volume);
 			}
+			_strategy_ledger->cancel(it->second, cancel_volume);
 			_order_info.erase(it);
 		}
 		auto listener_iter = _order_listener.find(estid);
@@ -589,11 +988,8 @@ void context::handle_cancel(const std::vector<std::any>& param)
 			listener_iter->second->on_cancel(estid, code, offset, direction, price, cancel_volume, total_volume);
 			_order_listener.erase(listener_iter);
 		}
-		auto odit = _need_check_condition.find(estid);
-		if (odit != _need_check_condition.end())
-		{
-			_need_check_condition.erase(odit);
-		}
+		_strategy_ledger->unbind_order(estid);
+		remove_condition(estid);
 		_statistic_info[code].cancel_amount++;
 	}
 }
@@ -604,45 +1000,81 @@ void context::handle_tick(const std::vector<std::any>& param)
 	if (param.size() >= 2)
 	{
 		PROFILE_DEBUG("pDepthMarketData->InstrumentID");
-		auto&& last_tick = std::any_cast<const tick_info>(param[0])
-		PROFILE_DEBUG(last_tick.id.get_id());
-		LOG_INFO("handle_tick", last_tick.id.get_id(), last_tick.time, " ", _last_tick_time);
-		if (last_tick.time > _last_tick_time)
+		const auto& last_tick = std::any_cast<const tick_info&>(param[0]);
+		const auto& extend_data = std::any_cast<const tick_extend&>(param[1]);
+		process_tick(last_tick, extend_data);
+	}
+}
+
+void context::handle_tick_frame(const std::vector<std::any>& param)
+{
+	if (param.size() >= 1)
+	{
+		const tick_frame* frame = std::any_cast<const tick_frame*>(param[0]);
+		for (const tick_detail* tick : *frame)
 		{
-			_last_tick_time = last_tick.time;
+			process_tick(*tick, tick->extend);
 		}
-		
-		auto it = _previous_tick.find(last_tick.id);
-		if(it != _previous_tick.end())
+	}
+}
+
+void context::process_tick(const tick_info& last_tick, const tick_extend& extend_data)
+{
+	PROFILE_DEBUG(last_tick.id.get_id());
+	LOG_INFO("handle_tick", last_tick.id.get_id(), last_tick.time, " ", _last_tick_time);
+	if (last_tick.time > _last_tick_time)
+	{
+		_last_tick_time = last_tick.time;
+	}
+	
+	auto it = _previous_tick.find(last_tick.id);
+	if(it != _previous_tick.end())
+	{
+		tick_info& prev_tick = it->second;
+		if (is_in_trading())
 		{
-			tick_info& prev_tick = it->second;
-			if (is_in_trading())
+			auto& current_market_info = _market_info[last_tick.id];
+			current_market_info.code = last_tick.id;
+			current_market_info.last_tick_info = last_tick;
+			current_market_info.open_price = std::get<TEI_OPEN_PRICE>(extend_data);
+			current_market_info.close_price = std::get<TEI_CLOSE_PRICE>(extend_data);
+			current_market_info.standard_price = std::get<TEI_STANDARD_PRICE>(extend_data);
+			current_market_info.high_price = std::get<TEI_HIGH_PRICE>(extend_data);
+			current_market_info.low_price = std::get<TEI_LOW_PRICE>(extend_data);
+			current_market_info.max_price = std::get<TEI_MAX_PRICE>(extend_data);
+			current_market_info.min_price = std::get<TEI_MIN_PRICE>(extend_data);
+			current_market_info.trading_day = last_tick.trading_day;
+			if (current_market_info.volume_distribution.invalid())
 			{
-				auto&& extend_data = std::any_cast<tick_extend>(param[1]);
-				auto& current_market_info = _market_info[last_tick.id];
-				current_market_info.code = last_tick.id;
-				current_market_info.last_tick_info = last_tick;
-				current_market_info.open_price = std::get<TEI_OPEN_PRICE>(extend_data);
-				current_market_info.close_price = std::get<TEI_CLOSE_PRICE>(extend_data);
-				current_market_info.standard_price = std::get<TEI_STANDARD_PRICE>(extend_data);
-				current_market_info.high_price = std::get<TEI_HIGH_PRICE>(extend_data);
-				current_market_info.low_price = std::get<TEI_LOW_PRICE>(extend_data);
-				current_market_info.max_price = std::get<TEI_MAX_PRICE>(extend_data);
-				current_market_info.min_price = std::get<TEI_MIN_PRICE>(extend_data);
-				current_market_info.trading_day = last_tick.trading_day;
-				current_market_info.volume_distribution[last_tick.price] += static_cast<uint32_t>(last_tick.volume - prev_tick.volume);
-				if (this->_tick_callback)
+				//每个合约每个交易日第一次收到行情时解析合约信息，之后按指针读取
+				const instrument_index index = get_instrument_index(last_tick.id);
+				current_market_info.instrument = index != INVALID_INSTRUMENT_INDEX ? &get_instrument(index) : nullptr;
+				const double_t price_step = get_instrument(index).price_step;
+				if (price_step <= .0)
 				{
-					PROFILE_DEBUG(last_tick.id.get_id());
-					this->_tick_callback(last_tick);
+					LOG_WARNING("volume profile price step invalid, poc use last price : ", last_tick.id.get_id());
 				}
+				const double_t origin = current_market_info.min_price > .0 ? current_market_info.min_price : last_tick.price;
+				current_market_info.volume_distribution.init(origin, current_market_info.max_price, price_step);
+			}
+			current_market_info.volume_distribution.add(last_tick.price, static_cast<uint32_t>(last_tick.volume - prev_tick.volume));
+			if (_cancel_scheduler->has_price_condition())
+			{
+				_cancel_scheduler->check_price(last_tick.id, last_tick.price, [this](estid_t estid) {
+					fire_cancel(estid);
+					});
+			}
+			if (this->_tick_callback)
+			{
+				PROFILE_DEBUG(last_tick.id.get_id());
+				this->_tick_callback(last_tick, prev_tick);
 			}
-			it->second = last_tick;
-		}
-		else
-		{
-			_previous_tick.insert(std::make_pair(last_tick.id, last_tick));
 		}
+		it->second = last_tick;
+	}
+	else
+	{
+		_previous_tick.insert(std::make_pair(last_tick.id, last_tick));
 	}
 }
 
@@ -650,6 +1082,7 @@ void context::handle_error(const std::vector<std::any>& param)
 {
 	if (param.size() >= 3)
 	{
+		_snapshot_dirty = true;
 		const error_type type = std::any_cast<error_type>(param[0]);
 		const estid_t estid = std::any_cast<estid_t>(param[1]);
 		const uint8_t error = std::any_cast<uint8_t>(param[2]);
@@ -674,11 +1107,8 @@ void context::handle_error(const std::vector<std::any>& param)
 		}
 		if (type == error_type::ET_PLACE_ORDER)
 		{
-			auto odit = _need_check_condition.find(estid);
-			if (odit != _need_check_condition.end())
-			{
-				_need_check_condition.erase(odit);
-			}
+			_strategy_ledger->unbind_order(estid);
+			remove_condition(estid);
 		}
 	}
 }
@@ -892,6 +1322,12 @@ void context::set_trading_filter(filter_function callback)
 
 void context::check_condition()
 {
+	if (_cancel_scheduler->has_timer())
+	{
+		_cancel_scheduler->advance(_last_tick_time, [this](estid_t estid) {
+			fire_cancel(estid);
+			});
+	}
 
 	for (auto it = _need_check_condition.begin(); it != _need_check_condition.end();)
 	{
@@ -915,29 +1351,251 @@ void context::check_condition()
 
 void context::remove_condition(estid_t estid)
 {
+	if (is_worker_thread)
+	{
+		worker_condition.erase(estid);
+	}
+	worker_guard guard(_mutex);
 	auto odit = _need_check_condition.find(estid);
 	if (odit != _need_check_condition.end())
 	{
 		_need_check_condition.erase(odit);
 	}
+	_cancel_scheduler->remove(estid);
+}
+
+void context::check_worker_condition()
+{
+	for (auto it = worker_condition.begin(); it != worker_condition.end();)
+	{
+		//撤单通过请求队列交给实时线程执行
+		if (it->second(it->first) && (this->get_order(it->first).invalid() || this->cancel_order(it->first)))
+		{
+			it = worker_condition.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
 }
 
 void context::clear_condition()
 {
+	if (_flow_control)
+	{
+		_flow_control->clear_deferred_place();
+	}
 	_need_check_condition.clear();
+	_cancel_scheduler->clear();
+}
+
+void context::fire_cancel(estid_t estid)
+{
+	if (get_order(estid).invalid())
+	{
+		return;
+	}
+	LOG_DEBUG("context fire_cancel : ", estid);
+	if (!cancel_order(estid))
+	{
+		_need_check_condition[estid] = [](estid_t estid)->bool {
+			return true;
+		};
+	}
 }
 
 double_t context::get_price_step(const code_t& code)const
 {
-	if (_ps_config)
+	if (_instrument_table)
 	{
-		return _ps_config->get_price_step(code);
+		return _instrument_table->get_price_step(code);
 	}
-	LOG_WARNING("_price_step_config null");
+	LOG_WARNING("_instrument_table null");
 	return .0;
 }
 
+const instrument_info* context::get_instrument(const code_t& code)const
+{
+	if (_instrument_table)
+	{
+		return _instrument_table->get_instrument(code);
+	}
+	return nullptr;
+}
+
+instrument_index context::get_instrument_index(const code_t& code)const
+{
+	instrument_index index = _instrument_table ? _instrument_table->get_index(code) : INVALID_INSTRUMENT_INDEX;
+	if (index == INVALID_INSTRUMENT_INDEX)
+	{
+		LOG_WARNING("context cant find instrument, price_step use 1 :", code.get_id());
+	}
+	return index;
+}
+
+const instrument_info& context::get_instrument(instrument_index index)const
+{
+	if (_instrument_table && index < _instrument_table->size())
+	{
+		return _instrument_table->get_instrument(index);
+	}
+	return default_instrument;
+}
+
 void context::regist_order_listener(estid_t estid, order_listener* listener)
 {
-	_order_listener[estid] = listener;
-}
\ No newline at end of file
+	worker_guard guard(_mutex);
+	_order_listener[estid] = get_listener_proxy(listener);
+	_strategy_ledger->bind_order(estid, listener);
+}
+
+void context::save_snapshot(std::vector<uint8_t>& data)const
+{
+	binary_writer writer(data);
+	writer.write(static_cast<uint32_t>(_previous_tick.size()));
+	for (const auto& it : _previous_tick)
+	{
+		writer.write(it.second);
+	}
+	std::vector<uint8_t> ledger_data;
+	_strategy_ledger->save(ledger_data);
+	writer.write(ledger_data);
+}
+
+bool context::load_snapshot(const std::vector<uint8_t>& data)
+{
+	binary_reader reader(data);
+	uint32_t tick_count = 0;
+	reader.read(tick_count);
+	std::map<code_t, tick_info> previous_tick;
+	for (uint32_t i = 0; i < tick_count && reader.good(); i++)
+	{
+		tick_info tick;
+		if (reader.read(tick))
+		{
+			previous_tick[tick.id] = tick;
+		}
+	}
+	std::vector<uint8_t> ledger_data;
+	reader.read(ledger_data);
+	if (!reader.good() || !_strategy_ledger->load(ledger_data))
+	{
+		LOG_ERROR("context load_snapshot data broken", data.size());
+		return false;
+	}
+	_previous_tick.swap(previous_tick);
+	return true;
+}
+
+void context::get_listener_estids(const order_listener* listener, std::vector<estid_t>& result)const
+{
+	worker_guard guard(_mutex);
+	const order_listener* proxy = get_listener_proxy(const_cast<order_listener*>(listener));
+	for (const auto& it : _order_listener)
+	{
+		if (it.second == listener || it.second == proxy)
+		{
+			result.emplace_back(it.first);
+		}
+	}
+}
+
+void context::set_listener_proxy(const order_listener* listener, order_listener* proxy)
+{
+	_listener_proxy[listener] = proxy;
+}
+
+void context::clear_listener_proxy()
+{
+	//代理失效以后，还没结束的订单回报直接交给原来的监听者
+	for (auto& it : _order_listener)
+	{
+		for (const auto& proxy : _listener_proxy)
+		{
+			if (it.second == proxy.second)
+			{
+				it.second = const_cast<order_listener*>(proxy.first);
+				break;
+			}
+		}
+	}
+	_listener_proxy.clear();
+}
+
+context::order_listener* context::get_listener_proxy(order_listener* listener)const
+{
+	auto it = _listener_proxy.find(listener);
+	if (it == _listener_proxy.end())
+	{
+		return listener;
+	}
+	return it->second;
+}
+
+void context::process_request()
+{
+	std::lock_guard<spin_mutex> lock(_mutex);
+	handle_request();
+}
+
+void context::handle_request()
+{
+	while (order_request* request = _order_request.pop())
+	{
+		if (request->is_cancel)
+		{
+			request->result = cancel_order(request->estid);
+		}
+		else
+		{
+			request->estid = place_order(request->listener, request->offset, request->direction, request->code, request->count, request->price, request->flag);
+		}
+		request->finished.store(true, std::memory_order_release);
+	}
+}
+
+void context::bind_worker_thread()
+{
+	is_worker_thread = true;
+}
+
+void context::publish_snapshot()
+{
+	context_snapshot& snapshot = _snapshot.begin_write();
+	snapshot.trading_day = get_trading_day();
+	snapshot.last_time = _last_tick_time;
+	snapshot.account = _trader ? _trader->get_account() : account_info();
+	snapshot.statistic = get_all_statistic();
+	snapshot.is_truncated = false;
+	snapshot.position_size = 0;
+	for (const auto& it : _position_info)
+	{
+		if (snapshot.position_size >= context_snapshot::MAX_POSITION)
+		{
+			snapshot.is_truncated = true;
+			break;
+		}
+		snapshot.position[snapshot.position_size++] = it.second;
+	}
+	snapshot.order_size = 0;
+	for (const auto& it : _order_info)
+	{
+		if (snapshot.order_size >= context_snapshot::MAX_ORDER)
+		{
+			snapshot.is_truncated = true;
+			break;
+		}
+		auto& item = snapshot.order[snapshot.order_size++];
+		item.estid = it.second.estid;
+		item.code = it.second.code;
+		item.total_volume = it.second.total_volume;
+		item.last_volume = it.second.last_volume;
+		item.create_time = it.second.create_time;
+		item.offset = it.second.offset;
+		item.direction = it.second.direction;
+		item.price = it.second.price;
+	}
+	_snapshot.end_write();
+	_snapshot_dirty = false;
+}
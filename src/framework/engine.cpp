@@ -22,12 +22,20 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 */
 #include "engine.h"
 #include "bar_generator.h"
+#include "strategy_shard.h"
+#include <instrument_table.hpp>
 
 using namespace lt;
 using namespace lt::hft;
 
 void subscriber::regist_tick_receiver(const code_t& code, tick_receiver* receiver)
 {
+	_engine._tick_reference_count[code]++;
+	if (_record)
+	{
+		_record->tick.emplace_back(code, receiver);
+		return;
+	}
 	auto it = _engine._tick_receiver.find(code);
 	if (it == _engine._tick_receiver.end())
 	{
@@ -37,11 +45,19 @@ void subscriber::regist_tick_receiver(const code_t& code, tick_receiver* receive
 	{
 		it->second.insert(receiver);
 	}
-	_engine._tick_reference_count[code]++;
 }
 
 void unsubscriber::unregist_tick_receiver(const code_t& code, tick_receiver* receiver)
 {
+	//先减引用计数，分片模式下接收者不在引擎的表里
+	auto d_it = _engine._tick_reference_count.find(code);
+	if (d_it != _engine._tick_reference_count.end())
+	{
+		if(d_it->second > 0)
+		{
+			d_it->second--;
+		}
+	}
 	auto it = _engine._tick_receiver.find(code);
 	if (it == _engine._tick_receiver.end())
 	{
@@ -56,18 +72,16 @@ void unsubscriber::unregist_tick_receiver(const code_t& code, tick_receiver* rec
 	{
 		_engine._tick_receiver.erase(it);
 	}
-	auto d_it = _engine._tick_reference_count.find(code);
-	if (d_it != _engine._tick_reference_count.end())
-	{
-		if(d_it->second > 0)
-		{
-			d_it->second--;
-		}
-	}
 }
 
 void subscriber::regist_tape_receiver(const code_t& code, tape_receiver* receiver)
 {
+	_engine._tick_reference_count[code]++;
+	if (_record)
+	{
+		_record->tape.emplace_back(code, receiver);
+		return;
+	}
 	auto it = _engine._tape_receiver.find(code);
 	if (it == _engine._tape_receiver.end())
 	{
@@ -77,11 +91,18 @@ void subscriber::regist_tape_receiver(const code_t& code, tape_receiver* receive
 	{
 		it->second.insert(receiver);
 	}
-	_engine._tick_reference_count[code]++;
 }
 
 void unsubscriber::unregist_tape_receiver(const code_t& code, tape_receiver* receiver)
 {
+	auto d_it = _engine._tick_reference_count.find(code);
+	if (d_it != _engine._tick_reference_count.end())
+	{
+		if (d_it->second > 1)
+		{
+			d_it->second--;
+		}
+	}
 	auto it = _engine._tape_receiver.find(code);
 	if (it == _engine._tape_receiver.end())
 	{
@@ -96,49 +117,26 @@ void unsubscriber::unregist_tape_receiver(const code_t& code, tape_receiver* rec
 	{
 		_engine._tape_receiver.erase(it);
 	}
-	auto d_it = _engine._tick_reference_count.find(code);
-	if (d_it != _engine._tick_reference_count.end())
-	{
-		if (d_it->second > 1)
-		{
-			d_it->second--;
-		}
-	}
 }
 
 void subscriber::regist_bar_receiver(const code_t& code, uint32_t period, bar_receiver* receiver)
 {
-	auto generator_iter = _engine._bar_generator[code].find(period);
-	if(generator_iter == _engine._bar_generator[code].end())
-	{
-		_engine._bar_generator[code][period] = std::make_shared<bar_generator>(period, _engine._ctx.get_price_step(code));
-	}
-	_engine._bar_generator[code][period]->add_receiver(receiver);
 	_engine._tick_reference_count[code]++;
-}
-
-void unsubscriber::unregist_bar_receiver(const code_t& code, uint32_t period, bar_receiver* receiver)
-{
-	auto it = _engine._bar_generator.find(code);
-	if (it == _engine._bar_generator.end())
-	{
-		return;
-	}
-	auto s_it = it->second.find(period);
-	if (s_it == it->second.end())
+	if (_record)
 	{
+		_record->bar.emplace_back(code, period, receiver);
 		return;
 	}
-	s_it->second->remove_receiver(receiver);
-	if(s_it->second->invalid())
+	auto generator_iter = _engine._bar_generator.find(code);
+	if(generator_iter == _engine._bar_generator.end())
 	{
-		it->second.erase(s_it);
-		if (it->second.empty())
-		{
-			_engine._bar_generator.erase(it);
-		}
+		generator_iter = _engine._bar_generator.insert(std::make_pair(code, std::make_shared<bar_generator>(_engine._ctx.get_instrument(_engine._ctx.get_instrument_index(code)).price_step))).first;
 	}
+	generator_iter->second->add_receiver(period, receiver);
+}
 
+void unsubscriber::unregist_bar_receiver(const code_t& code, uint32_t period, bar_receiver* receiver)
+{
 	auto d_it = _engine._tick_reference_count.find(code);
 	if (d_it != _engine._tick_reference_count.end())
 	{
@@ -147,6 +145,16 @@ void unsubscriber::unregist_bar_receiver(const code_t& code, uint32_t period, ba
 			d_it->second--;
 		}
 	}
+	auto it = _engine._bar_generator.find(code);
+	if (it == _engine._bar_generator.end())
+	{
+		return;
+	}
+	it->second->remove_receiver(period, receiver);
+	if(it->second->invalid())
+	{
+		_engine._bar_generator.erase(it);
+	}
 }
 
 engine::engine():_ctx(this)
@@ -161,10 +169,18 @@ engine::~engine()
 
 void engine::on_init()
 {
-	subscriber suber(*this);
-	for (auto it : _strategy_map)
+	uint32_t shard_count = _ctx.get_shard_count();
+	if (shard_count > 0 && !_strategy_map.empty())
 	{
-		it.second->init(suber);
+		init_shard(shard_count);
+	}
+	else
+	{
+		subscriber suber(*this);
+		for (auto it : _strategy_map)
+		{
+			it.second->init(suber);
+		}
 	}
 	std::set<code_t> tick_subscrib;
 	for (auto it = _tick_reference_count.begin(); it != _tick_reference_count.end();)
@@ -179,7 +195,12 @@ void engine::on_init()
 			it++;
 		}
 	}
-	this->_ctx.subscribe(tick_subscrib, [this](const tick_info& tick)->void {
+	this->_ctx.subscribe(tick_subscrib, [this](const tick_info& tick, const tick_info& prev_tick)->void {
+		for (auto& shard : _shards)
+		{
+			shard->post_tick(tick, prev_tick);
+		}
+
 		auto tk_it = _tick_receiver.find(tick.id);
 		if (tk_it != _tick_receiver.end())
 		{
@@ -195,17 +216,17 @@ void engine::on_init()
 		}
 
 		auto tp_it = _tape_receiver.find(tick.id);
-		if (tp_it != _tape_receiver.end())
+		if (tp_it != _tape_receiver.end() && !tp_it->second.empty())
 		{
+			//有订阅才计算，每个tick只算一次再分发给所有订阅者
+			lt::tape_info deal_info(tick.id, tick.time, tick.price);
+			deal_info.volume_delta = static_cast<uint32_t>(tick.volume - prev_tick.volume);
+			deal_info.interest_delta = tick.open_interest - prev_tick.open_interest;
+			deal_info.direction = get_deal_direction(prev_tick, tick);
 			for (auto tprc : tp_it->second)
 			{
 				if (tprc)
 				{
-					lt::tape_info deal_info(tick.id, tick.time, tick.price);
-					const auto& prev_tick = _ctx.get_previous_tick(tick.id);
-					deal_info.volume_delta = static_cast<uint32_t>(tick.volume - prev_tick.volume);
-					deal_info.interest_delta = tick.open_interest - prev_tick.open_interest;
-					deal_info.direction = get_deal_direction(prev_tick, tick);
 					tprc->on_tape(deal_info);
 				}
 			}
@@ -214,10 +235,7 @@ void engine::on_init()
 		auto br_it = _bar_generator.find(tick.id);
 		if (br_it != _bar_generator.end())
 		{
-			for (auto bg_it : br_it->second)
-			{
-				bg_it.second->insert_tick(tick);
-			}
+			br_it->second->insert_tick(tick);
 		}
 	});
 }
@@ -225,6 +243,15 @@ void engine::on_init()
 void engine::on_update()
 {
 	this->process();
+	if (!_shards.empty())
+	{
+		//策略在分片线程上更新，这里只把积压的事件交给分片
+		for (auto& shard : _shards)
+		{
+			shard->flush();
+		}
+		return;
+	}
 	for (auto& it : this->_strategy_map)
 	{
 		it.second->update();
@@ -233,6 +260,13 @@ void engine::on_update()
 
 void engine::on_destroy()
 {
+	for (auto& shard : _shards)
+	{
+		shard->stop();
+	}
+	_shards.clear();
+	_strategy_shard.clear();
+	_ctx.clear_listener_proxy();
 	unsubscriber unsuber(*this);
 	for (auto it : _strategy_map)
 	{
@@ -260,7 +294,17 @@ void engine::regist_strategy(const std::vector<std::shared_ptr<lt::hft::strategy
 	subscriber suber(*this);
 	for (auto it : strategys)
 	{
-		this->add_handle(it->get_id(),std::bind(&lt::hft::strategy::handle_change, &(*it), std::placeholders::_1));
+		strategy* target = it.get();
+		this->add_handle(it->get_id(), [this, target](const std::vector<std::any>& msg)->void {
+			//分片模式下交给策略所在的分片处理，策略状态只在分片线程上修改
+			auto shard_it = _strategy_shard.find(target->get_id());
+			if (shard_it != _strategy_shard.end())
+			{
+				shard_it->second->post_change(target, msg);
+				return;
+			}
+			target->handle_change(msg);
+		});
 		_strategy_map[it->get_id()] = (it);
 	}
 }
@@ -272,6 +316,38 @@ void engine::clear_strategy()
 	_strategy_map.clear();
 }
 
+void engine::init_shard(uint32_t shard_count)
+{
+	std::vector<std::pair<std::shared_ptr<strategy>, subscription>> records;
+	for (auto it : _strategy_map)
+	{
+		subscription record;
+		subscriber suber(*this, &record);
+		it.second->init(suber);
+		records.emplace_back(it.second, record);
+	}
+	//同一个合约的策略排在一起，再按顺序均分，行情尽量只进一个分片
+	std::stable_sort(records.begin(), records.end(), [](const auto& lh, const auto& rh)->bool {
+		return lh.second.primary_code() < rh.second.primary_code();
+	});
+	shard_count = std::min<uint32_t>(shard_count, static_cast<uint32_t>(records.size()));
+	for (uint32_t i = 0; i < shard_count; i++)
+	{
+		_shards.emplace_back(std::make_shared<strategy_shard>(i, *this));
+	}
+	for (size_t i = 0; i < records.size(); i++)
+	{
+		auto& shard = _shards[i * shard_count / records.size()];
+		shard->add_strategy(records[i].first, records[i].second);
+		_strategy_shard[records[i].first->get_id()] = shard;
+	}
+	for (auto& shard : _shards)
+	{
+		LOG_INFO("strategy shard start :", shard->strategy_count());
+		shard->start();
+	}
+}
+
 deal_direction engine::get_deal_direction(const tick_info& prev, const tick_info& tick)const
 {
 	if (tick.price >= prev.sell_price() || tick.price >= tick.sell_price())
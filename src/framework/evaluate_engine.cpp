@@ -21,16 +21,21 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
 OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 #include "evaluate_engine.h"
-#include "csv_recorder.h"
+#include "stream_recorder.h"
 #include <filesystem>
 #include <inipp.h>
 #include <thread>
 #include <interface.h>
 #include <market_api.h>
 #include <trader_api.h>
+#include <binary_stream.hpp>
 
 using namespace lt::hft;
 
+//快照文件头 "LTSS"
+constexpr uint32_t SNAPSHOT_MAGIC = 0x5353544C;
+constexpr uint32_t SNAPSHOT_VERSION = 2;
+
 evaluate_engine::evaluate_engine(const char* config_path):engine(), _market_simulator(nullptr), _trader_simulator(nullptr)
 {
 	if (!std::filesystem::exists(config_path))
@@ -77,8 +82,21 @@ evaluate_engine::evaluate_engine(const char* config_path):engine(), _market_simu
 	if (it != ini.sections.end())
 	{
 		params recorder_patams(it->second);
-		const auto& recorder_path = recorder_patams.get<std::string>("basic_path");
-		_recorder = std::make_shared<csv_recorder>(recorder_path.c_str());
+		try
+		{
+			_recorder_type = recorder_patams.get<std::string>("type");
+		}
+		catch (...)
+		{
+			_recorder_type = "csv";
+		}
+		set_recorder_path(recorder_patams.get<std::string>("basic_path"));
+	}
+	it = ini.sections.find("snapshot");
+	if (it != ini.sections.end())
+	{
+		params snapshot_patams(it->second);
+		_snapshot_path = snapshot_patams.get<std::string>("basic_path");
 	}
 	it = ini.sections.find("control");
 	if (it == ini.sections.end())
@@ -101,27 +119,47 @@ evaluate_engine::~evaluate_engine()
 	}
 }
 
-void evaluate_engine::back_test(const std::vector<std::shared_ptr<lt::hft::strategy>>& strategys, uint32_t trading_day)
+const lt::account_info& evaluate_engine::get_account()const
 {
+	static lt::account_info empty_account;
 	if (!_trader_simulator)
 	{
+		return empty_account;
+	}
+	return _trader_simulator->get_account();
+}
+
+void evaluate_engine::back_test(const std::vector<std::shared_ptr<lt::hft::strategy>>& strategys, uint32_t trading_day)
+{
+	if (!_trader_simulator || !_market_simulator)
+	{
+		LOG_ERROR("evaluate_engine back_test simulator not ready :", trading_day);
+		return;
 	}
 	_trader_simulator->crossday(trading_day);
 	this->regist_strategy(strategys);
 	if(this->_ctx.start_service())
 	{
+		if (_recorder)
+		{
+			bind_recorder();
+		}
 		_market_simulator->play(_trader_simulator->get_trading_day(), [this](const std::vector<const tick_info*>& current_tick)->void {
 			_trader_simulator->push_tick(current_tick);
 			});
 		while (!_market_simulator->is_finished())
 		{
-			std::this_thread::sleep_for(std::chrono::seconds(1));
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
 		}
-		rapidcsv::Document _crossday_flow_csv;
 		//记录结算数据
 		if (_recorder)
 		{
 			_recorder->record_crossday_flow(_trader_simulator->get_trading_day(), _ctx.get_all_statistic(), _trader_simulator->get_account());
+			_recorder->record_equity(_trader_simulator->get_trading_day(), _ctx.get_last_time(), _trader_simulator->get_account());
+		}
+		if (!_snapshot_path.empty())
+		{
+			save_snapshot(strategys, _trader_simulator->get_trading_day());
 		}
 		if(this->_ctx.stop_service())
 		{
@@ -129,3 +167,155 @@ void evaluate_engine::back_test(const std::vector<std::shared_ptr<lt::hft::strat
 		}
 	}
 }
+
+void evaluate_engine::set_recorder_path(const std::string& path)
+{
+	_recorder_path = path;
+	_recorder.reset();
+	if (!_recorder_path.empty())
+	{
+		_recorder = std::make_shared<stream_recorder>(_recorder_path.c_str(), stream_recorder::parse_format(_recorder_type));
+	}
+}
+
+void evaluate_engine::bind_recorder()
+{
+	_trader_simulator->bind_event(trader_event_type::TET_OrderPlace, [this](const std::vector<std::any>& param)->void {
+		if (param.size() >= 1)
+		{
+			const order_info& order = std::any_cast<const order_info&>(param[0]);
+			order_record record{ _trader_simulator->get_trading_day(), _ctx.get_last_time(), order_event::OE_ENTRUST, order.estid, order.code, order.offset, order.direction, order.price, order.total_volume, order.last_volume, 0 };
+			_recorder->record_order(record);
+		}
+	});
+	_trader_simulator->bind_event(trader_event_type::TET_OrderDeal, [this](const std::vector<std::any>& param)->void {
+		if (param.size() >= 3)
+		{
+			estid_t estid = std::any_cast<estid_t>(param[0]);
+			uint32_t deal_volume = std::any_cast<uint32_t>(param[1]);
+			uint32_t last_volume = std::any_cast<uint32_t>(param[2]);
+			const order_info& order = _ctx.get_order(estid);
+			const uint32_t trading_day = _trader_simulator->get_trading_day();
+			const daytm_t time = _ctx.get_last_time();
+			order_record record{ trading_day, time, order_event::OE_DEAL, estid, order.code, order.offset, order.direction, order.price, deal_volume, last_volume, 0 };
+			_recorder->record_order(record);
+			deal_record deal{ trading_day, time, estid, order.code, order.offset, order.direction, order.price, deal_volume };
+			_recorder->record_deal(deal);
+			_recorder->record_equity(trading_day, time, _trader_simulator->get_account());
+		}
+	});
+	_trader_simulator->bind_event(trader_event_type::TET_OrderTrade, [this](const std::vector<std::any>& param)->void {
+		if (param.size() >= 6)
+		{
+			estid_t estid = std::any_cast<estid_t>(param[0]);
+			order_record record{ _trader_simulator->get_trading_day(), _ctx.get_last_time(), order_event::OE_TRADE, estid, std::any_cast<code_t>(param[1]), std::any_cast<offset_type>(param[2]), std::any_cast<direction_type>(param[3]), std::any_cast<double_t>(param[4]), std::any_cast<uint32_t>(param[5]), 0, 0 };
+			_recorder->record_order(record);
+		}
+	});
+	_trader_simulator->bind_event(trader_event_type::TET_OrderCancel, [this](const std::vector<std::any>& param)->void {
+		if (param.size() >= 7)
+		{
+			estid_t estid = std::any_cast<estid_t>(param[0]);
+			order_record record{ _trader_simulator->get_trading_day(), _ctx.get_last_time(), order_event::OE_CANCEL, estid, std::any_cast<code_t>(param[1]), std::any_cast<offset_type>(param[2]), std::any_cast<direction_type>(param[3]), std::any_cast<double_t>(param[4]), std::any_cast<uint32_t>(param[5]), std::any_cast<uint32_t>(param[6]), 0 };
+			_recorder->record_order(record);
+		}
+	});
+	_trader_simulator->bind_event(trader_event_type::TET_OrderError, [this](const std::vector<std::any>& param)->void {
+		if (param.size() >= 3)
+		{
+			estid_t estid = std::any_cast<estid_t>(param[1]);
+			//context的handle_error先执行已经删掉了订单，下单失败的订单context也没有，从模拟柜台取
+			const order_info& order = _trader_simulator->get_order(estid);
+			order_record record{ _trader_simulator->get_trading_day(), _ctx.get_last_time(), order_event::OE_ERROR, estid, order.code, order.offset, order.direction, order.price, 0, 0, std::any_cast<uint8_t>(param[2]) };
+			_recorder->record_order(record);
+		}
+	});
+}
+
+void evaluate_engine::save_snapshot(const std::vector<std::shared_ptr<lt::hft::strategy>>& strategys, uint32_t trading_day)
+{
+	std::vector<uint8_t> data;
+	binary_writer writer(data);
+	writer.write(SNAPSHOT_MAGIC).write(SNAPSHOT_VERSION).write(trading_day);
+	std::vector<uint8_t> buffer;
+	_trader_simulator->save_snapshot(buffer);
+	writer.write(buffer);
+	buffer.clear();
+	_ctx.save_snapshot(buffer);
+	writer.write(buffer);
+	writer.write(static_cast<uint32_t>(strategys.size()));
+	for (const auto& it : strategys)
+	{
+		buffer.clear();
+		it->save(buffer);
+		writer.write(it->get_id()).write(buffer);
+	}
+	if (!std::filesystem::exists(_snapshot_path))
+	{
+		std::filesystem::create_directories(_snapshot_path);
+	}
+	const auto& filename = (std::filesystem::path(_snapshot_path) / (std::to_string(trading_day) + ".snap")).string();
+	std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		LOG_ERROR("evaluate_engine save_snapshot cant open file :", filename);
+		return;
+	}
+	file.write(reinterpret_cast<const char*>(data.data()), data.size());
+	LOG_INFO("evaluate_engine save_snapshot :", filename, data.size());
+}
+
+bool evaluate_engine::load_snapshot(const std::vector<std::shared_ptr<lt::hft::strategy>>& strategys, uint32_t trading_day)
+{
+	if (!_trader_simulator || _snapshot_path.empty())
+	{
+		LOG_ERROR("evaluate_engine load_snapshot not ready :", trading_day);
+		return false;
+	}
+	const auto& filename = (std::filesystem::path(_snapshot_path) / (std::to_string(trading_day) + ".snap")).string();
+	std::ifstream file(filename, std::ios::binary);
+	if (!file.is_open())
+	{
+		LOG_ERROR("evaluate_engine load_snapshot cant open file :", filename);
+		return false;
+	}
+	std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	binary_reader reader(data);
+	uint32_t magic = 0, version = 0, snapshot_day = 0;
+	reader.read(magic);
+	reader.read(version);
+	reader.read(snapshot_day);
+	if (magic != SNAPSHOT_MAGIC || version != SNAPSHOT_VERSION || snapshot_day != trading_day)
+	{
+		LOG_ERROR("evaluate_engine load_snapshot file not match :", filename, version, snapshot_day);
+		return false;
+	}
+	std::vector<uint8_t> buffer;
+	std::vector<uint8_t> context_buffer;
+	reader.read(buffer);
+	reader.read(context_buffer);
+	std::map<straid_t, std::vector<uint8_t>> strategy_data;
+	uint32_t strategy_count = 0;
+	reader.read(strategy_count);
+	for (uint32_t i = 0; i < strategy_count && reader.good(); i++)
+	{
+		straid_t id = 0;
+		reader.read(id);
+		reader.read(strategy_data[id]);
+	}
+	if (!reader.good() || !_trader_simulator->load_snapshot(buffer) || !_ctx.load_snapshot(context_buffer))
+	{
+		LOG_ERROR("evaluate_engine load_snapshot data broken :", filename);
+		return false;
+	}
+	for (const auto& it : strategys)
+	{
+		auto sit = strategy_data.find(it->get_id());
+		if (sit != strategy_data.end())
+		{
+			it->load(sit->second);
+		}
+	}
+	LOG_INFO("evaluate_engine load_snapshot :", filename, strategy_data.size());
+	return true;
+}
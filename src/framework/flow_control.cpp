@@ -0,0 +1,171 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "flow_control.h"
+#include <log_wapper.hpp>
+
+using namespace lt;
+using namespace lt::hft;
+
+namespace
+{
+	inline token_bucket& get_bucket(std::vector<token_bucket>& buckets, uint32_t index, uint32_t limit)
+	{
+		size_t slot = index == flow_control::INVALID_SLOT ? 0U : static_cast<size_t>(index) + 1U;
+		if (slot >= buckets.size())
+		{
+			buckets.resize(slot + 1U, token_bucket(limit));
+		}
+		return buckets[slot];
+	}
+
+	template<typename T>
+	T get_limit(const params& config, const char* key)
+	{
+		try
+		{
+			return config.get<T>(key);
+		}
+		catch (...)
+		{
+			//不配置不限制
+			return T(0);
+		}
+	}
+}
+
+flow_control::flow_control(const params& control_config) :
+	_is_enabled(false),
+	_instrument_order_limit(get_limit<uint32_t>(control_config, "instrument_order_limit")),
+	_strategy_order_limit(get_limit<uint32_t>(control_config, "strategy_order_limit")),
+	_instrument_cancel_limit(get_limit<uint32_t>(control_config, "instrument_cancel_limit")),
+	_cancel_ratio_limit(get_limit<double_t>(control_config, "cancel_ratio_limit")),
+	_session_order(get_limit<uint32_t>(control_config, "session_order_limit")),
+	_session_cancel(get_limit<uint32_t>(control_config, "session_cancel_limit")),
+	_sequence(0)
+{
+	_is_enabled = _session_order.is_limited() || _session_cancel.is_limited() || _instrument_order_limit > 0 || _strategy_order_limit > 0 || _instrument_cancel_limit > 0 || _cancel_ratio_limit > 0;
+	if (_is_enabled)
+	{
+		LOG_INFO("flow_control enabled :", _instrument_order_limit, _strategy_order_limit, _instrument_cancel_limit, _cancel_ratio_limit);
+	}
+}
+
+bool flow_control::can_place(instrument_index instrument, uint32_t strategy, offset_type offset, const order_statistic& statistic, daytm_t now)
+{
+	if (offset == offset_type::OT_OPEN)
+	{
+		//撤单过多只停开仓，平仓不受影响
+		if (_instrument_cancel_limit > 0 && statistic.cancel_amount >= _instrument_cancel_limit)
+		{
+			return false;
+		}
+		if (_cancel_ratio_limit > 0 && statistic.entrust_amount >= CANCEL_RATIO_MIN_ENTRUST && statistic.cancel_amount > _cancel_ratio_limit * statistic.entrust_amount)
+		{
+			return false;
+		}
+	}
+	//三级都有令牌才通过，令牌在commit_place里扣除
+	if (!_session_order.can_acquire(now))
+	{
+		return false;
+	}
+	if (_instrument_order_limit > 0 && !get_bucket(_instrument_order, instrument, _instrument_order_limit).can_acquire(now))
+	{
+		return false;
+	}
+	if (_strategy_order_limit > 0 && !get_bucket(_strategy_order, strategy, _strategy_order_limit).can_acquire(now))
+	{
+		return false;
+	}
+	return true;
+}
+
+void flow_control::commit_place(instrument_index instrument, uint32_t strategy)
+{
+	_session_order.consume();
+	if (_instrument_order_limit > 0)
+	{
+		get_bucket(_instrument_order, instrument, _instrument_order_limit).consume();
+	}
+	if (_strategy_order_limit > 0)
+	{
+		get_bucket(_strategy_order, strategy, _strategy_order_limit).consume();
+	}
+}
+
+void flow_control::defer_place(context::order_listener* listener, const code_t& code, instrument_index instrument, uint32_t strategy, offset_type offset)
+{
+	for (auto& it : _deferred_place)
+	{
+		if (it.listener == listener && it.code == code)
+		{
+			//开仓被拒以后又来平仓，按限制少的平仓通知
+			if (offset != offset_type::OT_OPEN)
+			{
+				it.offset = offset;
+			}
+			return;
+		}
+	}
+	_deferred_place.push_back({ listener, code, instrument, strategy, offset });
+	LOG_INFO("flow_control defer place :", code.get_id(), offset, _deferred_place.size());
+}
+
+void flow_control::defer_cancel(estid_t estid, daytm_t create_time)
+{
+	if (!_deferred_estid.insert(estid).second)
+	{
+		return;
+	}
+	_deferred_cancel.push({ estid, create_time, _sequence++ });
+	LOG_INFO("flow_control defer cancel :", estid, _deferred_cancel.size());
+}
+
+bool flow_control::peek_deferred(estid_t& estid)const
+{
+	if (_deferred_cancel.empty())
+	{
+		return false;
+	}
+	estid = _deferred_cancel.top().estid;
+	return true;
+}
+
+void flow_control::pop_deferred()
+{
+	if (!_deferred_cancel.empty())
+	{
+		_deferred_estid.erase(_deferred_cancel.top().estid);
+		_deferred_cancel.pop();
+	}
+}
+
+void flow_control::clear()
+{
+	_session_order.reset();
+	_session_cancel.reset();
+	_instrument_order.clear();
+	_strategy_order.clear();
+	_deferred_cancel = std::priority_queue<deferred_cancel>();
+	_deferred_estid.clear();
+}
@@ -0,0 +1,267 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include <define.h>
+#include <define_types.hpp>
+#include <params.hpp>
+#include <context.h>
+#include <instrument_table.hpp>
+#include <queue>
+#include <deque>
+
+namespace lt::hft
+{
+	/*
+	*	令牌桶，按行情时间（毫秒）补充令牌，实盘和回测行为一致
+	*	令牌按千分之一计数，每毫秒补充limit个单位，容量是一秒的令牌数；limit为0表示不限制
+	*/
+	class token_bucket
+	{
+		static constexpr uint64_t TOKEN_UNIT = 1000U;
+
+		uint64_t _capacity;
+
+		uint64_t _rate;
+
+		uint64_t _tokens;
+
+		daytm_t _last_time;
+
+	public:
+
+		token_bucket(uint32_t limit = 0U) :_capacity(limit * TOKEN_UNIT), _rate(limit), _tokens(limit * TOKEN_UNIT), _last_time(0) {}
+
+		bool is_limited()const
+		{
+			return _capacity > 0;
+		}
+
+		bool can_acquire(daytm_t now)
+		{
+			if (_capacity == 0)
+			{
+				return true;
+			}
+			if (now > _last_time)
+			{
+				_tokens = std::min(_capacity, _tokens + (now - _last_time) * _rate);
+			}
+			//换日以后时间从头开始
+			_last_time = now;
+			return _tokens >= TOKEN_UNIT;
+		}
+
+		//调用前先can_acquire
+		void consume()
+		{
+			if (_capacity > 0)
+			{
+				_tokens -= TOKEN_UNIT;
+			}
+		}
+
+		void reset()
+		{
+			_tokens = _capacity;
+			_last_time = 0;
+		}
+
+		bool try_acquire(daytm_t now)
+		{
+			if (!can_acquire(now))
+			{
+				return false;
+			}
+			consume();
+			return true;
+		}
+	};
+
+	/*
+	*	报单流控
+	*	下单按会话、合约、策略三级令牌桶限速，合约撤单次数或撤单比超限以后不再开新单（平仓和撤单不受影响）
+	*	下单超限返回INVALID_ESTID并记下被拒的策略，窗口恢复以后通过on_error(ET_PLACE_ORDER, INVALID_ESTID, EC_FlowControl)
+	*	通知它重新下单；撤单超限进入延迟队列，由实时线程在后面的update里按订单创建时间从早到晚补发
+	*	合约和策略的令牌桶按合约下标和账本行号存放，检查时不查表
+	*	所有接口只在实时线程调用
+	*/
+	class flow_control
+	{
+		//撤单比只在委托数达到这个数量以后生效
+		static constexpr uint32_t CANCEL_RATIO_MIN_ENTRUST = 100U;
+
+		struct deferred_place
+		{
+			context::order_listener* listener;
+
+			code_t code;
+
+			instrument_index instrument;
+
+			uint32_t strategy;
+
+			offset_type offset;
+		};
+
+		struct deferred_cancel
+		{
+			estid_t estid;
+
+			daytm_t create_time;
+
+			uint64_t sequence;
+
+			bool operator < (const deferred_cancel& other)const
+			{
+				//priority_queue顶部是最大的，创建时间早的优先
+				if (create_time != other.create_time)
+				{
+					return create_time > other.create_time;
+				}
+				return sequence > other.sequence;
+			}
+		};
+
+	public:
+
+		//合约不在合约表里、监听者没有登记账本时的下标，这些下单共用一个令牌桶
+		static constexpr uint32_t INVALID_SLOT = 0xFFFFFFFFU;
+
+		flow_control(const params& control_config);
+
+		bool is_enabled()const
+		{
+			return _is_enabled;
+		}
+
+		/*
+		*	下单检查，只检查不扣除令牌
+		*	instrument是合约下标，strategy是下单策略的账本行号；撤单次数和撤单比只限制开仓
+		*/
+		bool can_place(instrument_index instrument, uint32_t strategy, offset_type offset, const order_statistic& statistic, daytm_t now);
+
+		/*
+		*	下单成功（拿到estid）以后扣除令牌，调用前先can_place
+		*	柜台拒绝的下单不扣令牌，避免连续失败把正常下单也限制住
+		*/
+		void commit_place(instrument_index instrument, uint32_t strategy);
+
+		/*
+		*	记下被拒的下单，同一个策略同一个合约只保留一份
+		*/
+		void defer_place(context::order_listener* listener, const code_t& code, instrument_index instrument, uint32_t strategy, offset_type offset);
+
+		/*
+		*	取出窗口已经恢复的被拒下单，statistic按合约取撤单统计
+		*/
+		template<typename Statistic, typename Notify>
+		void release_place(daytm_t now, Statistic statistic, Notify notify)
+		{
+			for (auto it = _deferred_place.begin(); it != _deferred_place.end();)
+			{
+				if (can_place(it->instrument, it->strategy, it->offset, statistic(it->code), now))
+				{
+					const deferred_place place = *it;
+					it = _deferred_place.erase(it);
+					notify(place.listener, place.code);
+				}
+				else
+				{
+					++it;
+				}
+			}
+		}
+
+		size_t deferred_place_size()const
+		{
+			return _deferred_place.size();
+		}
+
+		//策略清理以后监听者失效
+		void clear_deferred_place()
+		{
+			_deferred_place.clear();
+		}
+
+		/*
+		*	撤单检查，通过以后扣除令牌
+		*/
+		bool try_cancel(daytm_t now)
+		{
+			return _session_cancel.try_acquire(now);
+		}
+
+		/*
+		*	撤单放进延迟队列，同一个订单只保留一份
+		*/
+		void defer_cancel(estid_t estid, daytm_t create_time);
+
+		/*
+		*	延迟队列里最优先的撤单
+		*/
+		bool peek_deferred(estid_t& estid)const;
+
+		void pop_deferred();
+
+		size_t deferred_size()const
+		{
+			return _deferred_cancel.size();
+		}
+
+		/*
+		*	换日或者重新开始交易时清理状态，被拒的下单保留到窗口恢复时通知
+		*/
+		void clear();
+
+	private:
+
+		bool _is_enabled;
+
+		uint32_t _instrument_order_limit;
+
+		uint32_t _strategy_order_limit;
+
+		//单合约每个交易日撤单上限
+		uint32_t _instrument_cancel_limit;
+
+		//单合约撤单比上限（撤单数/委托数）
+		double_t _cancel_ratio_limit;
+
+		token_bucket _session_order;
+
+		token_bucket _session_cancel;
+
+		//下标0是没有下标的共用令牌桶，其余按下标+1存放，用到时扩充
+		std::vector<token_bucket> _instrument_order;
+
+		std::vector<token_bucket> _strategy_order;
+
+		std::deque<deferred_place> _deferred_place;
+
+		std::priority_queue<deferred_cancel> _deferred_cancel;
+
+		std::set<estid_t> _deferred_estid;
+
+		uint64_t _sequence;
+	};
+}
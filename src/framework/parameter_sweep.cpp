@@ -0,0 +1,139 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "parameter_sweep.h"
+#include "evaluate_engine.h"
+#include <filesystem>
+#include <thread>
+#include <fstream>
+#include <algorithm>
+#include <log_wapper.hpp>
+
+using namespace lt;
+using namespace lt::hft;
+
+namespace lt::hft
+{
+	struct sweep_instance
+	{
+		std::shared_ptr<evaluate_engine> engine;
+
+		std::vector<std::shared_ptr<strategy>> strategys;
+
+		sweep_result result;
+	};
+}
+
+parameter_sweep::parameter_sweep(const char* config_path, uint32_t worker_count) :
+	_config_path(config_path),
+	_worker_count(worker_count)
+{
+	if (_worker_count == 0)
+	{
+		_worker_count = std::max<uint32_t>(std::thread::hardware_concurrency(), 1U);
+	}
+}
+
+const std::vector<sweep_result>& parameter_sweep::run(const std::vector<params>& combinations, const std::vector<uint32_t>& trading_days, strategy_creator creator)
+{
+	_results.clear();
+	std::vector<sweep_instance> instances(combinations.size());
+	for (size_t i = 0; i < combinations.size(); i++)
+	{
+		auto& instance = instances[i];
+		instance.engine = std::make_shared<evaluate_engine>(_config_path.c_str());
+		if (!instance.engine->get_snapshot_path().empty())
+		{
+			//每个组合的快照分开保存，避免互相覆盖
+			instance.engine->set_snapshot_path((std::filesystem::path(instance.engine->get_snapshot_path()) / std::to_string(i)).string());
+		}
+		if (!instance.engine->get_recorder_path().empty())
+		{
+			instance.engine->set_recorder_path((std::filesystem::path(instance.engine->get_recorder_path()) / std::to_string(i)).string());
+		}
+		instance.strategys = creator(instance.engine.get(), combinations[i]);
+		instance.result.index = i;
+		instance.result.param = combinations[i];
+	}
+	const size_t worker_count = std::min<size_t>(_worker_count, instances.size());
+	for (auto trading_day : trading_days)
+	{
+		//按交易日推进，同一交易日的数据在所有实例间共享
+		std::vector<std::thread> workers;
+		for (size_t w = 0; w < worker_count; w++)
+		{
+			workers.emplace_back([&instances, trading_day, worker_count, w]()->void {
+				for (size_t i = w; i < instances.size(); i += worker_count)
+				{
+					auto& instance = instances[i];
+					instance.engine->back_test(instance.strategys, trading_day);
+					const auto& statistic = instance.engine->get_all_statistic();
+					instance.result.statistic.place_order_amount += statistic.place_order_amount;
+					instance.result.statistic.entrust_amount += statistic.entrust_amount;
+					instance.result.statistic.trade_amount += statistic.trade_amount;
+					instance.result.statistic.cancel_amount += statistic.cancel_amount;
+					instance.result.statistic.error_amount += statistic.error_amount;
+				}
+			});
+		}
+		for (auto& it : workers)
+		{
+			it.join();
+		}
+		LOG_INFO("parameter_sweep finish trading day :", trading_day, instances.size());
+	}
+	for (auto& instance : instances)
+	{
+		instance.result.account = instance.engine->get_account();
+		_results.emplace_back(instance.result);
+	}
+	std::sort(_results.begin(), _results.end(), [](const sweep_result& lh, const sweep_result& rh)->bool {
+		return lh.account.money > rh.account.money;
+	});
+	return _results;
+}
+
+bool parameter_sweep::save_result(const char* path)const
+{
+	std::ofstream file(path, std::ios::out | std::ios::trunc);
+	if (!file.is_open())
+	{
+		LOG_ERROR("parameter_sweep save_result cant open file :", path);
+		return false;
+	}
+	file << "rank,index,money,frozen_monery,place_order_amount,entrust_amount,trade_amount,cancel_amount,error_amount,params" << std::endl;
+	for (size_t i = 0; i < _results.size(); i++)
+	{
+		const auto& result = _results[i];
+		file << i + 1 << ',' << result.index << ',' << result.account.money << ',' << result.account.frozen_monery << ','
+			<< result.statistic.place_order_amount << ',' << result.statistic.entrust_amount << ',' << result.statistic.trade_amount << ','
+			<< result.statistic.cancel_amount << ',' << result.statistic.error_amount << ',';
+		bool first = true;
+		for (const auto& it : result.param.data())
+		{
+			file << (first ? "" : "&") << it.first << '=' << it.second;
+			first = false;
+		}
+		file << std::endl;
+	}
+	return true;
+}
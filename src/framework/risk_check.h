@@ -0,0 +1,315 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include <define.h>
+#include <define_types.hpp>
+#include <params.hpp>
+#include <instrument_table.hpp>
+#include <log_wapper.hpp>
+#include <tuple>
+#include <array>
+
+namespace lt::hft
+{
+	/*
+	*	下单前风控检查
+	*	每个检查是一个策略类（init/is_enabled/check），risk_pipeline在编译期把检查列表展开成一串内联的判断，
+	*	前一个检查不通过就不再往后检查，并记录这个检查的拒单次数
+	*/
+
+	//待检查的订单
+	struct risk_order
+	{
+		const code_t& code;
+		offset_type offset;
+		direction_type direction;
+		uint32_t count;
+		double_t price;
+		order_flag flag;
+
+		bool is_buy()const
+		{
+			return (direction == direction_type::DT_LONG && offset == offset_type::OT_OPEN) || (direction == direction_type::DT_SHORT && offset != offset_type::OT_OPEN);
+		}
+	};
+
+	//检查时读取的上下文状态（没有的数据为nullptr）
+	struct risk_state
+	{
+		const position_info* position;
+		const market_info* market;
+		const instrument_info* instrument;
+		const std::map<estid_t, order_info>& orders;
+	};
+
+	template<typename T>
+	static inline T get_risk_limit(const params& config, const char* key)
+	{
+		try
+		{
+			return config.get<T>(key);
+		}
+		catch (...)
+		{
+			//不配置不检查
+			return T(0);
+		}
+	}
+
+	//单合约单方向最大持仓（持仓+开仓未成交+本次数量），只检查开仓
+	struct position_limit_check
+	{
+		static constexpr const char* NAME = "position_limit";
+
+		uint32_t limit = 0U;
+
+		void init(const params& config)
+		{
+			limit = get_risk_limit<uint32_t>(config, NAME);
+		}
+
+		bool is_enabled()const
+		{
+			return limit > 0U;
+		}
+
+		bool check(const risk_order& order, const risk_state& state)const
+		{
+			if (order.offset != offset_type::OT_OPEN)
+			{
+				return true;
+			}
+			uint32_t current = 0U;
+			if (state.position)
+			{
+				current = order.direction == direction_type::DT_LONG ?
+					state.position->get_long_position() + state.position->long_pending :
+					state.position->get_short_position() + state.position->short_pending;
+			}
+			return current + order.count <= limit;
+		}
+	};
+
+	//最多同时存在的未完成订单数
+	struct pending_limit_check
+	{
+		static constexpr const char* NAME = "pending_limit";
+
+		uint32_t limit = 0U;
+
+		void init(const params& config)
+		{
+			limit = get_risk_limit<uint32_t>(config, NAME);
+		}
+
+		bool is_enabled()const
+		{
+			return limit > 0U;
+		}
+
+		bool check(const risk_order& order, const risk_state& state)const
+		{
+			return state.orders.size() < limit;
+		}
+	};
+
+	//单笔开仓最大金额（价格*数量*合约乘数），市价单按最新价计算
+	//合约乘数或者价格未知时无法计算金额，直接拒绝（需要配置contract_config）
+	struct notional_limit_check
+	{
+		static constexpr const char* NAME = "notional_limit";
+
+		double_t limit = .0;
+
+		void init(const params& config)
+		{
+			limit = get_risk_limit<double_t>(config, NAME);
+		}
+
+		bool is_enabled()const
+		{
+			return limit > .0;
+		}
+
+		bool check(const risk_order& order, const risk_state& state)const
+		{
+			if (order.offset != offset_type::OT_OPEN)
+			{
+				return true;
+			}
+			double_t price = order.price;
+			if (price <= .0 && state.market)
+			{
+				price = state.market->last_tick_info.price;
+			}
+			if (state.instrument == nullptr || state.instrument->multiple <= .0 || price <= .0)
+			{
+				return false;
+			}
+			return price * order.count * state.instrument->multiple <= limit;
+		}
+	};
+
+	//委托价格必须在涨跌停价之内（还没有收到行情时不检查，市价单不检查）
+	struct price_band_check
+	{
+		static constexpr const char* NAME = "price_band";
+
+		bool enabled = false;
+
+		void init(const params& config)
+		{
+			enabled = get_risk_limit<bool>(config, NAME);
+		}
+
+		bool is_enabled()const
+		{
+			return enabled;
+		}
+
+		bool check(const risk_order& order, const risk_state& state)const
+		{
+			if (order.price <= .0 || state.market == nullptr || state.market->max_price <= .0 || state.market->min_price <= .0)
+			{
+				return true;
+			}
+			return state.market->min_price <= order.price && order.price <= state.market->max_price;
+		}
+	};
+
+	//自成交：同合约反方向的挂单价格和本次委托价格交叉
+	struct self_trade_check
+	{
+		static constexpr const char* NAME = "self_trade";
+
+		bool enabled = false;
+
+		void init(const params& config)
+		{
+			enabled = get_risk_limit<bool>(config, NAME);
+		}
+
+		bool is_enabled()const
+		{
+			return enabled;
+		}
+
+		bool check(const risk_order& order, const risk_state& state)const
+		{
+			const bool is_buy = order.is_buy();
+			for (const auto& it : state.orders)
+			{
+				const order_info& resting = it.second;
+				if (resting.code != order.code)
+				{
+					continue;
+				}
+				//市价单和任何反方向挂单都会成交
+				if (is_buy && resting.is_sell() && (order.price <= .0 || resting.price <= order.price))
+				{
+					return false;
+				}
+				if (!is_buy && resting.is_buy() && (order.price <= .0 || resting.price >= order.price))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+	};
+
+	template<typename... Checks>
+	class risk_pipeline
+	{
+		std::tuple<Checks...> _checks;
+
+		std::array<uint64_t, sizeof...(Checks)> _reject_count;
+
+		bool _is_enabled;
+
+	public:
+
+		risk_pipeline() :_reject_count{}, _is_enabled(false) {}
+
+		void init(const params& config)
+		{
+			std::apply([&config](auto&... checks) { (checks.init(config), ...); }, _checks);
+			_is_enabled = std::apply([](const auto&... checks) { return (checks.is_enabled() || ...); }, _checks);
+		}
+
+		bool is_enabled()const
+		{
+			return _is_enabled;
+		}
+
+		bool check(const risk_order& order, const risk_state& state)
+		{
+			return check(order, state, std::index_sequence_for<Checks...>{});
+		}
+
+		uint64_t get_reject_count(size_t index)const
+		{
+			return _reject_count[index];
+		}
+
+		void print_statistic()const
+		{
+			print_statistic(std::index_sequence_for<Checks...>{});
+		}
+
+	private:
+
+		template<size_t... I>
+		bool check(const risk_order& order, const risk_state& state, std::index_sequence<I...>)
+		{
+			//折叠表达式按顺序短路
+			return (check_one<I>(order, state) && ...);
+		}
+
+		template<size_t I>
+		bool check_one(const risk_order& order, const risk_state& state)
+		{
+			const auto& current = std::get<I>(_checks);
+			if (!current.is_enabled() || current.check(order, state))
+			{
+				return true;
+			}
+			_reject_count[I]++;
+			LOG_WARNING("risk check reject :", current.NAME, order.code.get_id(), order.offset, order.direction, order.price, order.count);
+			return false;
+		}
+
+		template<size_t... I>
+		void print_statistic(std::index_sequence<I...>)const
+		{
+			([this]() {
+				LOG_INFO("risk check reject count :", std::get<I>(_checks).NAME, _reject_count[I]);
+				}(), ...);
+		}
+	};
+
+	//价格和自成交检查放在前面，不依赖持仓
+	class risk_control : public risk_pipeline<price_band_check, self_trade_check, position_limit_check, pending_limit_check, notional_limit_check>
+	{
+	};
+}
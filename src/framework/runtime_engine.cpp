@@ -26,10 +26,16 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include <interface.h>
 #include <filesystem>
 #include <inipp.h>
+#include <string_helper.hpp>
+#include <binary_stream.hpp>
 
 using namespace lt::hft;
 
-runtime_engine::runtime_engine(const char* config_path):engine(), _trader(nullptr), _market(nullptr)
+//账本文件头 "LTLG"
+constexpr uint32_t LEDGER_MAGIC = 0x474C544C;
+constexpr uint32_t LEDGER_VERSION = 1;
+
+runtime_engine::runtime_engine(const char* config_path):engine(), _trader(nullptr), _standby(nullptr), _market(nullptr)
 {
 	if (!std::filesystem::exists(config_path))
 	{
@@ -46,6 +52,13 @@ runtime_engine::runtime_engine(const char* config_path):engine(), _trader(nullpt
 		return ;
 	}
 	params include_patams(it->second);
+	try
+	{
+		_ledger_path = include_patams.get<std::string>("ledger_path");
+	}
+	catch (...)
+	{
+	}
 	it = ini.sections.find("actual_market");
 	if (it == ini.sections.end())
 	{
@@ -53,7 +66,32 @@ runtime_engine::runtime_engine(const char* config_path):engine(), _trader(nullpt
 		return ;
 	}
 	//market
-	_market = create_actual_market(it->second);
+	if (it->second["market"] == "composite")
+	{
+		//多路行情：feeds配置各路行情的section名称，用逗号分隔
+		std::vector<actual_market*> feeds;
+		for (const auto& name : string_helper::split(it->second["feeds"], ','))
+		{
+			auto feed_it = ini.sections.find(name);
+			if (feed_it == ini.sections.end())
+			{
+				LOG_ERROR("runtime_engine init_from_file cant find market feed :", name);
+				continue;
+			}
+			actual_market* feed = create_actual_market(feed_it->second);
+			if (feed == nullptr)
+			{
+				LOG_ERROR("runtime_engine init_from_file create market feed error :", name);
+				continue;
+			}
+			feeds.emplace_back(feed);
+		}
+		_market = create_composite_market(feeds);
+	}
+	else
+	{
+		_market = create_actual_market(it->second);
+	}
 	if (_market == nullptr)
 	{
 		LOG_ERROR("runtime_engine init_from_file create_market_api ", config_path);
@@ -72,6 +110,18 @@ runtime_engine::runtime_engine(const char* config_path):engine(), _trader(nullpt
 		LOG_ERROR("runtime_engine init_from_file create_trader_api error : %s", config_path);
 		return ;
 	}
+	it = ini.sections.find("standby_trader");
+	if (it != ini.sections.end())
+	{
+		//热备和主会话使用同一个资金账号，登录以后只同步订单，主会话断线时接管
+		_standby = create_actual_trader(it->second);
+		if (_standby && !_standby->set_standby(_trader))
+		{
+			LOG_ERROR("runtime_engine init_from_file standby_trader not supported : %s", config_path);
+			destory_actual_trader(_standby);
+			_standby = nullptr;
+		}
+	}
 	it = ini.sections.find("control");
 	if (it == ini.sections.end())
 	{
@@ -91,6 +141,10 @@ runtime_engine::~runtime_engine()
 	{
 		destory_actual_trader(_trader);
 	}
+	if (_standby)
+	{
+		destory_actual_trader(_standby);
+	}
 }
 
 
@@ -100,7 +154,21 @@ void runtime_engine::start_trading(const std::vector<std::shared_ptr<lt::hft::st
 	{
 		if (_market && _market->login())
 		{
+			if (_standby)
+			{
+				//热备登录失败不影响主会话交易
+				if (_standby->login() && _standby->get_trader_data())
+				{
+					_ctx.set_standby_trader(_standby);
+				}
+				else
+				{
+					LOG_ERROR("runtime_engine standby_trader login failed");
+				}
+			}
 			this->regist_strategy(strategys);
+			//加载数据（对账）之前恢复账本
+			load_ledger();
 			if(_ctx.start_service())
 			{
 				LOG_INFO("runtime_engine run in start_trading");
@@ -114,11 +182,16 @@ void runtime_engine::stop_trading()
 	//std::this_thread::sleep_for(std::chrono::seconds(1));
 	if (_ctx.stop_service())
 	{
+		save_ledger();
 		clear_strategy();
 		if (_trader)
 		{
 			_trader->logout();
 		}
+		if (_standby)
+		{
+			_standby->logout();
+		}
 		if (_market)
 		{
 			_market->logout();
@@ -127,3 +200,50 @@ void runtime_engine::stop_trading()
 	}
 }
 
+void runtime_engine::load_ledger()
+{
+	if (_ledger_path.empty() || !std::filesystem::exists(_ledger_path))
+	{
+		return;
+	}
+	std::ifstream file(_ledger_path, std::ios::binary);
+	if (!file.is_open())
+	{
+		LOG_ERROR("runtime_engine load_ledger cant open file :", _ledger_path);
+		return;
+	}
+	std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	binary_reader reader(data);
+	uint32_t magic = 0, version = 0;
+	std::vector<uint8_t> buffer;
+	reader.read(magic);
+	reader.read(version);
+	reader.read(buffer);
+	if (!reader.good() || magic != LEDGER_MAGIC || version != LEDGER_VERSION || !_ctx.load_ledger(buffer))
+	{
+		LOG_ERROR("runtime_engine load_ledger file not match :", _ledger_path, version);
+		return;
+	}
+	LOG_INFO("runtime_engine load_ledger :", _ledger_path, data.size());
+}
+
+void runtime_engine::save_ledger()const
+{
+	if (_ledger_path.empty())
+	{
+		return;
+	}
+	std::vector<uint8_t> buffer;
+	_ctx.save_ledger(buffer);
+	std::vector<uint8_t> data;
+	binary_writer writer(data);
+	writer.write(LEDGER_MAGIC).write(LEDGER_VERSION).write(buffer);
+	std::ofstream file(_ledger_path, std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		LOG_ERROR("runtime_engine save_ledger cant open file :", _ledger_path);
+		return;
+	}
+	file.write(reinterpret_cast<const char*>(data.data()), data.size());
+	LOG_INFO("runtime_engine save_ledger :", _ledger_path, data.size());
+}
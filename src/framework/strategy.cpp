@@ -23,11 +23,13 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include "strategy.h"
 #include "time_utils.hpp"
 #include "engine.h"
+#include <binary_stream.hpp>
+#include <instrument_table.hpp>
 
 using namespace lt;
 using namespace lt::hft;
 
-strategy::strategy(straid_t id, engine* engine, bool openable, bool closeable):_id(id), _engine(*engine),_openable(openable),_closeable(closeable)
+strategy::strategy(straid_t id, engine* engine, bool openable, bool closeable):_id(id), _engine(*engine),_openable(openable),_closeable(closeable), _ledger_row(0xFFFFFFFFU), _last_slot(nullptr)
 {
 }
 strategy::~strategy()
@@ -37,6 +39,9 @@ strategy::~strategy()
 
 void strategy::init(subscriber& suber)
 {
+	_ledger_row = _engine._ctx.regist_strategy_ledger(this, _id);
+	_code_slot.clear();
+	_last_slot = nullptr;
 	this->on_init(suber);
 }
 
@@ -50,6 +55,46 @@ void strategy::destroy(unsubscriber& unsuber)
 	this->on_destroy(unsuber);
 }
 
+void strategy::save(std::vector<uint8_t>& data)
+{
+	//先保存名下挂单，恢复以后撤单和成交回报还能回到这个策略
+	std::vector<estid_t> estids;
+	_engine._ctx.get_listener_estids(this, estids);
+	binary_writer writer(data);
+	writer.write(static_cast<uint32_t>(estids.size()));
+	for (auto estid : estids)
+	{
+		writer.write(estid);
+	}
+	std::vector<uint8_t> persist;
+	this->on_save(persist);
+	writer.write(persist);
+}
+
+void strategy::load(const std::vector<uint8_t>& data)
+{
+	//恢复的订单要记到这个策略的账本上，先登记
+	_ledger_row = _engine._ctx.regist_strategy_ledger(this, _id);
+	_code_slot.clear();
+	_last_slot = nullptr;
+	binary_reader reader(data);
+	uint32_t estid_count = 0;
+	reader.read(estid_count);
+	for (uint32_t i = 0; i < estid_count && reader.good(); i++)
+	{
+		estid_t estid = INVALID_ESTID;
+		if (reader.read(estid))
+		{
+			_engine._ctx.regist_order_listener(estid, this);
+		}
+	}
+	std::vector<uint8_t> persist;
+	if (reader.read(persist))
+	{
+		this->on_load(persist);
+	}
+}
+
 void strategy::handle_change(const std::vector<std::any>& msg)
 {
 	if (msg.size() >= 3)
@@ -134,6 +179,16 @@ void strategy::cancel_order(estid_t estid)
 }
 
 const position_info& strategy::get_position(const code_t& code) const
+{
+	code_slot& slot = get_code_slot(code);
+	if (slot.ledger_column == INVALID_COLUMN)
+	{
+		slot.ledger_column = _engine._ctx.get_ledger_column(code);
+	}
+	return _engine._ctx.get_strategy_position(_ledger_row, slot.ledger_column);
+}
+
+const position_info& strategy::get_account_position(const code_t& code) const
 {
 	return _engine._ctx.get_position(code);
 }
@@ -154,6 +209,21 @@ void strategy::set_cancel_condition(estid_t estid, std::function<bool(estid_t)>
 	return _engine._ctx.set_cancel_condition(estid, callback);
 }
 
+void strategy::set_cancel_at(estid_t estid, daytm_t time)
+{
+	_engine._ctx.set_cancel_at(estid, time);
+}
+
+void strategy::set_cancel_after(estid_t estid, uint32_t milliseconds)
+{
+	_engine._ctx.set_cancel_after(estid, milliseconds);
+}
+
+void strategy::set_cancel_if_price_moves(estid_t estid, double_t distance)
+{
+	_engine._ctx.set_cancel_if_price_moves(estid, distance);
+}
+
 daytm_t strategy::last_order_time()
 {
 	return _engine._ctx.last_order_time();
@@ -172,13 +242,28 @@ const market_info& strategy::get_market_info(const code_t& code)const
 
 double_t strategy::get_proximate_price(const code_t& code, double_t price)const
 {
-	auto step = _engine._ctx.get_price_step(code);
+	auto step = get_price_step(code);
 	return std::round(price / step) * step;
 }
 
 double_t strategy::get_price_step(const code_t& code)const
 {
-	return _engine._ctx.get_price_step(code);
+	return _engine._ctx.get_instrument(get_code_slot(code).instrument).price_step;
+}
+
+strategy::code_slot& strategy::get_code_slot(const code_t& code)const
+{
+	if (_last_slot == nullptr || !(_last_slot->first == code))
+	{
+		auto it = _code_slot.find(code);
+		if (it == _code_slot.end())
+		{
+			//合约表下标在这里解析一次，账本列号第一次取持仓时再分配
+			it = _code_slot.insert(std::make_pair(code, code_slot{ INVALID_COLUMN, _engine._ctx.get_instrument_index(code) })).first;
+		}
+		_last_slot = &(*it);
+	}
+	return _last_slot->second;
 }
 
 void strategy::regist_order_listener(estid_t estid)
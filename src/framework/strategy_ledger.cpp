@@ -0,0 +1,432 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "strategy_ledger.h"
+#include <log_wapper.hpp>
+#include <binary_stream.hpp>
+#include <algorithm>
+#include <set>
+
+using namespace lt;
+using namespace lt::hft;
+
+namespace
+{
+	//策略账本不一定有对应的持仓（比如没有归属的昨仓被策略平掉），扣减到零为止
+	inline void saturate_sub(uint32_t& value, uint32_t volume)
+	{
+		value = value > volume ? value - volume : 0U;
+	}
+
+	inline void frozen_add(position_cell& cell, uint32_t volume)
+	{
+		cell.frozen = std::min(cell.frozen + volume, cell.postion);
+	}
+
+	/*
+	*	一个方向的持仓按账户持仓重新分配，没有归属的今昨仓放到rest
+	*/
+	void reconcile_side(std::vector<position_info*>& books, position_cell position_info::* today, position_cell position_info::* history, const position_info& account, position_info& rest)
+	{
+		uint32_t history_usable = (account.*history).postion;
+		uint32_t total_usable = (account.*today).postion + history_usable;
+		for (auto book : books)
+		{
+			uint32_t keep = std::min((book->*today).postion + (book->*history).postion, total_usable);
+			total_usable -= keep;
+			uint32_t keep_history = std::min(keep, history_usable);
+			history_usable -= keep_history;
+			(book->*history).postion = keep_history;
+			(book->*today).postion = keep - keep_history;
+		}
+		(rest.*history).postion = history_usable;
+		(rest.*today).postion = total_usable - history_usable;
+	}
+}
+
+uint32_t strategy_ledger::regist_owner(const context::order_listener* owner, uint32_t straid)
+{
+	uint32_t row = INVALID_ROW;
+	auto it = _strategy_row.find(straid);
+	if (it != _strategy_row.end())
+	{
+		row = it->second;
+	}
+	else
+	{
+		row = add_row(straid);
+	}
+	_owner_row[owner] = row;
+	return row;
+}
+
+uint32_t strategy_ledger::get_row(const context::order_listener* owner)const
+{
+	auto it = _owner_row.find(owner);
+	if (it == _owner_row.end())
+	{
+		return INVALID_ROW;
+	}
+	return it->second;
+}
+
+void strategy_ledger::bind_order(estid_t estid, uint32_t row)
+{
+	if (row != INVALID_ROW)
+	{
+		_order_row[estid] = row;
+	}
+}
+
+void strategy_ledger::unbind_order(estid_t estid)
+{
+	_order_row.erase(estid);
+}
+
+void strategy_ledger::entrust(const order_info& order)
+{
+	position_info* book = find_book(order.estid, order.code);
+	if (book == nullptr)
+	{
+		return;
+	}
+	if (order.offset == offset_type::OT_OPEN)
+	{
+		if (order.direction == direction_type::DT_LONG)
+		{
+			book->long_pending += order.total_volume;
+		}
+		else if (order.direction == direction_type::DT_SHORT)
+		{
+			book->short_pending += order.total_volume;
+		}
+	}
+	else if (order.offset == offset_type::OT_CLSTD)
+	{
+		frozen_add(order.direction == direction_type::DT_LONG ? book->today_long : book->today_short, order.total_volume);
+	}
+	else if (order.offset == offset_type::OT_CLOSE)
+	{
+		frozen_add(order.direction == direction_type::DT_LONG ? book->history_long : book->history_short, order.total_volume);
+	}
+}
+
+void strategy_ledger::deal(const order_info& order, uint32_t deal_volume)
+{
+	position_info* book = find_book(order.estid, order.code);
+	if (book == nullptr)
+	{
+		return;
+	}
+	if (order.offset == offset_type::OT_OPEN)
+	{
+		if (order.direction == direction_type::DT_LONG)
+		{
+			book->today_long.postion += deal_volume;
+			saturate_sub(book->long_pending, deal_volume);
+		}
+		else
+		{
+			book->today_short.postion += deal_volume;
+			saturate_sub(book->short_pending, deal_volume);
+		}
+	}
+	else
+	{
+		bool is_today = order.offset == offset_type::OT_CLSTD;
+		position_cell& cell = order.direction == direction_type::DT_LONG ?
+			(is_today ? book->today_long : book->history_long) :
+			(is_today ? book->today_short : book->history_short);
+		saturate_sub(cell.postion, deal_volume);
+		saturate_sub(cell.frozen, deal_volume);
+	}
+}
+
+void strategy_ledger::cancel(const order_info& order, uint32_t cancel_volume)
+{
+	position_info* book = find_book(order.estid, order.code);
+	if (book == nullptr)
+	{
+		return;
+	}
+	if (order.offset == offset_type::OT_OPEN)
+	{
+		saturate_sub(order.direction == direction_type::DT_LONG ? book->long_pending : book->short_pending, cancel_volume);
+	}
+	else if (order.offset == offset_type::OT_CLSTD)
+	{
+		saturate_sub(order.direction == direction_type::DT_LONG ? book->today_long.frozen : book->today_short.frozen, cancel_volume);
+	}
+	else if (order.offset == offset_type::OT_CLOSE)
+	{
+		saturate_sub(order.direction == direction_type::DT_LONG ? book->history_long.frozen : book->history_short.frozen, cancel_volume);
+	}
+}
+
+const position_info& strategy_ledger::get_position(uint32_t row, uint32_t column)const
+{
+	if (row >= _row_strategy.size() || column >= _column_code.size())
+	{
+		return default_position;
+	}
+	return _books[row][column];
+}
+
+position_info strategy_ledger::get_aggregate(const code_t& code)const
+{
+	position_info result(code);
+	auto it = _code_column.find(code);
+	if (it == _code_column.end())
+	{
+		return result;
+	}
+	for (size_t row = 0; row < _row_strategy.size(); row++)
+	{
+		const auto& book = _books[row][it->second];
+		result.today_long.postion += book.today_long.postion;
+		result.today_long.frozen += book.today_long.frozen;
+		result.today_short.postion += book.today_short.postion;
+		result.today_short.frozen += book.today_short.frozen;
+		result.history_long.postion += book.history_long.postion;
+		result.history_long.frozen += book.history_long.frozen;
+		result.history_short.postion += book.history_short.postion;
+		result.history_short.frozen += book.history_short.frozen;
+		result.long_pending += book.long_pending;
+		result.short_pending += book.short_pending;
+	}
+	return result;
+}
+
+void strategy_ledger::reconcile(const std::map<code_t, position_info>& account, const std::vector<order_info>& orders)
+{
+	//账户里有的合约都要有列，先把列补齐再取地址
+	for (const auto& it : account)
+	{
+		get_column(it.first);
+	}
+	for (auto& row_books : _books)
+	{
+		for (auto& book : row_books)
+		{
+			book.today_long.frozen = 0U;
+			book.today_short.frozen = 0U;
+			book.history_long.frozen = 0U;
+			book.history_short.frozen = 0U;
+			book.long_pending = 0U;
+			book.short_pending = 0U;
+		}
+	}
+	_unattributed.clear();
+	const size_t column_count = _column_code.size();
+	std::vector<position_info*> books(_row_strategy.size());
+	for (size_t column = 0; column < column_count; column++)
+	{
+		const code_t& code = _column_code[column];
+		for (size_t row = 0; row < _row_strategy.size(); row++)
+		{
+			books[row] = &_books[row][column];
+		}
+		auto it = account.find(code);
+		const position_info& current = it != account.end() ? it->second : default_position;
+		position_info rest(code);
+		reconcile_side(books, &position_info::today_long, &position_info::history_long, current, rest);
+		reconcile_side(books, &position_info::today_short, &position_info::history_short, current, rest);
+		if (rest.get_total() > 0U)
+		{
+			_unattributed[code] = rest;
+		}
+	}
+	std::map<estid_t, uint32_t> order_row;
+	for (const auto& it : orders)
+	{
+		auto rit = _order_row.find(it.estid);
+		if (rit != _order_row.end())
+		{
+			order_row.insert(*rit);
+		}
+	}
+	_order_row.swap(order_row);
+	for (const auto& it : orders)
+	{
+		entrust(it);
+	}
+	for (const auto& it : account)
+	{
+		const auto& aggregate = get_aggregate(it.first);
+		LOG_INFO("strategy_ledger reconcile : ", it.first.get_id(), it.second.get_long_position(), aggregate.get_long_position(), it.second.get_short_position(), aggregate.get_short_position());
+	}
+}
+
+void strategy_ledger::assign_unattributed()
+{
+	if (_unattributed.empty())
+	{
+		return;
+	}
+	uint32_t row = INVALID_ROW;
+	auto it = _strategy_row.find(_default_owner);
+	if (it != _strategy_row.end())
+	{
+		row = it->second;
+	}
+	else
+	{
+		//没有配置时只有一个策略才能确定归属
+		std::set<uint32_t> owner_rows;
+		for (const auto& owner : _owner_row)
+		{
+			owner_rows.insert(owner.second);
+		}
+		if (owner_rows.size() == 1U)
+		{
+			row = *owner_rows.begin();
+		}
+	}
+	for (const auto& rest : _unattributed)
+	{
+		if (row == INVALID_ROW)
+		{
+			LOG_WARNING("strategy_ledger unattributed position : ", rest.first.get_id(), rest.second.get_long_position(), rest.second.get_short_position());
+			continue;
+		}
+		const uint32_t column = get_column(rest.first);
+		auto& book = _books[row][column];
+		book.today_long.postion += rest.second.today_long.postion;
+		book.today_short.postion += rest.second.today_short.postion;
+		book.history_long.postion += rest.second.history_long.postion;
+		book.history_short.postion += rest.second.history_short.postion;
+		LOG_INFO("strategy_ledger assign unattributed position : ", _row_strategy[row], rest.first.get_id(), rest.second.get_long_position(), rest.second.get_short_position());
+	}
+	if (row != INVALID_ROW)
+	{
+		_unattributed.clear();
+	}
+}
+
+void strategy_ledger::save(std::vector<uint8_t>& data)const
+{
+	binary_writer writer(data);
+	writer.write(static_cast<uint32_t>(_row_strategy.size()));
+	for (size_t row = 0; row < _row_strategy.size(); row++)
+	{
+		std::vector<const position_info*> books;
+		for (const auto& book : _books[row])
+		{
+			if (book.get_total() > 0U)
+			{
+				books.emplace_back(&book);
+			}
+		}
+		writer.write(_row_strategy[row]).write(static_cast<uint32_t>(books.size()));
+		for (auto book : books)
+		{
+			writer.write(*book);
+		}
+	}
+}
+
+bool strategy_ledger::load(const std::vector<uint8_t>& data)
+{
+	strategy_ledger ledger;
+	binary_reader reader(data);
+	uint32_t row_count = 0;
+	reader.read(row_count);
+	for (uint32_t i = 0; i < row_count && reader.good(); i++)
+	{
+		uint32_t straid = 0, book_count = 0;
+		reader.read(straid);
+		reader.read(book_count);
+		uint32_t row = ledger.add_row(straid);
+		for (uint32_t j = 0; j < book_count && reader.good(); j++)
+		{
+			position_info book;
+			if (reader.read(book))
+			{
+				uint32_t column = ledger.get_column(book.id);
+				ledger._books[row][column] = book;
+			}
+		}
+	}
+	if (!reader.good())
+	{
+		LOG_ERROR("strategy_ledger load data broken", data.size());
+		return false;
+	}
+	//策略恢复的时候重新登记
+	_row_strategy.swap(ledger._row_strategy);
+	_strategy_row.swap(ledger._strategy_row);
+	_column_code.swap(ledger._column_code);
+	_code_column.swap(ledger._code_column);
+	_books.swap(ledger._books);
+	_owner_row.clear();
+	_order_row.clear();
+	_unattributed.clear();
+	return true;
+}
+
+uint32_t strategy_ledger::add_row(uint32_t straid)
+{
+	auto it = _strategy_row.find(straid);
+	if (it != _strategy_row.end())
+	{
+		return it->second;
+	}
+	uint32_t row = static_cast<uint32_t>(_row_strategy.size());
+	_row_strategy.emplace_back(straid);
+	_strategy_row[straid] = row;
+	auto& row_books = _books.emplace_back();
+	for (const auto& code : _column_code)
+	{
+		row_books.emplace_back(code);
+	}
+	return row;
+}
+
+uint32_t strategy_ledger::get_column(const code_t& code)
+{
+	auto it = _code_column.find(code);
+	if (it != _code_column.end())
+	{
+		return it->second;
+	}
+	//新合约在每行末尾追加，已有的列号和持仓地址不变
+	const size_t column_count = _column_code.size();
+	for (auto& row_books : _books)
+	{
+		row_books.emplace_back(code);
+	}
+	uint32_t column = static_cast<uint32_t>(column_count);
+	_column_code.emplace_back(code);
+	_code_column[code] = column;
+	return column;
+}
+
+position_info* strategy_ledger::find_book(estid_t estid, const code_t& code)
+{
+	auto it = _order_row.find(estid);
+	if (it == _order_row.end())
+	{
+		return nullptr;
+	}
+	uint32_t column = get_column(code);
+	return &_books[it->second][column];
+}
@@ -0,0 +1,139 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include <define.h>
+#include <define_types.hpp>
+#include <context.h>
+#include <deque>
+
+namespace lt::hft
+{
+	/*
+	*	策略持仓账本
+	*	每个策略自己的持仓按（策略 × 合约）稠密存放，报单、成交、撤单回报按订单归属增量更新；
+	*	账户持仓还是以柜台为准，所有策略账本的汇总只是账户持仓里能归属到策略的部分
+	*	换日加载数据时按账户持仓重新分配各策略的今昨仓，超出账户持仓的部分裁掉；
+	*	账户里没有归属的持仓在策略登记以后交给默认策略（配置的策略，或者只有一个策略时就是它）
+	*	按行号和列号读取是下标访问，合约到列号的映射由调用方缓存（新合约只追加列，列号和持仓引用都不变）
+	*	只在实时线程访问（分片线程通过context加锁访问）
+	*/
+	class strategy_ledger
+	{
+		//行号对应的策略编号
+		std::vector<uint32_t> _row_strategy;
+
+		std::map<uint32_t, uint32_t> _strategy_row;
+
+		//订单监听者（策略）所在行
+		std::map<const context::order_listener*, uint32_t> _owner_row;
+
+		//列号对应的合约
+		std::vector<code_t> _column_code;
+
+		std::map<code_t, uint32_t> _code_column;
+
+		//订单归属的行
+		std::map<estid_t, uint32_t> _order_row;
+
+		//_books[row][column]，新合约在每行末尾追加，已经返回的持仓引用不会失效（load以后重新获取）
+		std::deque<std::deque<position_info>> _books;
+
+		//对账以后没有归属到策略的持仓
+		std::map<code_t, position_info> _unattributed;
+
+		//没有归属的持仓交给这个策略编号
+		uint32_t _default_owner = INVALID_ROW;
+
+	public:
+
+		static constexpr uint32_t INVALID_ROW = 0xFFFFFFFFU;
+
+		void set_default_owner(uint32_t straid)
+		{
+			_default_owner = straid;
+		}
+
+		/*
+		*	登记策略，同一个策略编号总是同一行，返回行号
+		*/
+		uint32_t regist_owner(const context::order_listener* owner, uint32_t straid);
+
+		/*
+		*	owner所在的行，没有登记返回INVALID_ROW
+		*/
+		uint32_t get_row(const context::order_listener* owner)const;
+
+		/*
+		*	订单归属到owner所在的行，owner没有登记的订单不记账
+		*/
+		void bind_order(estid_t estid, const context::order_listener* owner)
+		{
+			bind_order(estid, get_row(owner));
+		}
+
+		void bind_order(estid_t estid, uint32_t row);
+
+		//订单结束
+		void unbind_order(estid_t estid);
+
+		void entrust(const order_info& order);
+
+		void deal(const order_info& order, uint32_t deal_volume);
+
+		void cancel(const order_info& order, uint32_t cancel_volume);
+
+		/*
+		*	合约所在列，没有时追加一列（已有的列号不变，重新加载数据以后列号会变）
+		*/
+		uint32_t get_column(const code_t& code);
+
+		const position_info& get_position(uint32_t row, uint32_t column)const;
+
+		/*
+		*	所有策略在这个合约上的持仓汇总
+		*/
+		position_info get_aggregate(const code_t& code)const;
+
+		/*
+		*	加载数据以后按账户持仓重新分配：先分昨仓再分今仓，按行号顺序分完为止
+		*	挂单清零以后按还在的订单重新记账，不在orders里的订单解除归属
+		*/
+		void reconcile(const std::map<code_t, position_info>& account, const std::vector<order_info>& orders);
+
+		/*
+		*	对账剩下的持仓交给默认策略，没有默认策略时保持没有归属
+		*	在策略登记以后调用
+		*/
+		void assign_unattributed();
+
+		void save(std::vector<uint8_t>& data)const;
+
+		bool load(const std::vector<uint8_t>& data);
+
+	private:
+
+		uint32_t add_row(uint32_t straid);
+
+		position_info* find_book(estid_t estid, const code_t& code);
+	};
+}
@@ -0,0 +1,345 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "strategy_shard.h"
+#include "bar_generator.h"
+#include <engine.h>
+#include <strategy.h>
+#include <process_helper.hpp>
+#include <instrument_table.hpp>
+
+using namespace lt;
+using namespace lt::hft;
+
+code_t subscription::primary_code()const
+{
+	if (!tick.empty())
+	{
+		return tick.front().first;
+	}
+	if (!tape.empty())
+	{
+		return tape.front().first;
+	}
+	if (!bar.empty())
+	{
+		return std::get<0>(bar.front());
+	}
+	return default_code;
+}
+
+void strategy_shard::listener_proxy::on_entrust(const order_info& order)
+{
+	shard_event event;
+	event.type = shard_event_type::SET_ENTRUST;
+	event.listener = _target;
+	event.order = order;
+	_shard.post_event(event);
+}
+
+void strategy_shard::listener_proxy::on_deal(estid_t estid, uint32_t deal_volume)
+{
+	shard_event event;
+	event.type = shard_event_type::SET_DEAL;
+	event.listener = _target;
+	event.estid = estid;
+	event.volume = deal_volume;
+	_shard.post_event(event);
+}
+
+void strategy_shard::listener_proxy::on_trade(estid_t estid, const code_t& code, offset_type offset, direction_type direction, double_t price, uint32_t volume)
+{
+	shard_event event;
+	event.type = shard_event_type::SET_TRADE;
+	event.listener = _target;
+	event.estid = estid;
+	event.code = code;
+	event.offset = offset;
+	event.direction = direction;
+	event.price = price;
+	event.volume = volume;
+	_shard.post_event(event);
+}
+
+void strategy_shard::listener_proxy::on_cancel(estid_t estid, const code_t& code, offset_type offset, direction_type direction, double_t price, uint32_t cancel_volume, uint32_t total_volume)
+{
+	shard_event event;
+	event.type = shard_event_type::SET_CANCEL;
+	event.listener = _target;
+	event.estid = estid;
+	event.code = code;
+	event.offset = offset;
+	event.direction = direction;
+	event.price = price;
+	event.volume = cancel_volume;
+	event.total_volume = total_volume;
+	_shard.post_event(event);
+}
+
+void strategy_shard::listener_proxy::on_error(error_type type, estid_t estid, const error_code error)
+{
+	shard_event event;
+	event.type = shard_event_type::SET_ERROR;
+	event.listener = _target;
+	event.estid = estid;
+	event.error = type;
+	event.code_error = error;
+	_shard.post_event(event);
+}
+
+strategy_shard::strategy_shard(uint32_t index, engine& engine) :
+	_index(index),
+	_engine(engine),
+	_is_runing(false),
+	_is_finished(false),
+	_worker_thread(nullptr)
+{
+}
+
+strategy_shard::~strategy_shard()
+{
+	stop();
+}
+
+void strategy_shard::add_strategy(const std::shared_ptr<strategy>& stra, const subscription& suber)
+{
+	_strategys.emplace_back(stra);
+	context::order_listener* target = stra.get();
+	auto proxy = std::make_shared<listener_proxy>(*this, target);
+	_proxys.emplace_back(proxy);
+	_engine._ctx.set_listener_proxy(target, proxy.get());
+
+	for (const auto& it : suber.tick)
+	{
+		_tick_receiver[it.first].insert(it.second);
+		_codes.insert(it.first);
+	}
+	for (const auto& it : suber.tape)
+	{
+		_tape_receiver[it.first].insert(it.second);
+		_codes.insert(it.first);
+	}
+	for (const auto& it : suber.bar)
+	{
+		const code_t& code = std::get<0>(it);
+		auto generator_iter = _bar_generator.find(code);
+		if (generator_iter == _bar_generator.end())
+		{
+			generator_iter = _bar_generator.insert(std::make_pair(code, std::make_shared<bar_generator>(_engine._ctx.get_instrument(_engine._ctx.get_instrument_index(code)).price_step))).first;
+		}
+		generator_iter->second->add_receiver(std::get<1>(it), std::get<2>(it));
+		_codes.insert(code);
+	}
+}
+
+void strategy_shard::post_tick(const tick_info& tick, const tick_info& prev_tick)
+{
+	if (_codes.find(tick.id) == _codes.end())
+	{
+		return;
+	}
+	shard_event event;
+	event.type = shard_event_type::SET_TICK;
+	event.tick = tick;
+	event.prev_tick = prev_tick;
+	post_event(event);
+}
+
+void strategy_shard::post_change(strategy* target, const std::vector<std::any>& message)
+{
+	shard_event event;
+	event.type = shard_event_type::SET_CHANGE;
+	event.target = target;
+	event.message = message;
+	post_event(event);
+}
+
+void strategy_shard::post_event(const shard_event& event)
+{
+	//前面还有积压的要先排队，保证顺序
+	if (!_pending_event.empty() || !_event_queue.insert(&event))
+	{
+		_pending_event.emplace_back(event);
+	}
+}
+
+void strategy_shard::flush()
+{
+	while (!_pending_event.empty())
+	{
+		if (!_event_queue.insert(&_pending_event.front()))
+		{
+			break;
+		}
+		_pending_event.pop_front();
+	}
+}
+
+void strategy_shard::start()
+{
+	if (_is_runing)
+	{
+		return;
+	}
+	_is_runing = true;
+	_is_finished = false;
+	int16_t bind_cpu_core = _engine._ctx.get_bind_cpu_core();
+	int16_t thread_priority = _engine._ctx.get_thread_priority();
+	_worker_thread = new std::thread([this, bind_cpu_core, thread_priority]()->void {
+		context::bind_worker_thread();
+		if (0 <= bind_cpu_core)
+		{
+			//实时线程后面的核依次分给各个分片
+			uint32_t core = static_cast<uint32_t>(bind_cpu_core) + 1U + _index;
+			if (core < std::thread::hardware_concurrency() && !process_helper::thread_bind_core(core))
+			{
+				LOG_WARNING("shard bind to core failed :", _index, core);
+			}
+		}
+		if (static_cast<int16_t>(PriorityLevel::LowPriority) <= thread_priority && thread_priority <= static_cast<int16_t>(PriorityLevel::RealtimePriority))
+		{
+			if (!process_helper::set_thread_priority(static_cast<PriorityLevel>(thread_priority)))
+			{
+				LOG_WARNING("shard set_thread_priority failed :", _index);
+			}
+		}
+		run();
+	});
+}
+
+void strategy_shard::stop()
+{
+	if (_worker_thread == nullptr)
+	{
+		return;
+	}
+	//分片线程可能正在等待下单结果，等待期间继续替它执行
+	while (!_pending_event.empty())
+	{
+		_engine._ctx.process_request();
+		flush();
+		std::this_thread::yield();
+	}
+	_is_runing = false;
+	while (!_is_finished.load(std::memory_order_acquire))
+	{
+		_engine._ctx.process_request();
+		std::this_thread::yield();
+	}
+	_worker_thread->join();
+	delete _worker_thread;
+	_worker_thread = nullptr;
+}
+
+void strategy_shard::run()
+{
+	shard_event event;
+	while (true)
+	{
+		auto begin = std::chrono::system_clock::now();
+		bool is_runing = _is_runing.load();
+		while (_event_queue.remove(event))
+		{
+			dispatch(event);
+		}
+		if (!is_runing)
+		{
+			//停止前放进队列的事件已经分发完
+			break;
+		}
+		for (auto& it : _strategys)
+		{
+			it->update();
+		}
+		_engine._ctx.check_worker_condition();
+		auto use_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - begin);
+		auto duration = std::chrono::microseconds(_engine._ctx.get_loop_interval());
+		if (use_time < duration)
+		{
+			std::this_thread::sleep_for(duration - use_time);
+		}
+	}
+	_is_finished.store(true, std::memory_order_release);
+}
+
+void strategy_shard::dispatch(const shard_event& event)
+{
+	switch (event.type)
+	{
+	case shard_event_type::SET_TICK:
+	{
+		const tick_info& tick = event.tick;
+		auto tk_it = _tick_receiver.find(tick.id);
+		if (tk_it != _tick_receiver.end())
+		{
+			for (auto tkrc : tk_it->second)
+			{
+				tkrc->on_tick(tick);
+			}
+		}
+		auto tp_it = _tape_receiver.find(tick.id);
+		if (tp_it != _tape_receiver.end() && !tp_it->second.empty())
+		{
+			lt::tape_info deal_info(tick.id, tick.time, tick.price);
+			deal_info.volume_delta = static_cast<uint32_t>(tick.volume - event.prev_tick.volume);
+			deal_info.interest_delta = tick.open_interest - event.prev_tick.open_interest;
+			deal_info.direction = _engine.get_deal_direction(event.prev_tick, tick);
+			for (auto tprc : tp_it->second)
+			{
+				tprc->on_tape(deal_info);
+			}
+		}
+		auto br_it = _bar_generator.find(tick.id);
+		if (br_it != _bar_generator.end())
+		{
+			br_it->second->insert_tick(tick);
+		}
+	}
+	break;
+	case shard_event_type::SET_ENTRUST:
+		event.listener->on_entrust(event.order);
+		break;
+	case shard_event_type::SET_DEAL:
+		event.listener->on_deal(event.estid, event.volume);
+		break;
+	case shard_event_type::SET_TRADE:
+		event.listener->on_trade(event.estid, event.code, event.offset, event.direction, event.price, event.volume);
+		_engine._ctx.remove_condition(event.estid);
+		break;
+	case shard_event_type::SET_CANCEL:
+		event.listener->on_cancel(event.estid, event.code, event.offset, event.direction, event.price, event.volume, event.total_volume);
+		_engine._ctx.remove_condition(event.estid);
+		break;
+	case shard_event_type::SET_ERROR:
+		event.listener->on_error(event.error, event.estid, event.code_error);
+		if (event.error == error_type::ET_PLACE_ORDER)
+		{
+			_engine._ctx.remove_condition(event.estid);
+		}
+		break;
+	case shard_event_type::SET_CHANGE:
+		event.target->handle_change(event.message);
+		break;
+	default:
+		break;
+	}
+}
@@ -0,0 +1,206 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include "define.h"
+#include <engine_types.hpp>
+#include <receiver.h>
+#include <context.h>
+#include <ringbuffer.hpp>
+#include <deque>
+#include <any>
+#include <thread>
+#include <atomic>
+
+namespace lt::hft
+{
+	class engine;
+
+	class strategy;
+
+	class bar_generator;
+
+	/*
+	*	策略在初始化时订阅的接收者，分片模式下用来决定策略分到哪个分片
+	*/
+	struct subscription
+	{
+		std::vector<std::pair<code_t, tick_receiver*>> tick;
+
+		std::vector<std::pair<code_t, tape_receiver*>> tape;
+
+		std::vector<std::tuple<code_t, uint32_t, bar_receiver*>> bar;
+
+		//主合约（第一个订阅的合约），按主合约分片
+		code_t primary_code()const;
+	};
+
+	/***
+	*
+	* 策略分片
+	* 每个分片一个工作线程，运行分到这个分片的策略
+	* 实时线程把行情、订单回报和策略变更消息放进分片的SPSC队列，分片线程依次分发给策略
+	* 策略设置的撤单条件也在分片线程上检查，策略状态只在一个线程上读写
+	* 策略的下单撤单通过context的请求队列交给实时线程执行
+	*/
+	class strategy_shard
+	{
+		enum class shard_event_type
+		{
+			SET_INVALID,
+			SET_TICK,
+			SET_ENTRUST,
+			SET_DEAL,
+			SET_TRADE,
+			SET_CANCEL,
+			SET_ERROR,
+			SET_CHANGE,
+		};
+
+		struct shard_event
+		{
+			shard_event_type type;
+
+			context::order_listener* listener;
+
+			strategy* target;
+
+			std::vector<std::any> message;
+
+			tick_info tick;
+
+			tick_info prev_tick;
+
+			order_info order;
+
+			estid_t estid;
+
+			code_t code;
+
+			offset_type offset;
+
+			direction_type direction;
+
+			double_t price;
+
+			uint32_t volume;
+
+			uint32_t total_volume;
+
+			error_type error;
+
+			error_code code_error;
+
+			shard_event() :type(shard_event_type::SET_INVALID), listener(nullptr), target(nullptr), estid(INVALID_ESTID), offset(offset_type::OT_OPEN), direction(direction_type::DT_LONG), price(.0), volume(0), total_volume(0), error(error_type::ET_OTHER_ERROR), code_error(error_code::EC_Success)
+			{}
+		};
+
+		/*
+		*	订单回报代理，在实时线程上把回报放进分片队列
+		*/
+		class listener_proxy : public context::order_listener
+		{
+			strategy_shard& _shard;
+
+			context::order_listener* _target;
+
+		public:
+
+			listener_proxy(strategy_shard& shard, context::order_listener* target) :_shard(shard), _target(target) {}
+
+			virtual void on_entrust(const order_info& order) override;
+
+			virtual void on_deal(estid_t estid, uint32_t deal_volume) override;
+
+			virtual void on_trade(estid_t estid, const code_t& code, offset_type offset, direction_type direction, double_t price, uint32_t volume) override;
+
+			virtual void on_cancel(estid_t estid, const code_t& code, offset_type offset, direction_type direction, double_t price, uint32_t cancel_volume, uint32_t total_volume) override;
+
+			virtual void on_error(error_type type, estid_t estid, const error_code error) override;
+		};
+
+	private:
+
+		uint32_t _index;
+
+		engine& _engine;
+
+		std::vector<std::shared_ptr<strategy>> _strategys;
+
+		std::vector<std::shared_ptr<listener_proxy>> _proxys;
+
+		std::set<code_t> _codes;
+
+		std::map<code_t, std::set<tick_receiver*>> _tick_receiver;
+
+		std::map<code_t, std::set<tape_receiver*>> _tape_receiver;
+
+		std::map<code_t, std::shared_ptr<bar_generator>> _bar_generator;
+
+		//实时线程写，分片线程读
+		Ringbuffer<shard_event, 1024, false, 64> _event_queue;
+
+		//队列满的时候先放在这里，下一次flush再放进队列（只在实时线程上访问）
+		std::deque<shard_event> _pending_event;
+
+		std::atomic<bool> _is_runing;
+
+		std::atomic<bool> _is_finished;
+
+		std::thread* _worker_thread;
+
+	public:
+
+		strategy_shard(uint32_t index, engine& engine);
+
+		~strategy_shard();
+
+		void add_strategy(const std::shared_ptr<strategy>& stra, const subscription& suber);
+
+		size_t strategy_count()const
+		{
+			return _strategys.size();
+		}
+
+		//实时线程调用，分发行情
+		void post_tick(const tick_info& tick, const tick_info& prev_tick);
+
+		//实时线程调用，分发策略变更消息
+		void post_change(strategy* target, const std::vector<std::any>& message);
+
+		//实时线程调用，把积压的事件放进队列，不阻塞
+		void flush();
+
+		void start();
+
+		//停止并等待线程退出，等待期间实时线程继续处理分片线程的下单请求
+		void stop();
+
+	private:
+
+		void post_event(const shard_event& event);
+
+		void dispatch(const shard_event& event);
+
+		void run();
+	};
+}
@@ -0,0 +1,320 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "stream_recorder.h"
+#include <filesystem>
+#include <thread>
+#include <condition_variable>
+#include <set>
+#include <time_utils.hpp>
+#include <log_wapper.hpp>
+
+using namespace lt;
+using namespace lt::hft;
+
+namespace
+{
+	//二进制记录文件头 "LTRC"
+	constexpr uint32_t RECORD_MAGIC = 0x4352544C;
+	constexpr uint32_t RECORD_VERSION = 1;
+
+	/*
+	*	所有记录器共用的IO线程，有记录器存在时运行
+	*/
+	class record_service
+	{
+		std::mutex _mutex;
+
+		std::condition_variable _condition;
+
+		std::set<stream_recorder*> _recorders;
+
+		std::thread* _thread;
+
+		bool _is_runing;
+
+		record_service() :_thread(nullptr), _is_runing(false) {}
+
+	public:
+
+		static record_service& instance()
+		{
+			static record_service service;
+			return service;
+		}
+
+		void regist(stream_recorder* recorder)
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_recorders.insert(recorder);
+			if (_thread == nullptr)
+			{
+				_is_runing = true;
+				_thread = new std::thread(&record_service::run, this);
+			}
+		}
+
+		//返回以后IO线程不会再访问这个记录器
+		void unregist(stream_recorder* recorder)
+		{
+			std::thread* thread = nullptr;
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_recorders.erase(recorder);
+				if (_recorders.empty() && _thread)
+				{
+					_is_runing = false;
+					thread = _thread;
+					_thread = nullptr;
+				}
+			}
+			if (thread)
+			{
+				_condition.notify_all();
+				thread->join();
+				delete thread;
+			}
+		}
+
+	private:
+
+		void run()
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			while (_is_runing)
+			{
+				_condition.wait_for(lock, std::chrono::milliseconds(100));
+				for (auto it : _recorders)
+				{
+					it->flush();
+				}
+			}
+		}
+	};
+
+	void append_csv(std::string& line, const crossday_record& record)
+	{
+		line.append(std::to_string(record.trading_day)).append(",");
+		line.append(std::to_string(record.statistic.place_order_amount)).append(",");
+		line.append(std::to_string(record.statistic.entrust_amount)).append(",");
+		line.append(std::to_string(record.statistic.trade_amount)).append(",");
+		line.append(std::to_string(record.statistic.cancel_amount)).append(",");
+		line.append(std::to_string(record.statistic.error_amount)).append(",");
+		line.append(std::to_string(record.account.money)).append(",");
+		line.append(std::to_string(record.account.frozen_monery)).append("\n");
+	}
+
+	void append_csv(std::string& line, const order_record& record)
+	{
+		line.append(std::to_string(record.trading_day)).append(",");
+		line.append(std::to_string(record.time)).append(",");
+		line.append(std::to_string(static_cast<uint32_t>(record.event))).append(",");
+		line.append(std::to_string(record.estid)).append(",");
+		line.append(record.code.get_id()).append(",");
+		line.push_back(static_cast<char>(record.offset));
+		line.append(",");
+		line.push_back(static_cast<char>(record.direction));
+		line.append(",");
+		line.append(std::to_string(record.price)).append(",");
+		line.append(std::to_string(record.volume)).append(",");
+		line.append(std::to_string(record.last_volume)).append(",");
+		line.append(std::to_string(record.error)).append("\n");
+	}
+
+	void append_csv(std::string& line, const deal_record& record)
+	{
+		line.append(std::to_string(record.trading_day)).append(",");
+		line.append(std::to_string(record.time)).append(",");
+		line.append(std::to_string(record.estid)).append(",");
+		line.append(record.code.get_id()).append(",");
+		line.push_back(static_cast<char>(record.offset));
+		line.append(",");
+		line.push_back(static_cast<char>(record.direction));
+		line.append(",");
+		line.append(std::to_string(record.price)).append(",");
+		line.append(std::to_string(record.volume)).append("\n");
+	}
+
+	void append_csv(std::string& line, const equity_record& record)
+	{
+		line.append(std::to_string(record.trading_day)).append(",");
+		line.append(std::to_string(record.time)).append(",");
+		line.append(std::to_string(record.account.money)).append(",");
+		line.append(std::to_string(record.account.frozen_monery)).append("\n");
+	}
+
+	//按启动日期分目录
+	std::string make_record_path(const char* basic_path)
+	{
+		time_t now_time = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+		std::string path = std::string(basic_path) + "/" + datetime_to_string(now_time, "%Y-%m-%d");
+		if (!std::filesystem::exists(path))
+		{
+			std::filesystem::create_directories(path);
+		}
+		return path;
+	}
+
+	const char* csv_header(const crossday_record*)
+	{
+		return "trading_day,place_order_amount,entrust_amount,trade_amount,cancel_amount,error_amount,money,frozen\n";
+	}
+
+	const char* csv_header(const order_record*)
+	{
+		return "trading_day,time,event,estid,code,offset,direction,price,volume,last_volume,error\n";
+	}
+
+	const char* csv_header(const deal_record*)
+	{
+		return "trading_day,time,estid,code,offset,direction,price,volume\n";
+	}
+
+	const char* csv_header(const equity_record*)
+	{
+		return "trading_day,time,money,frozen\n";
+	}
+}
+
+template<typename T>
+stream_recorder::record_stream<T>::record_stream(const std::string& basic_path, const char* name, record_format format) :_format(format)
+{
+	_filename = basic_path + "/" + name + (format == record_format::RF_BINARY ? ".bin" : ".csv");
+	_file.open(_filename, std::ios::binary | std::ios::trunc);
+	if (!_file.is_open())
+	{
+		LOG_ERROR("stream_recorder cant open file :", _filename);
+		return;
+	}
+	if (_format == record_format::RF_BINARY)
+	{
+		const uint32_t record_size = static_cast<uint32_t>(sizeof(T));
+		_file.write(reinterpret_cast<const char*>(&RECORD_MAGIC), sizeof(RECORD_MAGIC));
+		_file.write(reinterpret_cast<const char*>(&RECORD_VERSION), sizeof(RECORD_VERSION));
+		_file.write(reinterpret_cast<const char*>(&record_size), sizeof(record_size));
+	}
+	else
+	{
+		_file << csv_header(static_cast<const T*>(nullptr));
+	}
+}
+
+template<typename T>
+void stream_recorder::record_stream<T>::write()
+{
+	if (_writing.empty())
+	{
+		return;
+	}
+	if (_file.is_open())
+	{
+		if (_format == record_format::RF_BINARY)
+		{
+			_file.write(reinterpret_cast<const char*>(_writing.data()), _writing.size() * sizeof(T));
+		}
+		else
+		{
+			_line_buffer.clear();
+			for (const auto& it : _writing)
+			{
+				append_csv(_line_buffer, it);
+			}
+			_file.write(_line_buffer.data(), _line_buffer.size());
+		}
+		_file.flush();
+	}
+	_writing.clear();
+}
+
+stream_recorder::stream_recorder(const char* basic_path, record_format format) :
+	_basic_path(make_record_path(basic_path)),
+	_format(format),
+	_crossday_flow(_basic_path, "crossday_flow", format),
+	_order_flow(_basic_path, "order_flow", format),
+	_deal_flow(_basic_path, "deal_flow", format),
+	_equity_curve(_basic_path, "equity_curve", format)
+{
+	record_service::instance().regist(this);
+}
+
+stream_recorder::~stream_recorder()
+{
+	record_service::instance().unregist(this);
+	flush();
+}
+
+void stream_recorder::record_crossday_flow(uint32_t trading_day, const order_statistic& statistic, const account_info& account)
+{
+	crossday_record record;
+	record.trading_day = trading_day;
+	record.statistic = statistic;
+	record.account = account;
+	std::lock_guard<std::mutex> lock(_mutex);
+	_crossday_flow.push(record);
+}
+
+void stream_recorder::record_order(const order_record& record)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_order_flow.push(record);
+}
+
+void stream_recorder::record_deal(const deal_record& record)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_deal_flow.push(record);
+}
+
+void stream_recorder::record_equity(uint32_t trading_day, daytm_t time, const account_info& account)
+{
+	equity_record record;
+	record.trading_day = trading_day;
+	record.time = time;
+	record.account = account;
+	std::lock_guard<std::mutex> lock(_mutex);
+	_equity_curve.push(record);
+}
+
+void stream_recorder::flush()
+{
+	std::lock_guard<std::mutex> write_lock(_write_mutex);
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_crossday_flow.swap();
+		_order_flow.swap();
+		_deal_flow.swap();
+		_equity_curve.swap();
+	}
+	_crossday_flow.write();
+	_order_flow.write();
+	_deal_flow.write();
+	_equity_curve.write();
+}
+
+record_format stream_recorder::parse_format(const std::string& type)
+{
+	if (type == "binary" || type == "bin")
+	{
+		return record_format::RF_BINARY;
+	}
+	return record_format::RF_CSV;
+}
@@ -0,0 +1,174 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include <define.h>
+#include <shared_types.h>
+#include <fstream>
+#include <mutex>
+
+namespace lt::hft
+{
+	enum class record_format
+	{
+		RF_CSV,
+		RF_BINARY,
+	};
+
+	enum class order_event : uint8_t
+	{
+		OE_ENTRUST,
+		OE_DEAL,
+		OE_TRADE,
+		OE_CANCEL,
+		OE_ERROR,
+	};
+
+	//结算
+	struct crossday_record
+	{
+		uint32_t trading_day;
+		order_statistic statistic;
+		account_info account;
+	};
+
+	//订单生命周期
+	struct order_record
+	{
+		uint32_t trading_day;
+		daytm_t time;
+		order_event event;
+		estid_t estid;
+		code_t code;
+		offset_type offset;
+		direction_type direction;
+		double_t price;
+		//委托：委托数量 成交：本次成交数量 撤单：撤销数量
+		uint32_t volume;
+		//委托：委托数量 成交：剩余数量 撤单：委托数量
+		uint32_t last_volume;
+		uint8_t error;
+	};
+
+	//成交
+	struct deal_record
+	{
+		uint32_t trading_day;
+		daytm_t time;
+		estid_t estid;
+		code_t code;
+		offset_type offset;
+		direction_type direction;
+		double_t price;
+		uint32_t volume;
+	};
+
+	//资金曲线
+	struct equity_record
+	{
+		uint32_t trading_day;
+		daytm_t time;
+		account_info account;
+	};
+
+	/***
+	*
+	* 流式记录器
+	* 记录只追加到内存队列，由后台IO线程批量追加写入文件（所有记录器共用一个IO线程）
+	* 支持CSV和定长二进制两种格式，二进制文件头为 magic、version、记录长度
+	*/
+	class stream_recorder
+	{
+		template<typename T>
+		class record_stream
+		{
+			std::string _filename;
+
+			record_format _format;
+
+			std::ofstream _file;
+
+			std::vector<T> _pending;
+
+			std::vector<T> _writing;
+
+			std::string _line_buffer;
+
+		public:
+
+			record_stream(const std::string& basic_path, const char* name, record_format format);
+
+			inline void push(const T& record)
+			{
+				_pending.emplace_back(record);
+			}
+
+			//持有记录器锁时调用
+			inline void swap()
+			{
+				_writing.swap(_pending);
+			}
+
+			//只在IO线程调用
+			void write();
+		};
+
+	private:
+
+		std::string _basic_path;
+
+		record_format _format;
+
+		std::mutex _mutex;
+
+		//IO线程写文件时持有，保证同一个记录器的批次按顺序落盘
+		std::mutex _write_mutex;
+
+		record_stream<crossday_record> _crossday_flow;
+
+		record_stream<order_record> _order_flow;
+
+		record_stream<deal_record> _deal_flow;
+
+		record_stream<equity_record> _equity_curve;
+
+	public:
+
+		stream_recorder(const char* basic_path, record_format format);
+
+		~stream_recorder();
+
+		//结算表
+		void record_crossday_flow(uint32_t trading_day, const order_statistic& statistic, const account_info& account);
+
+		void record_order(const order_record& record);
+
+		void record_deal(const deal_record& record);
+
+		void record_equity(uint32_t trading_day, daytm_t time, const account_info& account);
+
+		//把队列里的记录写到文件（IO线程定时调用，也可以主动调用）
+		void flush();
+
+		static record_format parse_format(const std::string& type);
+	};
+}
@@ -22,6 +22,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 */
 #include "trading_section.h"
 #include <define.h>
+#include <define_types.hpp>
 #include <rapidcsv.h>
 #include "log_wapper.hpp"
 #include <time_utils.hpp>
@@ -29,80 +30,168 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 using namespace lt;
 using namespace lt::hft ;
 
-trading_section::trading_section(const std::string& config_path)
+namespace
 {
-	LOG_INFO("trading_section init ");
-	_trading_section.clear();
-	rapidcsv::Document config_csv(config_path, rapidcsv::LabelParams(0, 0));
-	for (size_t i = 0; i < config_csv.GetRowCount(); i++)
+	constexpr uint64_t make_cache(daytm_t begin_time, daytm_t end_time, bool in_trading)
 	{
-		//uint32_t is_day = config_csv.GetCell<uint32_t>("day_or_night", i);
-		const std::string& begin_time_str = config_csv.GetCell<std::string>("begin", i);
-		const std::string& end_time_str = config_csv.GetCell<std::string>("end", i);
-		daytm_t begin_time = make_daytm(begin_time_str.c_str(),0U);
-		daytm_t end_time = make_daytm(end_time_str.c_str(),0U);
-		_trading_section.emplace_back(std::make_pair(begin_time, end_time));
-		//LOG_DEBUG("trading_section : ", time_to_string(begin_time), time_to_string(_trading_section[begin_time]));
+		return (static_cast<uint64_t>(begin_time) << 32) | (static_cast<uint64_t>(end_time) << 1) | (in_trading ? 1U : 0U);
 	}
 }
-trading_section::~trading_section()
+
+void trading_section::section_timeline::add_section(daytm_t begin_time, daytm_t end_time)
 {
-	
+	if (begin_time < end_time)
+	{
+		_sections.emplace_back(begin_time, end_time);
+	}
+	else if (end_time < begin_time)
+	{
+		//跨零点拆成两段
+		_sections.emplace_back(begin_time, static_cast<daytm_t>(ONE_DAY_MILLISECONDS));
+		if (end_time > 0)
+		{
+			_sections.emplace_back(0U, end_time);
+		}
+	}
 }
 
-
-bool trading_section::is_in_trading(daytm_t last_time)
+void trading_section::section_timeline::normalize()
 {
-	//LOG_TRACE("trading_section is_in_trading : %s ", datetime_to_string(last_time).c_str());
-
-	for(const auto& it: _trading_section)
+	std::sort(_sections.begin(), _sections.end());
+	std::vector<std::pair<daytm_t, daytm_t>> merged;
+	for (const auto& it : _sections)
 	{
-		if(it.first <= last_time && last_time < it.second)
+		if (!merged.empty() && it.first <= merged.back().second)
+		{
+			merged.back().second = std::max(merged.back().second, it.second);
+		}
+		else
 		{
-			return true ;
+			merged.emplace_back(it);
 		}
 	}
-	return false ;
+	_sections.swap(merged);
+	_cache.store(0, std::memory_order_relaxed);
 }
 
+bool trading_section::section_timeline::is_in_trading(daytm_t last_time)const
+{
+	const uint64_t cache = _cache.load(std::memory_order_relaxed);
+	const daytm_t cache_begin = static_cast<daytm_t>(cache >> 32);
+	const daytm_t cache_end = static_cast<daytm_t>((cache & 0xFFFFFFFFU) >> 1);
+	if (cache_begin <= last_time && last_time < cache_end)
+	{
+		return cache & 1U;
+	}
+	//第一个开始时间大于当前时间的时间段
+	auto it = std::upper_bound(_sections.begin(), _sections.end(), last_time, [](daytm_t tm, const std::pair<daytm_t, daytm_t>& section)->bool {
+		return tm < section.first;
+	});
+	if (it != _sections.begin() && last_time < std::prev(it)->second)
+	{
+		_cache.store(make_cache(std::prev(it)->first, std::prev(it)->second, true), std::memory_order_relaxed);
+		return true;
+	}
+	const daytm_t gap_begin = it != _sections.begin() ? std::prev(it)->second : 0U;
+	const daytm_t gap_end = it != _sections.end() ? it->first : static_cast<daytm_t>(ONE_DAY_MILLISECONDS);
+	_cache.store(make_cache(gap_begin, gap_end, false), std::memory_order_relaxed);
+	return false;
+}
 
-daytm_t trading_section::get_open_time()
+daytm_t trading_section::section_timeline::get_open_time()const
 {
-	auto frist_one = _trading_section.begin();
-	if (frist_one == _trading_section.end())
+	if (_sections.empty())
 	{
 		return 0;
 	}
-	return frist_one->first;
+	return _sections.front().first;
 }
 
-daytm_t trading_section::get_close_time()
+daytm_t trading_section::section_timeline::get_close_time()const
 {
-	auto last_one = _trading_section.rbegin();
-	if(last_one == _trading_section.rend())
+	if (_sections.empty())
 	{
 		return 0;
 	}
-	return last_one->second;
+	return _sections.back().second;
+}
+
+daytm_t trading_section::section_timeline::next_open_time(daytm_t now)const
+{
+	auto it = std::upper_bound(_sections.begin(), _sections.end(), now, [](daytm_t tm, const std::pair<daytm_t, daytm_t>& section)->bool {
+		return tm < section.first;
+	});
+	if (it == _sections.end())
+	{
+		return 0U;
+	}
+	return it->first;
 }
 
-daytm_t trading_section::next_open_time(daytm_t now)
+trading_section::trading_section(const std::string& config_path)
 {
-	size_t i = 0;
-	for(;i<_trading_section.size();i++)
+	LOG_INFO("trading_section init ");
+	rapidcsv::Document config_csv(config_path, rapidcsv::LabelParams(0, 0));
+	const bool has_product = config_csv.GetColumnIdx("product") >= 0;
+	for (size_t i = 0; i < config_csv.GetRowCount(); i++)
 	{
-		if(_trading_section[i].first <= now)
+		//uint32_t is_day = config_csv.GetCell<uint32_t>("day_or_night", i);
+		const std::string& begin_time_str = config_csv.GetCell<std::string>("begin", i);
+		const std::string& end_time_str = config_csv.GetCell<std::string>("end", i);
+		daytm_t begin_time = make_daytm(begin_time_str.c_str(),0U);
+		daytm_t end_time = make_daytm(end_time_str.c_str(),0U);
+		const std::string product = has_product ? config_csv.GetCell<std::string>("product", i) : std::string();
+		if (product.empty())
 		{
-			break;
+			_default_section.add_section(begin_time, end_time);
 		}
+		else
+		{
+			_product_section[product].add_section(begin_time, end_time);
+		}
+	}
+	_default_section.normalize();
+	for (auto& it : _product_section)
+	{
+		it.second.normalize();
 	}
-	for (size_t j=i; j<i + _trading_section.size(); j++)
+}
+trading_section::~trading_section()
+{
+	
+}
+
+
+bool trading_section::is_in_trading(daytm_t last_time)const
+{
+	return _default_section.is_in_trading(last_time);
+}
+
+bool trading_section::is_in_trading(const code_t& code, daytm_t last_time)const
+{
+	if (!_product_section.empty())
 	{
-		auto iter = _trading_section[j % _trading_section.size()];
-		if(now < iter.first)
+		auto it = _product_section.find(code.get_cmdtid());
+		if (it != _product_section.end())
 		{
-			return iter.first;
+			return it->second.is_in_trading(last_time);
 		}
 	}
-	return 0U;
-}
\ No newline at end of file
+	return _default_section.is_in_trading(last_time);
+}
+
+
+daytm_t trading_section::get_open_time()const
+{
+	return _default_section.get_open_time();
+}
+
+daytm_t trading_section::get_close_time()const
+{
+	return _default_section.get_close_time();
+}
+
+daytm_t trading_section::next_open_time(daytm_t now)const
+{
+	return _default_section.next_open_time(now);
+}
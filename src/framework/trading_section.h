@@ -20,15 +20,49 @@ OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHE
 IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
 OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
-
 #pragma once
 #include <define.h>
+#include <atomic>
 
 namespace lt::hft
 {
-	
+	/*
+	*	交易时间段
+	*	配置里的时间段在加载时排序、合并，跨零点的时间段拆成两段；
+	*	查询时先看缓存的当前区间（在区间内或者在两个时间段之间的空档），大多数情况一次比较就能返回
+	*	section.csv 可以有 product 列（品种代码，比如 rb），为空的行是默认时间段
+	*/
 	class trading_section
 	{
+		class section_timeline
+		{
+			//排好序、不重叠的半开区间 [begin, end)
+			std::vector<std::pair<daytm_t, daytm_t>> _sections;
+
+			//缓存的区间：高32位区间开始，低32位区间结束（左移1位）和是否在交易时间（最低位）
+			mutable std::atomic<uint64_t> _cache;
+
+		public:
+
+			section_timeline() :_cache(0) {}
+
+			void add_section(daytm_t begin_time, daytm_t end_time);
+
+			void normalize();
+
+			bool is_in_trading(daytm_t last_time)const;
+
+			bool empty()const
+			{
+				return _sections.empty();
+			}
+
+			daytm_t get_open_time()const;
+
+			daytm_t get_close_time()const;
+
+			daytm_t next_open_time(daytm_t now)const;
+		};
 
 	public:
 
@@ -36,20 +70,25 @@ namespace lt::hft
 		virtual ~trading_section();
 
 	private:
-		std::vector<std::pair<daytm_t, daytm_t>> _trading_section;
+
+		section_timeline _default_section;
+
+		std::map<std::string, section_timeline> _product_section;
 
 	public:
 
-		bool is_in_trading(daytm_t last_time);
+		bool is_in_trading(daytm_t last_time)const;
+
+		//按品种时间段判断，没有单独配置的品种使用默认时间段
+		bool is_in_trading(const code_t& code, daytm_t last_time)const;
 
-		daytm_t get_open_time();
+		daytm_t get_open_time()const;
 
-		daytm_t get_close_time();
+		daytm_t get_close_time()const;
 
-		daytm_t next_open_time(daytm_t now);
+		daytm_t next_open_time(daytm_t now)const;
 
 	};
 
 
 }
-
@@ -0,0 +1,147 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <type_traits>
+
+namespace lt
+{
+	/*
+	 *	紧凑的二进制序列化，按内存布局直接写入，只用于同一程序读写的快照和缓存文件
+	 */
+	class binary_writer
+	{
+
+	private:
+
+		std::vector<uint8_t>& _buffer;
+
+	public:
+
+		binary_writer(std::vector<uint8_t>& buffer) :_buffer(buffer) {}
+
+		binary_writer& write(const void* data, size_t size)
+		{
+			const uint8_t* begin = static_cast<const uint8_t*>(data);
+			_buffer.insert(_buffer.end(), begin, begin + size);
+			return *this;
+		}
+
+		template<typename T>
+		binary_writer& write(const T& value)
+		{
+			static_assert(std::is_standard_layout<T>::value, "binary_writer only support standard layout type");
+			return write(&value, sizeof(T));
+		}
+
+		binary_writer& write(const std::string& value)
+		{
+			write(static_cast<uint32_t>(value.size()));
+			return write(value.data(), value.size());
+		}
+
+		binary_writer& write(const std::vector<uint8_t>& value)
+		{
+			write(static_cast<uint32_t>(value.size()));
+			return write(value.data(), value.size());
+		}
+	};
+
+	class binary_reader
+	{
+
+	private:
+
+		const uint8_t* _data;
+
+		size_t _size;
+
+		size_t _offset;
+
+		bool _good;
+
+	public:
+
+		binary_reader(const uint8_t* data, size_t size) :_data(data), _size(size), _offset(0), _good(true) {}
+
+		binary_reader(const std::vector<uint8_t>& data) :binary_reader(data.data(), data.size()) {}
+
+		bool read(void* data, size_t size)
+		{
+			if (!_good || _offset + size > _size)
+			{
+				_good = false;
+				return false;
+			}
+			std::memcpy(data, _data + _offset, size);
+			_offset += size;
+			return true;
+		}
+
+		template<typename T>
+		bool read(T& value)
+		{
+			static_assert(std::is_standard_layout<T>::value, "binary_reader only support standard layout type");
+			return read(&value, sizeof(T));
+		}
+
+		bool read(std::string& value)
+		{
+			uint32_t size = 0;
+			if (!read(size) || _offset + size > _size)
+			{
+				_good = false;
+				return false;
+			}
+			value.assign(reinterpret_cast<const char*>(_data + _offset), size);
+			_offset += size;
+			return true;
+		}
+
+		bool read(std::vector<uint8_t>& value)
+		{
+			uint32_t size = 0;
+			if (!read(size) || _offset + size > _size)
+			{
+				_good = false;
+				return false;
+			}
+			value.assign(_data + _offset, _data + _offset + size);
+			_offset += size;
+			return true;
+		}
+
+		bool good()const
+		{
+			return _good;
+		}
+
+		bool eof()const
+		{
+			return _offset >= _size;
+		}
+	};
+}
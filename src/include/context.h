@@ -24,18 +24,78 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include <log_wapper.hpp>
 #include <define_types.hpp>
 #include <params.hpp>
+#include <spin_mutex.hpp>
+#include <mpsc_queue.hpp>
+#include <seqlock.hpp>
+#include <shared_types.h>
+#include <atomic>
 
 namespace lt{
 
 	class market_api;
 
 	class trader_api;
+
+	class actual_trader;
+
+	class instrument_table;
+
+	struct instrument_info;
 }
 
 namespace lt::hft
 {
 	typedef std::function<bool(const code_t& code, offset_type offset, direction_type direction, uint32_t count, double_t price, order_flag flag)> filter_function;
 
+	/*
+	*	持仓、订单、资金和统计的快照，给监控、界面等其他线程读取
+	*	固定容量，超出容量的持仓和订单不进入快照（is_truncated 为 true）
+	*/
+	struct context_snapshot
+	{
+		static constexpr size_t MAX_POSITION = 64;
+
+		static constexpr size_t MAX_ORDER = 256;
+
+		struct order_item
+		{
+			estid_t			estid;
+
+			code_t			code;
+
+			uint32_t		total_volume;
+
+			uint32_t		last_volume;
+
+			daytm_t			create_time;
+
+			offset_type		offset;
+
+			direction_type	direction;
+
+			double_t		price;
+		};
+
+		uint32_t trading_day;
+
+		daytm_t last_time;
+
+		account_info account;
+
+		//当前交易日所有合约汇总
+		order_statistic statistic;
+
+		bool is_truncated;
+
+		size_t position_size;
+
+		position_info position[MAX_POSITION];
+
+		size_t order_size;
+
+		order_item order[MAX_ORDER];
+	};
+
 	class context
 	{
 
@@ -71,6 +131,38 @@ namespace lt::hft
 
 		virtual ~context();
 
+		/*
+		*	分片线程提交的下单/撤单请求，由实时线程执行以后通知提交线程
+		*/
+		struct order_request
+		{
+			bool is_cancel;
+
+			order_listener* listener;
+
+			offset_type offset;
+
+			direction_type direction;
+
+			code_t code;
+
+			uint32_t count;
+
+			double_t price;
+
+			order_flag flag;
+
+			//撤单时为输入，下单时为结果
+			estid_t estid;
+
+			bool result;
+
+			std::atomic<bool> finished;
+
+			order_request() :is_cancel(false), listener(nullptr), offset(offset_type::OT_OPEN), direction(direction_type::DT_LONG), count(0), price(.0), flag(order_flag::OF_NOR), estid(INVALID_ESTID), result(false), finished(false)
+			{}
+		};
+
 	private:
 
 		context(const context&) = delete;
@@ -84,8 +176,8 @@ namespace lt::hft
 	private:
 
 		bool _is_runing;
-		// (实时)
-		std::function<void(const tick_info&)> _tick_callback;
+		// (实时) 参数为当前tick和同一合约的上一个tick
+		std::function<void(const tick_info&, const tick_info&)> _tick_callback;
 
 		lifecycle_listener* _lifecycle_listener;
 
@@ -119,18 +211,55 @@ namespace lt::hft
 
 		trader_api* _trader;
 
+		//热备交易会话，_trader断线时在实时线程里互换，不重新加载数据
+		actual_trader* _standby_trader;
+
 		market_api* _market;
 
-		std::shared_ptr<class price_step> _ps_config;
+		std::shared_ptr<instrument_table> _instrument_table;
 
 		std::map<estid_t, std::function<bool(estid_t)>> _need_check_condition;
 
+		//定时和价格偏离撤单，只在到期或者对应合约来行情时处理
+		std::shared_ptr<class cancel_scheduler> _cancel_scheduler;
+
+		//按策略归属的持仓账本，_position_info是账户持仓
+		std::shared_ptr<class strategy_ledger> _strategy_ledger;
+
 		filter_function _filter_function;
 
+		//报单流控（[control]里配置，不配置不限制）
+		std::shared_ptr<class flow_control> _flow_control;
+
+		//下单前风控检查（[control]里配置，不配置不检查）
+		std::shared_ptr<class risk_control> _risk_control;
+
+		//策略分片数量，0表示所有策略都在实时线程上运行
+		uint32_t _shard_count;
+
+		//状态锁，实时线程在update中持有，分片线程访问上下文时持有
+		mutable spin_mutex _mutex;
+
+		//分片线程提交的下单/撤单请求
+		mpsc::mpsc_queue<order_request> _order_request;
+
+		//订单回报代理，分片模式下回报先交给代理再转到策略所在的分片线程
+		std::map<const order_listener*, order_listener*> _listener_proxy;
+
+		//持仓订单有变化，下一次update结束时发布快照
+		bool _snapshot_dirty;
+
+		seqlock_buffer<context_snapshot> _snapshot;
+
 	public:
 
 		void init(const params& control_config, const params& include_config, market_api* market, trader_api* trader, bool reset_trading_day = false);
 
+		/*
+		*	设置热备交易会话（必须是已经登录的actual_trader，_trader也必须是actual_trader）
+		*/
+		void set_standby_trader(actual_trader* standby);
+
 		/*加载数据*/
 		bool load_data();
 
@@ -147,13 +276,35 @@ namespace lt::hft
 
 		const position_info& get_position(const code_t& code)const;
 
+		/*
+		*	登记策略持仓账本，返回账本行号（同一个策略编号总是同一行）
+		*	登记以后这个监听者下的订单按回报记到策略自己的账本上
+		*/
+		uint32_t regist_strategy_ledger(const order_listener* listener, uint32_t straid);
+
+		/*
+		*	合约在账本里的列号，调用方缓存以后按行号列号直接读取
+		*	列号在load_ledger/load_snapshot以后失效，需要重新获取
+		*/
+		uint32_t get_ledger_column(const code_t& code);
+
+		//策略自己的持仓（ledger_row是regist_strategy_ledger返回的行号）
+		const position_info& get_strategy_position(uint32_t ledger_row, uint32_t ledger_column)const;
+
+		/*
+		*	策略账本持久化（实盘重启时恢复持仓归属），load_ledger要在start_service之前调用
+		*/
+		void save_ledger(std::vector<uint8_t>& data)const;
+
+		bool load_ledger(const std::vector<uint8_t>& data);
+
 		const order_info& get_order(estid_t estid)const;
 
 		void find_orders(std::vector<order_info>& order_result, std::function<bool(const order_info&)> func) const;
 
 		uint32_t get_total_position() const;
 
-		void subscribe(const std::set<code_t>& tick_data, std::function<void(const tick_info&)> tick_callback);
+		void subscribe(const std::set<code_t>& tick_data, std::function<void(const tick_info&, const tick_info&)> tick_callback);
 
 		void unsubscribe(const std::set<code_t>& tick_data);
 
@@ -168,6 +319,9 @@ namespace lt::hft
 		daytm_t get_close_time()const;
 
 		bool is_in_trading()const;
+
+		//按品种交易时间段判断
+		bool is_in_trading(const code_t& code)const;
 		//
 		const market_info& get_market_info(const code_t& id)const;
 
@@ -177,8 +331,29 @@ namespace lt::hft
 
 		order_statistic get_all_statistic()const;
 
+		/*
+		*	读取最近一次发布的快照，任意线程都可以调用，不会阻塞实时线程
+		*	返回快照版本，版本没变说明内容没变（0表示还没有发布过）
+		*/
+		uint64_t read_snapshot(context_snapshot& result)const;
+
 		void set_cancel_condition(estid_t estid, std::function<bool(estid_t)> callback);
 
+		/*
+		*	行情时间超过time以后撤单
+		*/
+		void set_cancel_at(estid_t estid, daytm_t time);
+
+		/*
+		*	从现在开始（行情时间）超过milliseconds毫秒以后撤单
+		*/
+		void set_cancel_after(estid_t estid, uint32_t milliseconds);
+
+		/*
+		*	最新价偏离委托价超过distance时撤单
+		*/
+		void set_cancel_if_price_moves(estid_t estid, double_t distance);
+
 		void clear_condition();
 
 		void remove_condition(estid_t estid);
@@ -187,14 +362,100 @@ namespace lt::hft
 
 		double_t get_price_step(const code_t& code)const;
 
+		//合约静态信息，没有配置返回nullptr
+		const instrument_info* get_instrument(const code_t& code)const;
+
+		/*
+		*	解析合约表下标，没有配置时提示并返回INVALID_INSTRUMENT_INDEX
+		*	热路径上由调用方缓存下标，之后按下标读取
+		*/
+		instrument_index get_instrument_index(const code_t& code)const;
+
+		//按下标读取合约信息，无效下标返回default_instrument
+		const instrument_info& get_instrument(instrument_index index)const;
+
 		void regist_order_listener(estid_t estid, order_listener* listener);
 
+		//获取监听者名下还没有结束的订单（交易日快照用）
+		void get_listener_estids(const order_listener* listener, std::vector<estid_t>& result)const;
+
+		//交易日快照，保存每个合约的上一个tick，恢复以后第一个tick不会被丢掉
+		void save_snapshot(std::vector<uint8_t>& data)const;
+
+		bool load_snapshot(const std::vector<uint8_t>& data);
+
+		uint32_t get_shard_count()const
+		{
+			return _shard_count;
+		}
+
+		int16_t get_bind_cpu_core()const
+		{
+			return _bind_cpu_core;
+		}
+
+		int16_t get_thread_priority()const
+		{
+			return _thread_priority;
+		}
+
+		uint32_t get_loop_interval()const
+		{
+			return _loop_interval;
+		}
+
+		/*
+		*	设置订单回报代理，之后这个监听者的订单回报都交给代理
+		*/
+		void set_listener_proxy(const order_listener* listener, order_listener* proxy);
+
+		void clear_listener_proxy();
+
+		/*
+		*	执行分片线程提交的下单/撤单请求（实时线程在update以外调用，比如等待分片线程退出时）
+		*/
+		void process_request();
+
+		/*
+		*	把当前线程标记为分片线程
+		*	分片线程上下单撤单会提交给实时线程执行，读取状态会加锁并返回线程内的副本
+		*/
+		static void bind_worker_thread();
+
+		/*
+		*	分片线程调用，检查当前分片设置的撤单条件
+		*/
+		void check_worker_condition();
+
 	private:
 
 		void check_condition();
 
+		order_listener* get_listener_proxy(order_listener* listener)const;
+
+		//调用前需要持有_mutex
+		void handle_request();
+
+		//实时线程在update结束时调用，每次update最多发布一次
+		void publish_snapshot();
+
 		void check_crossday();
 
+		//补发流控延迟的撤单
+		void process_deferred_cancel();
+
+		//流控窗口恢复以后通知被拒的策略
+		void process_deferred_place();
+
+		//撤单条件满足，撤单失败时交给通用条件重试
+		void fire_cancel(estid_t estid);
+
+		//订单回报绑定到当前的交易会话
+		void bind_trader_event();
+
+		//_trader不可用且热备可用时互换，调用前需要持有_mutex
+		void check_failover();
+
 		void handle_entrust(const std::vector<std::any>& param);
 
 		void handle_deal(const std::vector<std::any>& param);
@@ -205,6 +466,10 @@ namespace lt::hft
 
 		void handle_tick(const std::vector<std::any>& param);
 
+		void handle_tick_frame(const std::vector<std::any>& param);
+
+		void process_tick(const tick_info& last_tick, const tick_extend& extend_data);
+
 		void handle_error(const std::vector<std::any>& param);
 
 		void calculate_position(const code_t& code, direction_type dir_type, offset_type offset_type, uint32_t volume, double_t price);
@@ -88,6 +88,13 @@ namespace lt{
 
 	struct market_info;
 
+	struct instrument_info;
+
+	//合约信息表里的稠密下标
+	typedef uint32_t instrument_index;
+
+	constexpr instrument_index INVALID_INSTRUMENT_INDEX = 0xFFFFFFFFU;
+
 	enum class order_flag;
 
 	enum class offset_type;
@@ -24,6 +24,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include "define.h"
 #include <ostream>
 #include <utility>
+#include "orderflow.hpp"
 
 constexpr size_t CODE_DATA_LEN = 20;
 //合约id起始位置（rb2010）
@@ -90,10 +91,8 @@ namespace lt
 			std::memset(&_data, 0, sizeof(_data));
 		}
 
-		code_t(const code_t& obj)
-		{
-			std::memcpy(_data, obj._data, CODE_DATA_LEN);
-		}
+		//按字节拷贝，保持可平凡复制（快照、共享内存里按字节读写）
+		code_t(const code_t& obj) = default;
 
 		code_t(const char* id, const char* excg_id)
 		{
@@ -285,6 +284,7 @@ namespace lt
 		EC_PositionNotEnough = 30U, //仓位不足
 		EC_MarginNotEnough = 31U,		//保证金不足
 		EC_StateNotReady = 32, //状态不对
+		EC_FlowControl = 40U, //流控拒绝，窗口恢复以后通知，收到可以重新下单
 	};
 
 	struct position_cell
@@ -507,6 +507,171 @@ namespace lt
 		ET_OTHER_ERROR
 	};
 
+	/*
+	*	交易日成交量分布
+	*	按价格相对起始价（跌停价）的跳数索引，poc和vwap随成交增量更新
+	*/
+	struct volume_profile
+	{
+	private:
+
+		double_t _origin;
+
+		double_t _step;
+
+		bool _inited;
+
+		std::vector<uint32_t> _volume;
+
+		size_t _poc_index;
+
+		uint64_t _total_volume;
+
+		double_t _total_amount;
+
+		//没有最小变动价位时无法分档，poc退化为最新成交价
+		double_t _last_price;
+
+		//价值区域缓存，成交量没有变化时直接返回
+		mutable uint64_t _area_volume;
+		mutable double_t _area_ratio;
+		mutable size_t _area_low;
+		mutable size_t _area_high;
+
+	public:
+
+		volume_profile() :_origin(.0), _step(.0), _inited(false), _poc_index(0), _total_volume(0), _total_amount(.0), _last_price(.0), _area_volume(0), _area_ratio(.0), _area_low(0), _area_high(0)
+		{}
+
+		bool invalid()const
+		{
+			return !_inited;
+		}
+
+		/*
+		*	@origin	起始价格（一般为跌停价）
+		*	@upper	最高价格（一般为涨停价），用于预先分配档位，为0时按需扩展
+		*	@step	最小变动价位
+		*/
+		void init(double_t origin, double_t upper, double_t step)
+		{
+			clear();
+			_origin = origin;
+			_step = step;
+			_inited = true;
+			if (_step > .0 && upper > origin)
+			{
+				_volume.reserve(static_cast<size_t>(std::round((upper - origin) / _step)) + 1);
+			}
+		}
+
+		void add(double_t price, uint32_t volume)
+		{
+			if (volume == 0)
+			{
+				return;
+			}
+			if (_step == .0)
+			{
+				_last_price = price;
+				_total_volume += volume;
+				_total_amount += price * volume;
+				return;
+			}
+			int64_t offset = static_cast<int64_t>(std::round((price - _origin) / _step));
+			if (offset < 0)
+			{
+				//低于起始价，向前扩展
+				const size_t expand = static_cast<size_t>(-offset);
+				_volume.insert(_volume.begin(), expand, 0);
+				_origin -= expand * _step;
+				_poc_index += expand;
+				_area_volume = 0;
+				offset = 0;
+			}
+			const size_t index = static_cast<size_t>(offset);
+			if (index >= _volume.size())
+			{
+				_volume.resize(index + 1, 0);
+			}
+			_volume[index] += volume;
+			if (_total_volume == 0 || _volume[index] > _volume[_poc_index])
+			{
+				_poc_index = index;
+			}
+			_total_volume += volume;
+			_total_amount += price * volume;
+		}
+
+		uint64_t get_total_volume()const
+		{
+			return _total_volume;
+		}
+
+		double_t get_price(size_t index)const
+		{
+			return _origin + index * _step;
+		}
+
+		//最大成交量的价格
+		double_t get_poc(double_t default_price)const
+		{
+			if (_total_volume == 0)
+			{
+				return default_price;
+			}
+			if (_step == .0)
+			{
+				return _last_price;
+			}
+			return get_price(_poc_index);
+		}
+
+		//成交量加权均价
+		double_t get_vwap(double_t default_price)const
+		{
+			if (_total_volume == 0)
+			{
+				return default_price;
+			}
+			return _total_amount / _total_volume;
+		}
+
+		/*
+		*	价值区域
+		*	@ratio 覆盖成交量的比例，一般是0.7
+		*/
+		bool get_value_area(double_t ratio, double_t& val, double_t& vah)const
+		{
+			if (_total_volume == 0 || _volume.empty())
+			{
+				return false;
+			}
+			if (_area_volume != _total_volume || _area_ratio != ratio)
+			{
+				if (!orderflow::value_area(_volume.data(), _volume.size(), _poc_index, ratio, _area_low, _area_high))
+				{
+					return false;
+				}
+				_area_volume = _total_volume;
+				_area_ratio = ratio;
+			}
+			val = get_price(_area_low);
+			vah = get_price(_area_high);
+			return true;
+		}
+
+		void clear()
+		{
+			_volume.clear();
+			_poc_index = 0;
+			_total_volume = 0;
+			_total_amount = .0;
+			_last_price = .0;
+			_area_volume = 0;
+		}
+	};
+
 	struct market_info
 	{
 		code_t code;
@@ -527,10 +692,14 @@ namespace lt
 
 		uint32_t trading_day;
 
-		std::map<double_t, uint32_t> volume_distribution;
+		//成交量分布
+		volume_profile volume_distribution;
 
 		tick_info last_tick_info;
 
+		//合约静态信息，收到第一个tick时从合约信息表解析一次（没有配置为nullptr）
+		const instrument_info* instrument;
+
 		market_info()
 			:open_price(.0),
 			close_price(.0),
@@ -539,21 +708,22 @@ namespace lt
 			low_price(.0),
 			max_price(.0),
 			min_price(.0),
-			trading_day(0)
+			trading_day(0),
+			instrument(nullptr)
 		{}
 		double_t get_control_price()const
 		{
-			double_t control_price = last_tick_info.price;
-			uint32_t max_volume = 0;
-			for (const auto& it : volume_distribution)
-			{
-				if (it.second > max_volume)
-				{
-					max_volume = it.second;
-					control_price = it.first;
-				}
-			}
-			return control_price;
+			return volume_distribution.get_poc(last_tick_info.price);
+		}
+
+		double_t get_vwap()const
+		{
+			return volume_distribution.get_vwap(last_tick_info.price);
+		}
+
+		bool get_value_area(double_t ratio, double_t& val, double_t& vah)const
+		{
+			return volume_distribution.get_value_area(ratio, val, vah);
 		}
 
 		double_t middle_price()const
@@ -44,17 +44,25 @@ namespace lt::hft
 
 	class engine;
 
+	struct subscription;
+
+	class strategy_shard;
+
 	class subscriber
 	{
 	
 	private:
 	
 		engine& _engine;
+
+		//不为空时只记录订阅，由分片自己分发
+		subscription* _record;
 		
 	public:
 	
-		subscriber(engine& engine) :
-			_engine(engine)
+		subscriber(engine& engine, subscription* record = nullptr) :
+			_engine(engine),
+			_record(record)
 		{}
 
 		void regist_tick_receiver(const code_t& code, tick_receiver* receiver);
@@ -83,6 +91,7 @@ namespace lt::hft
 		friend subscriber;
 		friend unsubscriber;
 		friend strategy;
+		friend strategy_shard;
 
 	private: 
 
@@ -101,6 +110,13 @@ namespace lt::hft
 
 		void clear_strategy();
 
+	private:
+
+		/***
+		* 按主合约把策略分到各个分片，同一个合约的策略尽量在同一个分片
+		*/
+		void init_shard(uint32_t shard_count);
+
 	public:
 
 		engine();
@@ -125,6 +141,15 @@ namespace lt::hft
 			return _ctx.get_order_statistic(code);
 		}
 
+		/**
+		* 获取当前交易日所有合约的订单统计汇总
+		*	跨交易日会被清空
+		*/
+		inline order_statistic get_all_statistic()const
+		{
+			return _ctx.get_all_statistic();
+		}
+
 		/**
 		* 获取最后一次下单时间
 		*	跨交易日返回0
@@ -160,6 +185,15 @@ namespace lt::hft
 			return _ctx.get_market_info(code);
 		}
 
+		/*
+		* 读取持仓、订单、资金快照（可以在监控线程调用，不阻塞交易线程）
+		*	快照在每次逻辑更新结束时有变化才发布，返回快照版本
+		*/
+		inline uint64_t get_snapshot(context_snapshot& result)const
+		{
+			return _ctx.read_snapshot(result);
+		}
+
 		/*
 		* 发送消息
 		*/
@@ -198,11 +232,14 @@ namespace lt::hft
 
 		std::map<code_t, std::set<tape_receiver*>> _tape_receiver;
 
-		std::map<code_t, std::map<uint32_t, std::shared_ptr<class bar_generator>>> _bar_generator;
+		std::map<code_t, std::shared_ptr<class bar_generator>> _bar_generator;
 
 		std::map<code_t,uint32_t> _tick_reference_count ;
 
-		std::map<estid_t, straid_t> _estid_to_strategy;
+		std::vector<std::shared_ptr<strategy_shard>> _shards;
+
+		//分片模式下策略所在的分片
+		std::map<straid_t, std::shared_ptr<strategy_shard>> _strategy_shard;
 
 	};
 }
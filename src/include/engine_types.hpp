@@ -22,6 +22,9 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 */
 #pragma once
 #include <define_types.hpp>
+#include <orderflow.hpp>
+#include <cmath>
+#include <vector>
 namespace lt
 {
 	enum class deal_direction
@@ -127,28 +130,97 @@ namespace lt
 
 		double_t price_step; //价格单元
 
-		//订单流中的明细
-		std::map<double_t, uint32_t> price_buy_volume;
-		std::map<double_t, uint32_t> price_sell_volume;
+		//订单流中的明细（按价格跳数索引的稠密数组）
+		//下标0对应的价格为 open + ladder_lower * price_step，价格低于已有范围时向前扩展
+		int32_t ladder_lower;
+		std::vector<uint32_t> ladder_volume;
+		std::vector<uint32_t> ladder_buy;
+		std::vector<uint32_t> ladder_sell;
+
+		//价格相对开盘价的跳数
+		int32_t get_price_offset(double_t price)const
+		{
+			return static_cast<int32_t>(std::round((price - open) / price_step));
+		}
+
+		double_t get_ladder_price(size_t index)const
+		{
+			return open + (ladder_lower + static_cast<int32_t>(index)) * price_step;
+		}
+
+		//价格在明细数组中的下标，不在范围内返回false
+		bool find_ladder_index(double_t price, size_t& index)const
+		{
+			if (price_step == .0 || ladder_volume.empty())
+			{
+				return false;
+			}
+			int32_t offset = get_price_offset(price) - ladder_lower;
+			if (offset < 0 || static_cast<size_t>(offset) >= ladder_volume.size())
+			{
+				return false;
+			}
+			index = static_cast<size_t>(offset);
+			return true;
+		}
+
+		//累加一笔成交，同时更新poc
+		void add_ladder_volume(double_t price, uint32_t volume, uint32_t buy_volume, uint32_t sell_volume)
+		{
+			if (price_step == .0)
+			{
+				//没有最小变动价位无法按档位统计，poc退化为最新成交价
+				poc = price;
+				return;
+			}
+			int32_t offset = get_price_offset(price);
+			if (ladder_volume.empty())
+			{
+				ladder_lower = offset;
+			}
+			else if (offset < ladder_lower)
+			{
+				const size_t expand = static_cast<size_t>(ladder_lower - offset);
+				ladder_volume.insert(ladder_volume.begin(), expand, 0);
+				ladder_buy.insert(ladder_buy.begin(), expand, 0);
+				ladder_sell.insert(ladder_sell.begin(), expand, 0);
+				ladder_lower = offset;
+			}
+			const size_t index = static_cast<size_t>(offset - ladder_lower);
+			if (index >= ladder_volume.size())
+			{
+				ladder_volume.resize(index + 1, 0);
+				ladder_buy.resize(index + 1, 0);
+				ladder_sell.resize(index + 1, 0);
+			}
+			ladder_volume[index] += volume;
+			ladder_buy[index] += buy_volume;
+			ladder_sell[index] += sell_volume;
+			size_t poc_index = 0;
+			if (!find_ladder_index(poc, poc_index) || ladder_volume[index] > ladder_volume[poc_index])
+			{
+				poc = price;
+			}
+		}
 
 		uint32_t get_buy_volume(double_t price)const
 		{
-			auto it = price_buy_volume.find(price);
-			if (it == price_buy_volume.end())
+			size_t index = 0;
+			if (!find_ladder_index(price, index))
 			{
 				return 0;
 			}
-			return it->second;
+			return ladder_buy[index];
 		}
 
 		uint32_t get_sell_volume(double_t price)const
 		{
-			auto it = price_sell_volume.find(price);
-			if (it == price_sell_volume.end())
+			size_t index = 0;
+			if (!find_ladder_index(price, index))
 			{
 				return 0;
 			}
-			return it->second;
+			return ladder_sell[index];
 		}
 		//（price_buy_volume - price_sell_volume）
 		int32_t get_price_delta(double_t price)const{
@@ -162,9 +234,10 @@ namespace lt
 			if(low==.0|| high==.0|| price_step==.0){
 				return result;
 			}
-			for (double_t price = low; price <= high; price += price_step)
+			result.reserve(ladder_volume.size());
+			for (size_t i = 0; i < ladder_volume.size(); i++)
 			{
-				result.emplace_back(std::make_tuple(price, get_buy_volume(price), get_sell_volume(price)));
+				result.emplace_back(std::make_tuple(get_ladder_price(i), ladder_buy[i], ladder_sell[i]));
 			}
 			return result;
 		}
@@ -176,28 +249,95 @@ namespace lt
 			auto demand_unbalance = std::make_shared<std::vector<double_t>>();
 			//供给失衡(供不应求)
 			auto supply_unbalance = std::make_shared<std::vector<double_t>>();
-			//构建订单薄
-			auto order_book = get_order_book();
-			if(order_book.size() > 0)
+			std::vector<uint8_t> demand_mask(ladder_volume.size());
+			std::vector<uint8_t> supply_mask(ladder_volume.size());
+			get_unbalance(multiple, demand_mask.data(), supply_mask.data(), ladder_volume.size());
+			for (size_t i = 0; i < ladder_volume.size(); i++)
 			{
-				for (size_t i = 0; i < order_book.size() - 1; i++)
+				if (demand_mask[i])
+				{
+					demand_unbalance->emplace_back(get_ladder_price(i));
+				}
+				if (supply_mask[i])
 				{
-					auto demand_cell = order_book[i];
-					auto supply_cell = order_book[i + 1];
-					if (std::get<1>(demand_cell) * multiple > std::get<2>(supply_cell))
-					{
-						demand_unbalance->emplace_back(std::get<0>(demand_cell));
-					}
-					else if (std::get<2>(supply_cell) * multiple > std::get<1>(demand_cell))
-					{
-						supply_unbalance->emplace_back(std::get<0>(supply_cell));
-					}
+					supply_unbalance->emplace_back(get_ladder_price(i));
 				}
 			}
-		
 			return std::make_pair(demand_unbalance, supply_unbalance);
 		}
 
+		/*
+		*	获取不平衡订单（不分配内存）
+		*	demand_mask/supply_mask 由调用方提供，长度capacity不小于 ladder_volume.size()，按档位下标标记失衡
+		*/
+		orderflow::imbalance_count get_unbalance(uint32_t multiple, uint8_t* demand_mask, uint8_t* supply_mask, size_t capacity)const
+		{
+			if (capacity < ladder_volume.size())
+			{
+				return orderflow::imbalance_count();
+			}
+			return orderflow::imbalance(ladder_buy.data(), ladder_sell.data(), ladder_volume.size(), multiple, demand_mask, supply_mask);
+		}
+
+		/*
+		*	价值区域
+		*	@ratio 覆盖成交量的比例，一般是0.7
+		*/
+		bool get_value_area(double_t ratio, double_t& val, double_t& vah)const
+		{
+			size_t poc_index = 0;
+			size_t low_index = 0;
+			size_t high_index = 0;
+			if (!find_ladder_index(poc, poc_index) || !orderflow::value_area(ladder_volume.data(), ladder_volume.size(), poc_index, ratio, low_index, high_index))
+			{
+				return false;
+			}
+			val = get_ladder_price(low_index);
+			vah = get_ladder_price(high_index);
+			return true;
+		}
+
+		//delta背离，-1顶背离，1底背离，0没有背离
+		int32_t get_delta_divergence()const
+		{
+			return orderflow::delta_divergence(open, close, delta);
+		}
+
+		//合并一根时间上紧接着的小周期bar（用于由1分钟bar合成大周期）
+		void merge(const bar_info& other)
+		{
+			if (other.open == .0)
+			{
+				return;
+			}
+			const bool is_first = (open == .0);
+			if (is_first)
+			{
+				id = other.id;
+				time = other.time;
+				open = other.open;
+				high = other.high;
+				low = other.low;
+				price_step = other.price_step;
+				poc = other.poc;
+			}
+			else
+			{
+				high = std::max(high, other.high);
+				low = std::min(low, other.low);
+			}
+			close = other.close;
+			volume += other.volume;
+			delta += other.delta;
+			for (size_t i = 0; i < other.ladder_volume.size(); i++)
+			{
+				add_ladder_volume(other.get_ladder_price(i), other.ladder_volume[i], other.ladder_buy[i], other.ladder_sell[i]);
+			}
+			if (is_first)
+			{
+				poc = other.poc;
+			}
+		}
 
 		void clear()
 		{
@@ -211,8 +351,11 @@ namespace lt
 			delta = 0;
 			poc = 0;
 			price_step = .0;
-			price_buy_volume.clear();
-			price_sell_volume.clear();
+			//保留容量，下一根bar不再重新分配
+			ladder_lower = 0;
+			ladder_volume.clear();
+			ladder_buy.clear();
+			ladder_sell.clear();
 		}
 
 		bar_info()
@@ -225,7 +368,8 @@ namespace lt
 			volume(0),
 			delta(0),
 			poc(.0),
-			price_step(.0)
+			price_step(.0),
+			ladder_lower(0)
 		{}
 	};
 
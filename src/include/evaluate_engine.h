@@ -24,6 +24,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include <define.h>
 #include <strategy.h>
 #include <engine.h>
+#include <shared_types.h>
 
 namespace lt
 {
@@ -43,7 +44,15 @@ namespace lt::hft
 
 		dummy_trader* _trader_simulator;
 
-		std::shared_ptr<class csv_recorder> _recorder;
+		std::shared_ptr<class stream_recorder> _recorder;
+
+		//记录目录，为空不记录
+		std::string _recorder_path;
+
+		std::string _recorder_type;
+
+		//交易日快照目录，为空不保存
+		std::string _snapshot_path;
 
 	public:
 
@@ -54,12 +63,52 @@ namespace lt::hft
 
 		void back_test(const std::vector<std::shared_ptr<lt::hft::strategy>>& strategys, uint32_t trading_day);
 
+		/*
+		* 获取模拟账户资金
+		*/
+		const account_info& get_account()const;
+
+		/*
+		* 交易日快照目录，为空不保存
+		*/
+		void set_snapshot_path(const std::string& path)
+		{
+			_snapshot_path = path;
+		}
+
+		const std::string& get_snapshot_path()const
+		{
+			return _snapshot_path;
+		}
+
+		/*
+		* 记录目录（结算、订单、成交、资金曲线），为空不记录
+		*/
+		void set_recorder_path(const std::string& path);
+
+		const std::string& get_recorder_path()const
+		{
+			return _recorder_path;
+		}
+
+		/*
+		* 从交易日快照恢复账户、持仓、挂单和策略持久化数据
+		* 恢复以后从下一个交易日继续回测，不用重跑之前的交易日
+		* @trading_day 快照对应的交易日（已经回测完成的交易日）
+		*/
+		bool load_snapshot(const std::vector<std::shared_ptr<lt::hft::strategy>>& strategys, uint32_t trading_day);
+
 	private:
 
 		void playback_history();
 
 		void simulate_crossday(uint32_t trading_day);
 
+		void save_snapshot(const std::vector<std::shared_ptr<lt::hft::strategy>>& strategys, uint32_t trading_day);
+
+		//订单回报写入记录器（每个交易日start_service以后绑定，stop_service时随交易事件一起清理）
+		void bind_recorder();
+
 	};
 
 
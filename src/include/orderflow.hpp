@@ -0,0 +1,185 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+
+/*
+ *	订单流分析
+ *	全部基于价格档位下标（相对bar最低价的跳数）上的连续数组，结果写入调用方提供的缓冲，不分配内存
+ */
+namespace lt::orderflow
+{
+	struct imbalance_count
+	{
+		//需求失衡（主动买远大于上一档主动卖）
+		size_t demand;
+		//供给失衡（主动卖远大于下一档主动买）
+		size_t supply;
+
+		imbalance_count() :demand(0), supply(0) {}
+	};
+
+	/*
+	 *	相邻档位的失衡（斜向比较 buy[i] 和 sell[i+1]）
+	 *	demand_mask[i] 标记第i档需求失衡，supply_mask[i+1] 标记第i+1档供给失衡
+	 *	两个mask长度都要不小于count
+	 */
+	inline imbalance_count imbalance(const uint32_t* buy, const uint32_t* sell, size_t count, uint32_t multiple, uint8_t* demand_mask, uint8_t* supply_mask)
+	{
+		imbalance_count result;
+		if (count == 0)
+		{
+			return result;
+		}
+		const size_t levels = count - 1;
+		supply_mask[0] = 0;
+		demand_mask[levels] = 0;
+		size_t i = 0;
+#if defined(__SSE4_1__)
+		//无符号比较：两边都异或符号位以后用有符号比较
+		const __m128i bias = _mm_set1_epi32(static_cast<int32_t>(0x80000000));
+		const __m128i mul = _mm_set1_epi32(static_cast<int32_t>(multiple));
+		for (; i + 4 <= levels; i += 4)
+		{
+			const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buy + i));
+			const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sell + i + 1));
+			const __m128i bm = _mm_xor_si128(_mm_mullo_epi32(b, mul), bias);
+			const __m128i sm = _mm_xor_si128(_mm_mullo_epi32(s, mul), bias);
+			const __m128i demand = _mm_cmpgt_epi32(bm, _mm_xor_si128(s, bias));
+			const __m128i supply = _mm_andnot_si128(demand, _mm_cmpgt_epi32(sm, _mm_xor_si128(b, bias)));
+			const int demand_bits = _mm_movemask_ps(_mm_castsi128_ps(demand));
+			const int supply_bits = _mm_movemask_ps(_mm_castsi128_ps(supply));
+			for (size_t k = 0; k < 4; k++)
+			{
+				demand_mask[i + k] = static_cast<uint8_t>((demand_bits >> k) & 1);
+				supply_mask[i + k + 1] = static_cast<uint8_t>((supply_bits >> k) & 1);
+				result.demand += demand_mask[i + k];
+				result.supply += supply_mask[i + k + 1];
+			}
+		}
+#endif
+		for (; i < levels; i++)
+		{
+			const uint8_t demand = buy[i] * multiple > sell[i + 1];
+			const uint8_t supply = !demand && sell[i + 1] * multiple > buy[i];
+			demand_mask[i] = demand;
+			supply_mask[i + 1] = supply;
+			result.demand += demand;
+			result.supply += supply;
+		}
+		return result;
+	}
+
+	/*
+	 *	连续失衡（堆积失衡）
+	 *	找出mask中连续为1且长度不小于min_run的区间，区间写入runs（[begin,end]闭区间）
+	 *	返回找到的区间数量，超过capacity的部分只计数不写入
+	 */
+	inline size_t stacked_imbalance(const uint8_t* mask, size_t count, size_t min_run, std::pair<size_t, size_t>* runs, size_t capacity)
+	{
+		size_t result = 0;
+		size_t begin = 0;
+		size_t length = 0;
+		for (size_t i = 0; i <= count; i++)
+		{
+			if (i < count && mask[i])
+			{
+				if (length == 0)
+				{
+					begin = i;
+				}
+				length++;
+				continue;
+			}
+			if (length > 0 && length >= min_run)
+			{
+				if (result < capacity)
+				{
+					runs[result] = std::make_pair(begin, begin + length - 1);
+				}
+				result++;
+			}
+			length = 0;
+		}
+		return result;
+	}
+
+	/*
+	 *	价值区域（从poc开始向两边扩展，每次取成交量较大的一边，直到覆盖ratio比例的成交量）
+	 *	成功返回true，low_index/high_index 为VAL/VAH对应的档位
+	 */
+	inline bool value_area(const uint32_t* volume, size_t count, size_t poc_index, double ratio, size_t& low_index, size_t& high_index)
+	{
+		if (count == 0 || poc_index >= count)
+		{
+			return false;
+		}
+		uint64_t total = 0;
+		for (size_t i = 0; i < count; i++)
+		{
+			total += volume[i];
+		}
+		const double target = total * ratio;
+		uint64_t current = volume[poc_index];
+		low_index = poc_index;
+		high_index = poc_index;
+		while (current < target && (low_index > 0 || high_index + 1 < count))
+		{
+			const uint32_t above = high_index + 1 < count ? volume[high_index + 1] : 0;
+			const uint32_t below = low_index > 0 ? volume[low_index - 1] : 0;
+			if (high_index + 1 < count && (low_index == 0 || above >= below))
+			{
+				high_index++;
+				current += above;
+			}
+			else
+			{
+				low_index--;
+				current += below;
+			}
+		}
+		return true;
+	}
+
+	/*
+	 *	delta背离
+	 *	价格上涨但delta为负返回-1（顶背离），价格下跌但delta为正返回1（底背离），否则返回0
+	 */
+	inline int32_t delta_divergence(double open, double close, int32_t delta)
+	{
+		if (close > open && delta < 0)
+		{
+			return -1;
+		}
+		if (close < open && delta > 0)
+		{
+			return 1;
+		}
+		return 0;
+	}
+}
@@ -0,0 +1,95 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include <define.h>
+#include <params.hpp>
+#include <shared_types.h>
+#include <strategy.h>
+
+namespace lt::hft
+{
+	class evaluate_engine;
+
+	/*
+	 *	根据参数组合创建策略，每个组合对应一个独立的回测实例
+	 */
+	typedef std::function<std::vector<std::shared_ptr<strategy>>(evaluate_engine*, const params&)> strategy_creator;
+
+	struct sweep_result
+	{
+		//参数组合序号
+		size_t index;
+
+		params param;
+
+		account_info account;
+
+		//所有交易日累计的订单统计
+		order_statistic statistic;
+
+		sweep_result() :index(0) {}
+	};
+
+	/*
+	 *	参数扫描
+	 *	同一批交易日用多组参数回测，每个交易日的行情只加载一次，由所有实例共享
+	 *	实例平均分配到工作线程上，按交易日逐日推进
+	 */
+	class parameter_sweep
+	{
+
+	private:
+
+		std::string _config_path;
+
+		uint32_t _worker_count;
+
+		std::vector<sweep_result> _results;
+
+	public:
+
+		/*
+		 *	@config_path	回测配置，同evaluate_engine
+		 *	@worker_count	工作线程数，0表示使用cpu核数
+		 */
+		parameter_sweep(const char* config_path, uint32_t worker_count = 0);
+
+	public:
+
+		/*
+		 *	执行扫描，返回按资金从高到低排序的结果
+		 */
+		const std::vector<sweep_result>& run(const std::vector<params>& combinations, const std::vector<uint32_t>& trading_days, strategy_creator creator);
+
+		/*
+		 *	输出排名结果表（csv）
+		 */
+		bool save_result(const char* path)const;
+
+		inline const std::vector<sweep_result>& get_result()const
+		{
+			return _results;
+		}
+
+	};
+}
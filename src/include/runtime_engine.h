@@ -40,6 +40,12 @@ namespace lt::hft
 
 		actual_trader* _trader;
 
+		//热备交易会话（可选）
+		actual_trader* _standby;
+
+		//策略持仓账本文件（可选），停止时保存，启动时恢复持仓归属
+		std::string _ledger_path;
+
 	public:
 
 		runtime_engine(const char* config_path);
@@ -51,6 +57,12 @@ namespace lt::hft
 
 		void stop_trading();
 
+	private:
+
+		void load_ledger();
+
+		void save_ledger()const;
+
 	};
 }
 
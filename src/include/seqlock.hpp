@@ -0,0 +1,101 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+namespace lt
+{
+	/*
+	 *	双缓冲顺序锁（一个写线程，任意多个读线程）
+	 *	写线程总是写另一块缓冲区再发布，读线程不加锁、不会阻塞写线程；
+	 *	只有读的过程中写线程连续发布了两次才需要重读，按帧发布的场景下基本不会发生
+	 */
+	template<typename T>
+	class seqlock_buffer
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "seqlock_buffer requires trivially copyable type");
+
+	private:
+
+		//偶数表示已发布，奇数表示正在写下一个版本；版本号为 sequence/2
+		alignas(64) std::atomic<uint64_t> _sequence;
+
+		alignas(64) T _buffer[2];
+
+	public:
+
+		seqlock_buffer() :_sequence(0) {}
+
+		seqlock_buffer(const seqlock_buffer&) = delete;
+
+		seqlock_buffer& operator=(const seqlock_buffer&) = delete;
+
+		/*
+		*	写线程调用，返回下一个版本的缓冲区（内容是上上个版本），写完调用end_write发布
+		*/
+		T& begin_write()
+		{
+			const uint64_t sequence = _sequence.load(std::memory_order_relaxed);
+			_sequence.store(sequence + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			return _buffer[((sequence >> 1) + 1) & 1];
+		}
+
+		void end_write()
+		{
+			_sequence.store(_sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+
+		void write(const T& data)
+		{
+			begin_write() = data;
+			end_write();
+		}
+
+		/*
+		*	任意线程调用，返回读到的版本号（0表示还没有发布过）
+		*/
+		uint64_t read(T& result)const
+		{
+			while (true)
+			{
+				const uint64_t sequence = _sequence.load(std::memory_order_acquire);
+				const uint64_t version = sequence >> 1;
+				std::memcpy(&result, &_buffer[version & 1], sizeof(T));
+				std::atomic_thread_fence(std::memory_order_acquire);
+				//写线程还没有开始覆盖这块缓冲区（写到 version+2 才会覆盖）
+				if (_sequence.load(std::memory_order_relaxed) - (version << 1) <= 2)
+				{
+					return version;
+				}
+			}
+		}
+
+		uint64_t version()const
+		{
+			return _sequence.load(std::memory_order_acquire) >> 1;
+		}
+	};
+}
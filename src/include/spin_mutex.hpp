@@ -21,26 +21,45 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
 OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 #pragma once
-#include <rapidcsv.h>
-#include <shared_types.h>
-namespace lt::hft
+#include <atomic>
+#include <thread>
+#include <mutex>
+
+namespace lt
 {
-	class csv_recorder
+	/*
+	 *	排队自旋锁（先到先得）
+	 *	持有锁的线程释放以后马上重新加锁也不会饿死等待的线程，可以配合std::lock_guard使用
+	 */
+	class spin_mutex
 	{
+
 	private:
 
-		std::string _basic_path;
+		std::atomic<uint32_t> _ticket;
 
-		rapidcsv::Document _crossday_flow_csv;
+		std::atomic<uint32_t> _serving;
 
 	public:
 
-		csv_recorder(const char* basic_path);
+		spin_mutex() :_ticket(0), _serving(0) {}
 
-	public:
+		spin_mutex(const spin_mutex&) = delete;
+
+		spin_mutex& operator=(const spin_mutex&) = delete;
 
-		//结算表
-		void record_crossday_flow(uint32_t trading_day, const order_statistic& statistic, const account_info& account);
+		void lock()
+		{
+			const uint32_t ticket = _ticket.fetch_add(1, std::memory_order_relaxed);
+			while (_serving.load(std::memory_order_acquire) != ticket)
+			{
+				std::this_thread::yield();
+			}
+		}
 
+		void unlock()
+		{
+			_serving.fetch_add(1, std::memory_order_release);
+		}
 	};
 }
@@ -38,6 +38,8 @@ namespace lt::hft
 
 	class strategy : context::order_listener
 	{
+		friend class strategy_shard;
+
 	public:
 
 	private:
@@ -50,6 +52,28 @@ namespace lt::hft
 
 		bool _closeable;
 
+		//持仓账本行号，init以后有效
+		uint32_t _ledger_row;
+
+		static constexpr uint32_t INVALID_COLUMN = 0xFFFFFFFFU;
+
+		struct code_slot
+		{
+			//账本列号，第一次取持仓时解析
+			uint32_t ledger_column;
+
+			//合约表下标
+			instrument_index instrument;
+		};
+
+		//策略用到的合约第一次用到时解析
+		mutable std::map<code_t, code_slot> _code_slot;
+
+		//最近一次用到的合约，连续查同一个合约时不用查表
+		mutable std::pair<const code_t, code_slot>* _last_slot;
+
+		code_slot& get_code_slot(const code_t& code)const;
+
 	public:
 
 		strategy(straid_t id, engine* engine, bool openable, bool closeable);
@@ -77,6 +101,16 @@ namespace lt::hft
 		*/
 		void destroy(unsubscriber& unsuber);
 
+		/*
+		*	保存持久化数据（交易日快照）
+		*/
+		void save(std::vector<uint8_t>& data);
+
+		/*
+		*	恢复持久化数据
+		*/
+		void load(const std::vector<uint8_t>& data);
+
 		/*
 		*	收到消息
 		*/
@@ -106,6 +140,16 @@ namespace lt::hft
 		*/
 		virtual void on_change(const params& p) {};
 
+		/*
+		*	保存持久化数据，写入交易日快照
+		*/
+		virtual void on_save(std::vector<uint8_t>& data) {};
+
+		/*
+		*	从交易日快照恢复持久化数据
+		*/
+		virtual void on_load(const std::vector<uint8_t>& data) {};
+
 
 	public:
 
@@ -192,10 +236,15 @@ namespace lt::hft
 
 
 		/**
-		* 获取仓位信息
+		* 获取仓位信息（策略自己名下的持仓）
 		*/
 		const position_info& get_position(const code_t& code) const;
 
+		/**
+		* 获取账户仓位信息（所有策略以及没有归属的持仓）
+		*/
+		const position_info& get_account_position(const code_t& code) const;
+
 		/**
 		* 获取委托订单
 		**/
@@ -212,6 +261,21 @@ namespace lt::hft
 		*/
 		void set_cancel_condition(estid_t estid, std::function<bool(estid_t)> callback);
 
+		/*
+		* 行情时间超过time以后撤销
+		*/
+		void set_cancel_at(estid_t estid, daytm_t time);
+
+		/*
+		* 从现在开始（行情时间）超过milliseconds毫秒以后撤销
+		*/
+		void set_cancel_after(estid_t estid, uint32_t milliseconds);
+
+		/*
+		* 最新价偏离委托价超过distance时撤销
+		*/
+		void set_cancel_if_price_moves(estid_t estid, double_t distance);
+
 		/**
 		* 获取最后一次下单时间
 		*	跨交易日返回0
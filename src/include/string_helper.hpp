@@ -23,6 +23,8 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #pragma once
 #include <string>
 #include <vector>
+#include <cstring>
+#include <cstdint>
 namespace lt
 {
     class string_helper
@@ -44,6 +46,48 @@ namespace lt
             }
             return elems;
         }
+        /*
+        *   无符号整数转十进制字符串（两位一查表，写入结尾0，返回长度）
+        *   buffer至少21字节，下单路径上替代sprintf("%u")
+        */
+        static size_t format_uint(char* buffer, uint64_t value)
+        {
+            static const char digits[] =
+                "00010203040506070809"
+                "10111213141516171819"
+                "20212223242526272829"
+                "30313233343536373839"
+                "40414243444546474849"
+                "50515253545556575859"
+                "60616263646566676869"
+                "70717273747576777879"
+                "80818283848586878889"
+                "90919293949596979899";
+            char temp[20];
+            char* cursor = temp + sizeof(temp);
+            while (value >= 100)
+            {
+                const size_t index = static_cast<size_t>(value % 100) * 2;
+                value /= 100;
+                *--cursor = digits[index + 1];
+                *--cursor = digits[index];
+            }
+            if (value >= 10)
+            {
+                const size_t index = static_cast<size_t>(value) * 2;
+                *--cursor = digits[index + 1];
+                *--cursor = digits[index];
+            }
+            else
+            {
+                *--cursor = static_cast<char>('0' + value);
+            }
+            const size_t length = static_cast<size_t>(temp + sizeof(temp) - cursor);
+            std::memcpy(buffer, cursor, length);
+            buffer[length] = '\0';
+            return length;
+        }
+
         static std::string to_string(const char* value)
         {
             return std::string(value);
@@ -158,6 +158,16 @@ namespace lt
 		}
 		return -1;
 	}
+	//固定格式 HH:MM:SS（行情接口的UpdateTime），按位置取数字，不扫描字符串也没有分支
+	static daytm_t decode_daytm(const char* time, uint32_t tick)
+	{
+		const daytm_t hour = static_cast<daytm_t>(time[0] - '0') * 10 + static_cast<daytm_t>(time[1] - '0');
+		const daytm_t minute = static_cast<daytm_t>(time[3] - '0') * 10 + static_cast<daytm_t>(time[4] - '0');
+		const daytm_t second = static_cast<daytm_t>(time[6] - '0') * 10 + static_cast<daytm_t>(time[7] - '0');
+		const daytm_t value = (hour * 3600 + minute * 60 + second) * ONE_SECOND_MILLISECONDS + tick;
+		//和daytm_sequence一致，16点以前加一天
+		return value - 16 * ONE_HOUR_MILLISECONDS + ONE_DAY_MILLISECONDS * static_cast<daytm_t>(value < 16 * ONE_HOUR_MILLISECONDS);
+	}
 	//121212
 	static daytm_t make_daytm(uint32_t time, uint32_t tick)
 	{
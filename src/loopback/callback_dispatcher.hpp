@@ -0,0 +1,164 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include <functional>
+#include <queue>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <atomic>
+
+namespace lt::loopback
+{
+	/*
+	*	模拟柜台的回调线程
+	*	请求线程投递任务和延迟，到时间以后在回调线程按时间顺序执行（时间相同的按投递顺序）
+	*	离到期不到200微秒时自旋等待，保证延迟精度
+	*/
+	class callback_dispatcher
+	{
+		typedef std::chrono::steady_clock::time_point time_point;
+
+		struct task
+		{
+			time_point due;
+			uint64_t sequence;
+			std::function<void()> callback;
+
+			bool operator > (const task& other)const
+			{
+				if (due != other.due)
+				{
+					return due > other.due;
+				}
+				return sequence > other.sequence;
+			}
+		};
+
+		std::priority_queue<task, std::vector<task>, std::greater<task>> _tasks;
+
+		uint64_t _sequence;
+
+		std::mutex _mutex;
+
+		std::condition_variable _signal;
+
+		std::thread* _thread;
+
+		std::atomic<bool> _is_runing;
+
+	public:
+
+		callback_dispatcher() :_sequence(0), _thread(nullptr), _is_runing(false) {}
+
+		~callback_dispatcher()
+		{
+			stop();
+		}
+
+		void start()
+		{
+			if (_thread)
+			{
+				return;
+			}
+			_is_runing = true;
+			_thread = new std::thread(&callback_dispatcher::run, this);
+		}
+
+		//停止时丢弃还没有到期的任务
+		void stop()
+		{
+			if (_thread == nullptr)
+			{
+				return;
+			}
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_is_runing = false;
+			}
+			_signal.notify_all();
+			if (_thread->get_id() == std::this_thread::get_id())
+			{
+				_thread->detach();
+			}
+			else
+			{
+				_thread->join();
+			}
+			delete _thread;
+			_thread = nullptr;
+			std::lock_guard<std::mutex> lock(_mutex);
+			while (!_tasks.empty())
+			{
+				_tasks.pop();
+			}
+		}
+
+		void post(std::chrono::microseconds delay, std::function<void()> callback)
+		{
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_tasks.push({ std::chrono::steady_clock::now() + delay, _sequence++, std::move(callback) });
+			}
+			_signal.notify_one();
+		}
+
+	private:
+
+		void run()
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			while (_is_runing)
+			{
+				if (_tasks.empty())
+				{
+					_signal.wait(lock);
+					continue;
+				}
+				const auto now = std::chrono::steady_clock::now();
+				const auto due = _tasks.top().due;
+				if (due <= now)
+				{
+					auto callback = std::move(const_cast<task&>(_tasks.top()).callback);
+					_tasks.pop();
+					lock.unlock();
+					callback();
+					lock.lock();
+				}
+				else if (due - now < std::chrono::microseconds(200))
+				{
+					lock.unlock();
+					std::this_thread::yield();
+					lock.lock();
+				}
+				else
+				{
+					_signal.wait_until(lock, due - std::chrono::microseconds(100));
+				}
+			}
+		}
+	};
+}
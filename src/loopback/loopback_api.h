@@ -0,0 +1,78 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include <cstdint>
+#include <CTP_V6.6.9_20220920/ThostFtdcMdApi.h>
+#include <CTP_V6.6.9_20220920/ThostFtdcTraderApi.h>
+#include <TAP_V9_20200808/TapQuoteAPI.h>
+#include <TAP_V9_20200808/TapTradeAPI.h>
+
+/*
+*	本地回环柜台（替换thostmduserapi_se/thosttraderapi_se和TapQuoteAPI/TapTradeAPI），用于不连接真实柜台测量端到端延迟
+*	ctp_api_*和tap_api_*适配器不用修改，加载到这些库就会连到回环柜台
+*	配置和钩子函数是导出的C函数，测试程序通过dlsym获取，两种接口的库导出同名函数，只有钩子的参数类型不同
+*/
+
+#ifdef _WIN32
+#define LOOPBACK_EXPORT extern "C" __declspec(dllexport)
+#else
+#define LOOPBACK_EXPORT extern "C" __attribute__((visibility("default")))
+#endif
+
+//行情发送前调用（行情回调线程）
+typedef void (*loopback_tick_hook)(const CThostFtdcDepthMarketDataField* tick);
+
+//收到报单请求时调用（调用ReqOrderInsert的线程）
+typedef void (*loopback_order_hook)(const CThostFtdcInputOrderField* order);
+
+//TAP回环柜台的钩子，调用时机和CTP一致
+typedef void (*loopback_tap_tick_hook)(const TapAPIQuoteWhole* tick);
+
+typedef void (*loopback_tap_order_hook)(const TapAPINewOrder* order);
+
+/*
+*	行情配置
+*	journal_path 行情日志目录（market_journal格式），为空时按订阅合约生成模拟行情
+*	interval_us 两笔行情之间的间隔（微秒）
+*/
+typedef void (*loopback_market_config_fn)(const char* journal_path, uint32_t interval_us);
+
+typedef void (*loopback_market_hook_fn)(loopback_tick_hook hook);
+
+typedef void (*loopback_tap_market_hook_fn)(loopback_tap_tick_hook hook);
+
+/*
+*	交易配置
+*	order_latency_us 报单/撤单到回报的延迟
+*	trade_latency_us FAK/FOK报单从回报到成交的延迟（普通报单只挂单不成交）
+*/
+typedef void (*loopback_trader_config_fn)(uint32_t order_latency_us, uint32_t trade_latency_us);
+
+typedef void (*loopback_trader_hook_fn)(loopback_order_hook hook);
+
+typedef void (*loopback_tap_trader_hook_fn)(loopback_tap_order_hook hook);
+
+#define LOOPBACK_MARKET_CONFIG "loopback_market_config"
+#define LOOPBACK_MARKET_HOOK "loopback_market_hook"
+#define LOOPBACK_TRADER_CONFIG "loopback_trader_config"
+#define LOOPBACK_TRADER_HOOK "loopback_trader_hook"
@@ -0,0 +1,240 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "loopback_market.h"
+#include <cstring>
+#include <ctime>
+#include <time_utils.hpp>
+
+using namespace lt;
+using namespace lt::loopback;
+
+namespace
+{
+	const std::chrono::microseconds SESSION_LATENCY(1000);
+
+	std::mutex _config_mutex;
+
+	std::string _journal_path;
+
+	uint32_t _interval_us = 0;
+
+	std::atomic<loopback_tick_hook> _tick_hook(nullptr);
+}
+
+LOOPBACK_EXPORT void loopback_market_config(const char* journal_path, uint32_t interval_us)
+{
+	std::lock_guard<std::mutex> lock(_config_mutex);
+	_journal_path = journal_path ? journal_path : "";
+	_interval_us = interval_us;
+}
+
+LOOPBACK_EXPORT void loopback_market_hook(loopback_tick_hook hook)
+{
+	_tick_hook = hook;
+}
+
+CThostFtdcMdApi* CThostFtdcMdApi::CreateFtdcMdApi(const char* pszFlowPath, const bool bIsUsingUdp, const bool bIsMulticast)
+{
+	return new loopback_market();
+}
+
+const char* CThostFtdcMdApi::GetApiVersion()
+{
+	return "loopback";
+}
+
+loopback_market::loopback_market() :
+	_spi(nullptr)
+{
+	const time_t now = time(nullptr);
+	tm local;
+#ifdef _WIN32
+	localtime_s(&local, &now);
+#else
+	localtime_r(&now, &local);
+#endif
+	strftime(_trading_day, sizeof(_trading_day), "%Y%m%d", &local);
+}
+
+loopback_market::~loopback_market()
+{
+	_feed.stop();
+	_dispatcher.stop();
+}
+
+void loopback_market::Release()
+{
+	delete this;
+}
+
+void loopback_market::Init()
+{
+	std::string journal_path;
+	{
+		std::lock_guard<std::mutex> lock(_config_mutex);
+		journal_path = _journal_path;
+	}
+	if (!journal_path.empty())
+	{
+		_feed.load(journal_path);
+	}
+	_dispatcher.start();
+	_dispatcher.post(std::chrono::milliseconds(10), [this]()->void {
+		if (auto spi = _spi.load())
+		{
+			spi->OnFrontConnected();
+		}
+	});
+}
+
+int loopback_market::Join()
+{
+	return 0;
+}
+
+const char* loopback_market::GetTradingDay()
+{
+	return _trading_day;
+}
+
+void loopback_market::RegisterSpi(CThostFtdcMdSpi* pSpi)
+{
+	_spi = pSpi;
+}
+
+int loopback_market::SubscribeMarketData(char* ppInstrumentID[], int nCount)
+{
+	std::vector<std::string> id_list;
+	for (int i = 0; i < nCount; i++)
+	{
+		_feed.subscribe(ppInstrumentID[i], "");
+		id_list.emplace_back(ppInstrumentID[i]);
+	}
+	_dispatcher.post(SESSION_LATENCY, [this, id_list]()->void {
+		auto spi = _spi.load();
+		if (spi == nullptr)
+		{
+			return;
+		}
+		for (size_t i = 0; i < id_list.size(); i++)
+		{
+			CThostFtdcSpecificInstrumentField instrument;
+			memset(&instrument, 0, sizeof(instrument));
+			strncpy(instrument.InstrumentID, id_list[i].c_str(), sizeof(instrument.InstrumentID) - 1);
+			spi->OnRspSubMarketData(&instrument, nullptr, 0, i + 1 == id_list.size());
+		}
+	});
+	return 0;
+}
+
+int loopback_market::UnSubscribeMarketData(char* ppInstrumentID[], int nCount)
+{
+	for (int i = 0; i < nCount; i++)
+	{
+		_feed.unsubscribe(ppInstrumentID[i]);
+	}
+	return 0;
+}
+
+int loopback_market::ReqUserLogin(CThostFtdcReqUserLoginField* pReqUserLoginField, int nRequestID)
+{
+	CThostFtdcRspUserLoginField rsp;
+	memset(&rsp, 0, sizeof(rsp));
+	strcpy(rsp.TradingDay, _trading_day);
+	strcpy(rsp.BrokerID, pReqUserLoginField->BrokerID);
+	strcpy(rsp.UserID, pReqUserLoginField->UserID);
+	strcpy(rsp.SystemName, "loopback");
+	_dispatcher.post(SESSION_LATENCY, [this, rsp, nRequestID]()mutable->void {
+		if (auto spi = _spi.load())
+		{
+			CThostFtdcRspInfoField info;
+			memset(&info, 0, sizeof(info));
+			spi->OnRspUserLogin(&rsp, &info, nRequestID, true);
+		}
+		start_feed();
+	});
+	return 0;
+}
+
+int loopback_market::ReqUserLogout(CThostFtdcUserLogoutField* pUserLogout, int nRequestID)
+{
+	_feed.stop();
+	return 0;
+}
+
+void loopback_market::start_feed()
+{
+	uint32_t interval_us = 0;
+	{
+		std::lock_guard<std::mutex> lock(_config_mutex);
+		interval_us = _interval_us;
+	}
+	_feed.start(static_cast<uint32_t>(std::atoi(_trading_day)), interval_us, [this](const journal_record& record)->void {
+		send_tick(record);
+	});
+}
+
+void loopback_market::send_tick(const journal_record& record)
+{
+	auto spi = _spi.load();
+	if (spi == nullptr)
+	{
+		return;
+	}
+	CThostFtdcDepthMarketDataField tick;
+	memset(&tick, 0, sizeof(tick));
+	sprintf(tick.TradingDay, "%u", record.trading_day);
+	strncpy(tick.InstrumentID, record.code.get_id(), sizeof(tick.InstrumentID) - 1);
+	strncpy(tick.ExchangeID, record.code.get_excg(), sizeof(tick.ExchangeID) - 1);
+	const daytm_t real_time = daytm_really(record.time);
+	const uint32_t second = real_time / ONE_SECOND_MILLISECONDS;
+	sprintf(tick.UpdateTime, "%02u:%02u:%02u", second / 3600, (second % 3600) / 60, second % 60);
+	tick.UpdateMillisec = static_cast<int>(real_time % ONE_SECOND_MILLISECONDS);
+	tick.LastPrice = record.price;
+	tick.Volume = static_cast<int>(record.volume);
+	tick.OpenInterest = record.open_interest;
+	tick.BidPrice1 = record.bid_price[0]; tick.BidVolume1 = record.bid_volume[0];
+	tick.BidPrice2 = record.bid_price[1]; tick.BidVolume2 = record.bid_volume[1];
+	tick.BidPrice3 = record.bid_price[2]; tick.BidVolume3 = record.bid_volume[2];
+	tick.BidPrice4 = record.bid_price[3]; tick.BidVolume4 = record.bid_volume[3];
+	tick.BidPrice5 = record.bid_price[4]; tick.BidVolume5 = record.bid_volume[4];
+	tick.AskPrice1 = record.ask_price[0]; tick.AskVolume1 = record.ask_volume[0];
+	tick.AskPrice2 = record.ask_price[1]; tick.AskVolume2 = record.ask_volume[1];
+	tick.AskPrice3 = record.ask_price[2]; tick.AskVolume3 = record.ask_volume[2];
+	tick.AskPrice4 = record.ask_price[3]; tick.AskVolume4 = record.ask_volume[3];
+	tick.AskPrice5 = record.ask_price[4]; tick.AskVolume5 = record.ask_volume[4];
+	//和ctp_api_market落盘时的tick_extend顺序一致
+	tick.OpenPrice = record.extend[0];
+	tick.ClosePrice = record.extend[1];
+	tick.HighestPrice = record.extend[2];
+	tick.LowestPrice = record.extend[3];
+	tick.UpperLimitPrice = record.extend[4];
+	tick.LowerLimitPrice = record.extend[5];
+	tick.PreSettlementPrice = record.extend[6];
+	loopback_tick_hook hook = _tick_hook.load(std::memory_order_relaxed);
+	if (hook)
+	{
+		hook(&tick);
+	}
+	spi->OnRtnDepthMarketData(&tick);
+}
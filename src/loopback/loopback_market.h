@@ -0,0 +1,90 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include "loopback_api.h"
+#include "callback_dispatcher.hpp"
+#include "tick_feed.hpp"
+
+namespace lt::loopback
+{
+	/*
+	*	回环行情柜台
+	*	登录以后按固定间隔推送订阅合约的行情（见tick_feed）
+	*/
+	class loopback_market : public CThostFtdcMdApi
+	{
+	private:
+
+		std::atomic<CThostFtdcMdSpi*> _spi;
+
+		callback_dispatcher _dispatcher;
+
+		char _trading_day[9];
+
+		tick_feed _feed;
+
+	public:
+
+		loopback_market();
+
+		virtual ~loopback_market();
+
+	public:
+
+		virtual void Release() override;
+
+		virtual void Init() override;
+
+		virtual int Join() override;
+
+		virtual const char* GetTradingDay() override;
+
+		virtual void RegisterFront(char* pszFrontAddress) override {}
+
+		virtual void RegisterNameServer(char* pszNsAddress) override {}
+
+		virtual void RegisterFensUserInfo(CThostFtdcFensUserInfoField* pFensUserInfo) override {}
+
+		virtual void RegisterSpi(CThostFtdcMdSpi* pSpi) override;
+
+		virtual int SubscribeMarketData(char* ppInstrumentID[], int nCount) override;
+
+		virtual int UnSubscribeMarketData(char* ppInstrumentID[], int nCount) override;
+
+		virtual int SubscribeForQuoteRsp(char* ppInstrumentID[], int nCount) override { return -1; }
+
+		virtual int UnSubscribeForQuoteRsp(char* ppInstrumentID[], int nCount) override { return -1; }
+
+		virtual int ReqUserLogin(CThostFtdcReqUserLoginField* pReqUserLoginField, int nRequestID) override;
+
+		virtual int ReqUserLogout(CThostFtdcUserLogoutField* pUserLogout, int nRequestID) override;
+
+		virtual int ReqQryMulticastInstrument(CThostFtdcQryMulticastInstrumentField* pQryMulticastInstrument, int nRequestID) override { return -1; }
+
+	private:
+
+		void start_feed();
+
+		void send_tick(const journal_record& record);
+	};
+}
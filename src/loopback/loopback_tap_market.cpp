@@ -0,0 +1,240 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "loopback_tap_market.h"
+#include <cstring>
+#include <ctime>
+#include <time_utils.hpp>
+
+using namespace lt;
+using namespace lt::loopback;
+
+namespace
+{
+	const std::chrono::microseconds SESSION_LATENCY(1000);
+
+	std::mutex _config_mutex;
+
+	std::string _journal_path;
+
+	uint32_t _interval_us = 0;
+
+	std::atomic<loopback_tap_tick_hook> _tick_hook(nullptr);
+}
+
+LOOPBACK_EXPORT void loopback_market_config(const char* journal_path, uint32_t interval_us)
+{
+	std::lock_guard<std::mutex> lock(_config_mutex);
+	_journal_path = journal_path ? journal_path : "";
+	_interval_us = interval_us;
+}
+
+LOOPBACK_EXPORT void loopback_market_hook(loopback_tap_tick_hook hook)
+{
+	_tick_hook = hook;
+}
+
+ITapQuoteAPI* TAP_CDECL CreateTapQuoteAPI(const TapAPIApplicationInfo* appInfo, TAPIINT32& iResult)
+{
+	iResult = TAPIERROR_SUCCEED;
+	return new loopback_tap_market();
+}
+
+void TAP_CDECL FreeTapQuoteAPI(ITapQuoteAPI* apiObj)
+{
+	delete static_cast<loopback_tap_market*>(apiObj);
+}
+
+const TAPICHAR* TAP_CDECL GetTapQuoteAPIVersion()
+{
+	return "loopback";
+}
+
+TAPIINT32 TAP_CDECL SetTapQuoteAPIDataPath(const TAPICHAR* path)
+{
+	return TAPIERROR_SUCCEED;
+}
+
+TAPIINT32 TAP_CDECL SetTapQuoteAPILogLevel(TAPILOGLEVEL level)
+{
+	return TAPIERROR_SUCCEED;
+}
+
+loopback_tap_market::loopback_tap_market() :
+	_notify(nullptr),
+	_session_id(0)
+{
+	const time_t now = time(nullptr);
+	tm local;
+#ifdef _WIN32
+	localtime_s(&local, &now);
+#else
+	localtime_r(&now, &local);
+#endif
+	strftime(_trading_day, sizeof(_trading_day), "%Y-%m-%d", &local);
+}
+
+loopback_tap_market::~loopback_tap_market()
+{
+	_feed.stop();
+	_dispatcher.stop();
+}
+
+TAPIINT32 loopback_tap_market::SetAPINotify(ITapQuoteAPINotify* apiNotify)
+{
+	_notify = apiNotify;
+	return TAPIERROR_SUCCEED;
+}
+
+TAPIINT32 loopback_tap_market::Login(const TapAPIQuoteLoginAuth* loginAuth)
+{
+	std::string journal_path;
+	{
+		std::lock_guard<std::mutex> lock(_config_mutex);
+		journal_path = _journal_path;
+	}
+	if (!journal_path.empty())
+	{
+		_feed.load(journal_path);
+	}
+	TapAPIQuotLoginRspInfo rsp;
+	memset(&rsp, 0, sizeof(rsp));
+	strncpy(rsp.UserNo, loginAuth->UserNo, sizeof(rsp.UserNo) - 1);
+	rsp.UserNo[sizeof(rsp.UserNo) - 1] = '\0';
+	strcpy(rsp.TradeDate, _trading_day);
+	_dispatcher.start();
+	_dispatcher.post(SESSION_LATENCY, [this, rsp]()->void {
+		if (auto notify = _notify.load())
+		{
+			notify->OnRspLogin(TAPIERROR_SUCCEED, &rsp);
+			notify->OnAPIReady();
+		}
+		start_feed();
+	});
+	return TAPIERROR_SUCCEED;
+}
+
+TAPIINT32 loopback_tap_market::Disconnect()
+{
+	_feed.stop();
+	return TAPIERROR_SUCCEED;
+}
+
+TAPIINT32 loopback_tap_market::SubscribeQuote(TAPIUINT32* sessionID, const TapAPIContract* contract)
+{
+	const TAPIUINT32 session_id = ++_session_id;
+	if (sessionID)
+	{
+		*sessionID = session_id;
+	}
+	_feed.subscribe(std::string(contract->Commodity.CommodityNo) + contract->ContractNo1, contract->Commodity.ExchangeNo);
+	TapAPIQuoteWhole whole;
+	memset(&whole, 0, sizeof(whole));
+	whole.Contract = *contract;
+	_dispatcher.post(SESSION_LATENCY, [this, session_id, whole]()->void {
+		if (auto notify = _notify.load())
+		{
+			notify->OnRspSubscribeQuote(session_id, TAPIERROR_SUCCEED, APIYNFLAG_YES, &whole);
+		}
+	});
+	return TAPIERROR_SUCCEED;
+}
+
+TAPIINT32 loopback_tap_market::UnSubscribeQuote(TAPIUINT32* sessionID, const TapAPIContract* contract)
+{
+	const TAPIUINT32 session_id = ++_session_id;
+	if (sessionID)
+	{
+		*sessionID = session_id;
+	}
+	_feed.unsubscribe(std::string(contract->Commodity.CommodityNo) + contract->ContractNo1);
+	TapAPIContract rsp = *contract;
+	_dispatcher.post(SESSION_LATENCY, [this, session_id, rsp]()->void {
+		if (auto notify = _notify.load())
+		{
+			notify->OnRspUnSubscribeQuote(session_id, TAPIERROR_SUCCEED, APIYNFLAG_YES, &rsp);
+		}
+	});
+	return TAPIERROR_SUCCEED;
+}
+
+void loopback_tap_market::start_feed()
+{
+	uint32_t interval_us = 0;
+	{
+		std::lock_guard<std::mutex> lock(_config_mutex);
+		interval_us = _interval_us;
+	}
+	_feed.start(date_to_uint(_trading_day), interval_us, [this](const journal_record& record)->void {
+		send_tick(record);
+	});
+}
+
+void loopback_tap_market::send_tick(const journal_record& record)
+{
+	auto notify = _notify.load();
+	if (notify == nullptr)
+	{
+		return;
+	}
+	TapAPIQuoteWhole tick;
+	memset(&tick, 0, sizeof(tick));
+	//和tap_api_market订阅时的合约拆分一致：品种 + 合约编号
+	const char* id = record.code.get_id();
+	const size_t cmdtid_length = strlen(record.code.get_cmdtid());
+	strncpy(tick.Contract.Commodity.ExchangeNo, record.code.get_excg(), sizeof(tick.Contract.Commodity.ExchangeNo) - 1);
+	tick.Contract.Commodity.CommodityType = TAPI_COMMODITY_TYPE_FUTURES;
+	strncpy(tick.Contract.Commodity.CommodityNo, record.code.get_cmdtid(), sizeof(tick.Contract.Commodity.CommodityNo) - 1);
+	strncpy(tick.Contract.ContractNo1, id + std::min(cmdtid_length, strlen(id)), sizeof(tick.Contract.ContractNo1) - 1);
+	tick.Contract.CallOrPutFlag1 = TAPI_CALLPUT_FLAG_NONE;
+	tick.Contract.CallOrPutFlag2 = TAPI_CALLPUT_FLAG_NONE;
+	//yyyy-MM-dd hh:nn:ss.xxx，tap_api_market从第11个字符开始取时间
+	const daytm_t real_time = daytm_really(record.time);
+	const uint32_t second = real_time / ONE_SECOND_MILLISECONDS;
+	snprintf(tick.DateTimeStamp, sizeof(tick.DateTimeStamp), "%04u-%02u-%02u %02u:%02u:%02u.%03u",
+		record.trading_day / 10000, record.trading_day / 100 % 100, record.trading_day % 100,
+		second / 3600, (second % 3600) / 60, second % 60, static_cast<uint32_t>(real_time % ONE_SECOND_MILLISECONDS));
+	tick.QLastPrice = record.price;
+	tick.QTotalQty = record.volume;
+	tick.QPositionQty = static_cast<TAPIQVOLUME>(record.open_interest);
+	for (size_t i = 0; i < JOURNAL_DEPTH; i++)
+	{
+		tick.QBidPrice[i] = record.bid_price[i];
+		tick.QBidQty[i] = record.bid_volume[i];
+		tick.QAskPrice[i] = record.ask_price[i];
+		tick.QAskQty[i] = record.ask_volume[i];
+	}
+	//和tap_api_market发出的tick_extend顺序一致
+	tick.QOpeningPrice = record.extend[0];
+	tick.QClosingPrice = record.extend[1];
+	tick.QHighPrice = record.extend[2];
+	tick.QLowPrice = record.extend[3];
+	tick.QLimitUpPrice = record.extend[4];
+	tick.QLimitDownPrice = record.extend[5];
+	tick.QPreSettlePrice = record.extend[6];
+	loopback_tap_tick_hook hook = _tick_hook.load(std::memory_order_relaxed);
+	if (hook)
+	{
+		hook(&tick);
+	}
+	notify->OnRtnQuote(&tick);
+}
@@ -0,0 +1,80 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include "loopback_api.h"
+#include "callback_dispatcher.hpp"
+#include "tick_feed.hpp"
+#include <TAP_V9_20200808/TapAPIError.h>
+
+namespace lt::loopback
+{
+	/*
+	*	TAP回环行情柜台
+	*	登录以后按固定间隔推送订阅合约的行情（见tick_feed），配置和CTP回环行情柜台一致
+	*/
+	class loopback_tap_market : public ITapQuoteAPI
+	{
+	private:
+
+		std::atomic<ITapQuoteAPINotify*> _notify;
+
+		callback_dispatcher _dispatcher;
+
+		//yyyy-MM-dd
+		TAPIDATE _trading_day;
+
+		std::atomic<TAPIUINT32> _session_id;
+
+		tick_feed _feed;
+
+	public:
+
+		loopback_tap_market();
+
+		virtual ~loopback_tap_market();
+
+	public:
+
+		virtual TAPIINT32 TAP_CDECL SetAPINotify(ITapQuoteAPINotify* apiNotify) override;
+
+		virtual TAPIINT32 TAP_CDECL SetHostAddress(const TAPICHAR* IP, TAPIUINT16 port) override { return TAPIERROR_SUCCEED; }
+
+		virtual TAPIINT32 TAP_CDECL Login(const TapAPIQuoteLoginAuth* loginAuth) override;
+
+		virtual TAPIINT32 TAP_CDECL Disconnect() override;
+
+		virtual TAPIINT32 TAP_CDECL QryCommodity(TAPIUINT32* sessionID) override { return -1; }
+
+		virtual TAPIINT32 TAP_CDECL QryContract(TAPIUINT32* sessionID, const TapAPICommodity* qryReq) override { return -1; }
+
+		virtual TAPIINT32 TAP_CDECL SubscribeQuote(TAPIUINT32* sessionID, const TapAPIContract* contract) override;
+
+		virtual TAPIINT32 TAP_CDECL UnSubscribeQuote(TAPIUINT32* sessionID, const TapAPIContract* contract) override;
+
+	private:
+
+		void start_feed();
+
+		void send_tick(const journal_record& record);
+	};
+}
@@ -0,0 +1,315 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "loopback_tap_trader.h"
+#include <cstring>
+#include <ctime>
+#include <atomic>
+
+using namespace lt::loopback;
+
+namespace
+{
+	//连接、登录、查询这些会话请求的回报延迟
+	const std::chrono::microseconds SESSION_LATENCY(1000);
+
+	std::atomic<uint32_t> _order_latency_us(100);
+
+	std::atomic<uint32_t> _trade_latency_us(100);
+
+	std::atomic<loopback_tap_order_hook> _order_hook(nullptr);
+
+	//yyyy-MM-dd hh:nn:ss
+	void format_now(char* time_buffer)
+	{
+		const time_t now = time(nullptr);
+		tm local;
+#ifdef _WIN32
+		localtime_s(&local, &now);
+#else
+		localtime_r(&now, &local);
+#endif
+		strftime(time_buffer, sizeof(TAPIDATETIME), "%Y-%m-%d %H:%M:%S", &local);
+	}
+}
+
+LOOPBACK_EXPORT void loopback_trader_config(uint32_t order_latency_us, uint32_t trade_latency_us)
+{
+	_order_latency_us = order_latency_us;
+	_trade_latency_us = trade_latency_us;
+}
+
+LOOPBACK_EXPORT void loopback_trader_hook(loopback_tap_order_hook hook)
+{
+	_order_hook = hook;
+}
+
+ITapTradeAPI* TAP_CDECL CreateTapTradeAPI(const TapAPIApplicationInfo* appInfo, TAPIINT32& iResult)
+{
+	iResult = TAPIERROR_SUCCEED;
+	return new loopback_tap_trader();
+}
+
+void TAP_CDECL FreeTapTradeAPI(ITapTradeAPI* apiObj)
+{
+	delete static_cast<loopback_tap_trader*>(apiObj);
+}
+
+const TAPICHAR* TAP_CDECL GetTapTradeAPIVersion()
+{
+	return "loopback";
+}
+
+TAPIINT32 TAP_CDECL SetTapTradeAPIDataPath(const TAPICHAR* path)
+{
+	return TAPIERROR_SUCCEED;
+}
+
+TAPIINT32 TAP_CDECL SetTapTradeAPILogLevel(TAPILOGLEVEL level)
+{
+	return TAPIERROR_SUCCEED;
+}
+
+loopback_tap_trader::loopback_tap_trader() :
+	_notify(nullptr),
+	_session_id(0),
+	_order_no(0)
+{
+	const time_t now = time(nullptr);
+	tm local;
+#ifdef _WIN32
+	localtime_s(&local, &now);
+#else
+	localtime_r(&now, &local);
+#endif
+	strftime(_trading_day, sizeof(_trading_day), "%Y-%m-%d", &local);
+}
+
+loopback_tap_trader::~loopback_tap_trader()
+{
+	_dispatcher.stop();
+}
+
+TAPIINT32 loopback_tap_trader::SetAPINotify(ITapTradeAPINotify* apiNotify)
+{
+	_notify = apiNotify;
+	return TAPIERROR_SUCCEED;
+}
+
+TAPIINT32 loopback_tap_trader::Login(const TapAPITradeLoginAuth* loginAuth)
+{
+	TapAPITradeLoginRspInfo rsp;
+	memset(&rsp, 0, sizeof(rsp));
+	strncpy(rsp.UserNo, loginAuth->UserNo, sizeof(rsp.UserNo) - 1);
+	rsp.UserNo[sizeof(rsp.UserNo) - 1] = '\0';
+	rsp.UserType = TAPI_USERTYPE_CLIENT;
+	strcpy(rsp.TradeDate, _trading_day);
+	format_now(rsp.LastLoginTime);
+	_dispatcher.start();
+	_dispatcher.post(SESSION_LATENCY, [this, rsp]()->void {
+		if (auto notify = _notify.load())
+		{
+			notify->OnConnect();
+			notify->OnRspLogin(TAPIERROR_SUCCEED, &rsp);
+			notify->OnAPIReady();
+		}
+	});
+	return TAPIERROR_SUCCEED;
+}
+
+TAPIINT32 loopback_tap_trader::Disconnect()
+{
+	return TAPIERROR_SUCCEED;
+}
+
+TAPIINT32 loopback_tap_trader::QryOrder(TAPIUINT32* sessionID, const TapAPIOrderQryReq* qryReq)
+{
+	const TAPIUINT32 session_id = next_session(sessionID);
+	_dispatcher.post(SESSION_LATENCY, [this, session_id]()->void {
+		auto notify = _notify.load();
+		if (notify == nullptr)
+		{
+			return;
+		}
+		if (_orders.empty())
+		{
+			notify->OnRspQryOrder(session_id, TAPIERROR_SUCCEED, APIYNFLAG_YES, nullptr);
+			return;
+		}
+		size_t index = 0;
+		for (auto& it : _orders)
+		{
+			notify->OnRspQryOrder(session_id, TAPIERROR_SUCCEED, ++index == _orders.size() ? APIYNFLAG_YES : APIYNFLAG_NO, &it.second);
+		}
+	});
+	return TAPIERROR_SUCCEED;
+}
+
+TAPIINT32 loopback_tap_trader::QryPosition(TAPIUINT32* sessionID, const TapAPIPositionQryReq* qryReq)
+{
+	const TAPIUINT32 session_id = next_session(sessionID);
+	_dispatcher.post(SESSION_LATENCY, [this, session_id]()->void {
+		if (auto notify = _notify.load())
+		{
+			notify->OnRspQryPosition(session_id, TAPIERROR_SUCCEED, APIYNFLAG_YES, nullptr);
+		}
+	});
+	return TAPIERROR_SUCCEED;
+}
+
+TAPIINT32 loopback_tap_trader::InsertOrder(TAPIUINT32* sessionID, const TapAPINewOrder* order)
+{
+	loopback_tap_order_hook hook = _order_hook.load(std::memory_order_relaxed);
+	if (hook)
+	{
+		hook(order);
+	}
+	const TAPIUINT32 session_id = next_session(sessionID);
+	TapAPINewOrder input = *order;
+	_dispatcher.post(std::chrono::microseconds(_order_latency_us.load()), [this, input, session_id]()->void {
+		handle_insert(input, session_id);
+	});
+	return TAPIERROR_SUCCEED;
+}
+
+TAPIINT32 loopback_tap_trader::CancelOrder(TAPIUINT32* sessionID, const TapAPIOrderCancelReq* order)
+{
+	const TAPIUINT32 session_id = next_session(sessionID);
+	TapAPIOrderCancelReq cancel = *order;
+	_dispatcher.post(std::chrono::microseconds(_order_latency_us.load()), [this, cancel, session_id]()->void {
+		handle_cancel(cancel, session_id);
+	});
+	return TAPIERROR_SUCCEED;
+}
+
+TAPIUINT32 loopback_tap_trader::next_session(TAPIUINT32* sessionID)
+{
+	const TAPIUINT32 session_id = ++_session_id;
+	if (sessionID)
+	{
+		*sessionID = session_id;
+	}
+	return session_id;
+}
+
+void loopback_tap_trader::handle_insert(const TapAPINewOrder& input, TAPIUINT32 session_id)
+{
+	char order_no[sizeof(TAPISTR_20)];
+	snprintf(order_no, sizeof(order_no), "%u", ++_order_no);
+	auto& order = _orders[order_no];
+	memset(&order, 0, sizeof(order));
+	strcpy(order.AccountNo, input.AccountNo);
+	strcpy(order.ExchangeNo, input.ExchangeNo);
+	order.CommodityType = input.CommodityType;
+	strcpy(order.CommodityNo, input.CommodityNo);
+	strcpy(order.ContractNo, input.ContractNo);
+	order.CallOrPutFlag = input.CallOrPutFlag;
+	order.CallOrPutFlag2 = input.CallOrPutFlag2;
+	order.OrderType = input.OrderType;
+	order.OrderSource = input.OrderSource;
+	order.TimeInForce = input.TimeInForce;
+	order.IsRiskOrder = input.IsRiskOrder;
+	order.OrderSide = input.OrderSide;
+	order.PositionEffect = input.PositionEffect;
+	order.PositionEffect2 = input.PositionEffect2;
+	order.HedgeFlag = input.HedgeFlag;
+	order.OrderPrice = input.OrderPrice;
+	order.OrderQty = input.OrderQty;
+	order.RefInt = input.RefInt;
+	strcpy(order.RefString, input.RefString);
+	order.ServerFlag = 'A';
+	strcpy(order.OrderNo, order_no);
+	strcpy(order.OrderSystemNo, order_no);
+	format_now(order.OrderInsertTime);
+	strcpy(order.OrderUpdateTime, order.OrderInsertTime);
+	order.OrderState = TAPI_ORDER_STATE_QUEUED;
+	order.OrderMatchQty = 0;
+	order.ErrorCode = TAPIERROR_SUCCEED;
+	TapAPIOrderInfo notice = order;
+	notify_order(notice, session_id);
+	if (input.TimeInForce == TAPI_ORDER_TIMEINFORCE_FAK || input.TimeInForce == TAPI_ORDER_TIMEINFORCE_FOK)
+	{
+		std::string key(order_no);
+		_dispatcher.post(std::chrono::microseconds(_trade_latency_us.load()), [this, key, session_id]()->void {
+			handle_trade(key, session_id);
+		});
+	}
+}
+
+void loopback_tap_trader::handle_trade(const std::string& order_no, TAPIUINT32 session_id)
+{
+	auto it = _orders.find(order_no);
+	if (it == _orders.end())
+	{
+		return;
+	}
+	TapAPIOrderInfo order = it->second;
+	_orders.erase(it);
+	order.OrderMatchPrice = order.OrderPrice;
+	order.OrderMatchQty = order.OrderQty;
+	order.OrderState = TAPI_ORDER_STATE_FINISHED;
+	format_now(order.OrderUpdateTime);
+	notify_order(order, session_id);
+}
+
+void loopback_tap_trader::handle_cancel(const TapAPIOrderCancelReq& cancel, TAPIUINT32 session_id)
+{
+	auto notify = _notify.load();
+	auto it = _orders.find(cancel.OrderNo);
+	if (it == _orders.end())
+	{
+		if (notify)
+		{
+			TapAPIOrderActionRsp rsp;
+			rsp.ActionType = APIORDER_DELETE;
+			rsp.OrderInfo = nullptr;
+			//委托已经完成或者已经撤销，状态不允许撤单
+			notify->OnRspOrderAction(session_id, TAPIERROR_ORDERDELETE_NOT_STATE, &rsp);
+		}
+		return;
+	}
+	TapAPIOrderInfo order = it->second;
+	_orders.erase(it);
+	order.OrderCanceledQty = order.OrderQty - order.OrderMatchQty;
+	order.OrderState = TAPI_ORDER_STATE_CANCELED;
+	format_now(order.OrderUpdateTime);
+	if (notify)
+	{
+		TapAPIOrderActionRsp rsp;
+		rsp.ActionType = APIORDER_DELETE;
+		rsp.OrderInfo = &order;
+		notify->OnRspOrderAction(session_id, TAPIERROR_SUCCEED, &rsp);
+	}
+	notify_order(order, session_id);
+}
+
+void loopback_tap_trader::notify_order(TapAPIOrderInfo& order, TAPIUINT32 session_id)
+{
+	if (auto notify = _notify.load())
+	{
+		TapAPIOrderInfoNotice notice;
+		notice.SessionID = session_id;
+		notice.ErrorCode = TAPIERROR_SUCCEED;
+		notice.OrderInfo = &order;
+		notify->OnRtnOrder(&notice);
+	}
+}
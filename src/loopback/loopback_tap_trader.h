@@ -0,0 +1,114 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include "loopback_api.h"
+#include "callback_dispatcher.hpp"
+#include <TAP_V9_20200808/TapAPIError.h>
+#include <map>
+#include <string>
+
+namespace lt::loopback
+{
+	/*
+	*	TAP回环交易柜台
+	*	行为和CTP回环交易柜台一致：报单、撤单在回调线程按配置的延迟回报；FAK/FOK报单回报以后全部成交，普通报单挂单直到撤销
+	*	不计算资金和持仓，查询持仓返回空，查询委托返回挂单
+	*/
+	class loopback_tap_trader : public ITapTradeAPI
+	{
+	private:
+
+		std::atomic<ITapTradeAPINotify*> _notify;
+
+		callback_dispatcher _dispatcher;
+
+		//yyyy-MM-dd
+		TAPIDATE _trading_day;
+
+		std::atomic<TAPIUINT32> _session_id;
+
+		//OrderNo -> 委托，只在回调线程访问
+		std::map<std::string, TapAPIOrderInfo> _orders;
+
+		uint32_t _order_no;
+
+	public:
+
+		loopback_tap_trader();
+
+		virtual ~loopback_tap_trader();
+
+	public:
+
+		virtual TAPIINT32 TAP_CDECL SetAPINotify(ITapTradeAPINotify* apiNotify) override;
+
+		virtual TAPIINT32 TAP_CDECL SetHostAddress(const TAPICHAR* IP, TAPIUINT16 port) override { return TAPIERROR_SUCCEED; }
+
+		virtual TAPIINT32 TAP_CDECL Login(const TapAPITradeLoginAuth* loginAuth) override;
+
+		virtual TAPIINT32 TAP_CDECL Disconnect() override;
+
+		virtual TAPIINT32 TAP_CDECL InsertOrder(TAPIUINT32* sessionID, const TapAPINewOrder* order) override;
+
+		virtual TAPIINT32 TAP_CDECL CancelOrder(TAPIUINT32* sessionID, const TapAPIOrderCancelReq* order) override;
+
+		virtual TAPIINT32 TAP_CDECL QryOrder(TAPIUINT32* sessionID, const TapAPIOrderQryReq* qryReq) override;
+
+		virtual TAPIINT32 TAP_CDECL QryPosition(TAPIUINT32* sessionID, const TapAPIPositionQryReq* qryReq) override;
+
+		//回环柜台不支持的接口
+	public:
+
+		virtual TAPIINT32 TAP_CDECL ChangePassword(TAPIUINT32* sessionID, const TapAPIChangePasswordReq* req) override { return -1; }
+		virtual TAPIINT32 TAP_CDECL HaveCertainRight(TAPIRightIDType rightID) override { return -1; }
+		virtual TAPIINT32 TAP_CDECL SetReservedInfo(TAPIUINT32* sessionID, const TAPISTR_50 info) override { return -1; }
+		virtual TAPIINT32 TAP_CDECL QryAccount(TAPIUINT32* sessionID, const TapAPIAccQryReq* qryReq) override { return -1; }
+		virtual TAPIINT32 TAP_CDECL QryFund(TAPIUINT32* sessionID, const TapAPIFundReq* qryReq) override { return -1; }
+		virtual TAPIINT32 TAP_CDECL QryExchange(TAPIUINT32* sessionID) override { return -1; }
+		virtual TAPIINT32 TAP_CDECL QryCommodity(TAPIUINT32* sessionID) override { return -1; }
+		virtual TAPIINT32 TAP_CDECL QryContract(TAPIUINT32* sessionID, const TapAPICommodity* qryReq) override { return -1; }
+		virtual TAPIINT32 TAP_CDECL QryOrderProcess(TAPIUINT32* sessionID, const TapAPIOrderProcessQryReq* qryReq) override { return -1; }
+		virtual TAPIINT32 TAP_CDECL QryFill(TAPIUINT32* sessionID, const TapAPIFillQryReq* qryReq) override { return -1; }
+		virtual TAPIINT32 TAP_CDECL QryClose(TAPIUINT32* sessionID, const TapAPICloseQryReq* qryReq) override { return -1; }
+		virtual TAPIINT32 TAP_CDECL QryDeepQuote(TAPIUINT32* sessionID, const TapAPIContract* qryReq) override { return -1; }
+		virtual TAPIINT32 TAP_CDECL QryExchangeStateInfo(TAPIUINT32* sessionID, const TapAPIExchangeStateInfoQryReq* qryReq) override { return -1; }
+		virtual TAPIINT32 TAP_CDECL QryUpperChannel(TAPIUINT32* sessionID, const TapAPIUpperChannelQryReq* qryReq) override { return -1; }
+		virtual TAPIINT32 TAP_CDECL QryAccountRent(TAPIUINT32* sessionID, const TapAPIAccountRentQryReq* qryReq) override { return -1; }
+		virtual TAPIINT32 TAP_CDECL ActivateOrder(TAPIUINT32* sessionID, const TapAPIOrderActivateReq* qryReq) override { return -1; }
+		virtual TAPIINT32 TAP_CDECL SubmitUserLoginInfo(TAPIUINT32* sessionID, const TapAPISubmitUserLoginInfo* qryReq) override { return -1; }
+		virtual TAPIINT32 TAP_CDECL QryBill(TAPIUINT32* sessionID, const TapAPIBillQryReq* qryReq) override { return -1; }
+		virtual TAPIINT32 TAP_CDECL QryAccountStorage(TAPIUINT32* sessionID, const TapAPIAccountStorageQryReq* qryReq) override { return -1; }
+
+	private:
+
+		TAPIUINT32 next_session(TAPIUINT32* sessionID);
+
+		void handle_insert(const TapAPINewOrder& input, TAPIUINT32 session_id);
+
+		void handle_trade(const std::string& order_no, TAPIUINT32 session_id);
+
+		void handle_cancel(const TapAPIOrderCancelReq& cancel, TAPIUINT32 session_id);
+
+		void notify_order(TapAPIOrderInfo& order, TAPIUINT32 session_id);
+	};
+}
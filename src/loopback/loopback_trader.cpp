@@ -0,0 +1,369 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "loopback_trader.h"
+#include <cstring>
+#include <ctime>
+#include <atomic>
+
+using namespace lt::loopback;
+
+namespace
+{
+	//连接、登录、查询这些会话请求的回报延迟
+	const std::chrono::microseconds SESSION_LATENCY(1000);
+
+	std::atomic<uint32_t> _order_latency_us(100);
+
+	std::atomic<uint32_t> _trade_latency_us(100);
+
+	std::atomic<loopback_order_hook> _order_hook(nullptr);
+
+	void format_now(char* time_buffer)
+	{
+		const time_t now = time(nullptr);
+		tm local;
+#ifdef _WIN32
+		localtime_s(&local, &now);
+#else
+		localtime_r(&now, &local);
+#endif
+		strftime(time_buffer, sizeof(TThostFtdcTimeType), "%H:%M:%S", &local);
+	}
+}
+
+LOOPBACK_EXPORT void loopback_trader_config(uint32_t order_latency_us, uint32_t trade_latency_us)
+{
+	_order_latency_us = order_latency_us;
+	_trade_latency_us = trade_latency_us;
+}
+
+LOOPBACK_EXPORT void loopback_trader_hook(loopback_order_hook hook)
+{
+	_order_hook = hook;
+}
+
+CThostFtdcTraderApi* CThostFtdcTraderApi::CreateFtdcTraderApi(const char* pszFlowPath)
+{
+	return new loopback_trader();
+}
+
+const char* CThostFtdcTraderApi::GetApiVersion()
+{
+	return "loopback";
+}
+
+loopback_trader::loopback_trader() :
+	_spi(nullptr),
+	_front_id(1),
+	_session_id(0),
+	_order_sysid(0),
+	_trade_id(0)
+{
+	const time_t now = time(nullptr);
+	tm local;
+#ifdef _WIN32
+	localtime_s(&local, &now);
+#else
+	localtime_r(&now, &local);
+#endif
+	strftime(_trading_day, sizeof(_trading_day), "%Y%m%d", &local);
+	_session_id = static_cast<int>(now & 0x7FFFFFFF);
+}
+
+loopback_trader::~loopback_trader()
+{
+	_dispatcher.stop();
+}
+
+void loopback_trader::Release()
+{
+	delete this;
+}
+
+void loopback_trader::Init()
+{
+	_dispatcher.start();
+	_dispatcher.post(std::chrono::milliseconds(10), [this]()->void {
+		if (auto spi = _spi.load())
+		{
+			spi->OnFrontConnected();
+		}
+	});
+}
+
+int loopback_trader::Join()
+{
+	return 0;
+}
+
+const char* loopback_trader::GetTradingDay()
+{
+	return _trading_day;
+}
+
+void loopback_trader::RegisterSpi(CThostFtdcTraderSpi* pSpi)
+{
+	_spi = pSpi;
+}
+
+int loopback_trader::ReqAuthenticate(CThostFtdcReqAuthenticateField* pReqAuthenticateField, int nRequestID)
+{
+	CThostFtdcRspAuthenticateField rsp;
+	memset(&rsp, 0, sizeof(rsp));
+	strcpy(rsp.BrokerID, pReqAuthenticateField->BrokerID);
+	strcpy(rsp.UserID, pReqAuthenticateField->UserID);
+	strcpy(rsp.AppID, pReqAuthenticateField->AppID);
+	_dispatcher.post(SESSION_LATENCY, [this, rsp, nRequestID]()mutable->void {
+		if (auto spi = _spi.load())
+		{
+			CThostFtdcRspInfoField info;
+			memset(&info, 0, sizeof(info));
+			spi->OnRspAuthenticate(&rsp, &info, nRequestID, true);
+		}
+	});
+	return 0;
+}
+
+int loopback_trader::ReqUserLogin(CThostFtdcReqUserLoginField* pReqUserLoginField, int nRequestID)
+{
+	CThostFtdcRspUserLoginField rsp;
+	memset(&rsp, 0, sizeof(rsp));
+	strcpy(rsp.TradingDay, _trading_day);
+	format_now(rsp.LoginTime);
+	strcpy(rsp.BrokerID, pReqUserLoginField->BrokerID);
+	strcpy(rsp.UserID, pReqUserLoginField->UserID);
+	strcpy(rsp.SystemName, "loopback");
+	rsp.FrontID = _front_id;
+	rsp.SessionID = _session_id;
+	strcpy(rsp.MaxOrderRef, "0");
+	_dispatcher.post(SESSION_LATENCY, [this, rsp, nRequestID]()mutable->void {
+		if (auto spi = _spi.load())
+		{
+			CThostFtdcRspInfoField info;
+			memset(&info, 0, sizeof(info));
+			spi->OnRspUserLogin(&rsp, &info, nRequestID, true);
+		}
+	});
+	return 0;
+}
+
+int loopback_trader::ReqUserLogout(CThostFtdcUserLogoutField* pUserLogout, int nRequestID)
+{
+	CThostFtdcUserLogoutField rsp = *pUserLogout;
+	_dispatcher.post(SESSION_LATENCY, [this, rsp, nRequestID]()mutable->void {
+		if (auto spi = _spi.load())
+		{
+			spi->OnRspUserLogout(&rsp, nullptr, nRequestID, true);
+		}
+	});
+	return 0;
+}
+
+int loopback_trader::ReqSettlementInfoConfirm(CThostFtdcSettlementInfoConfirmField* pSettlementInfoConfirm, int nRequestID)
+{
+	CThostFtdcSettlementInfoConfirmField rsp = *pSettlementInfoConfirm;
+	strcpy(rsp.ConfirmDate, _trading_day);
+	format_now(rsp.ConfirmTime);
+	_dispatcher.post(SESSION_LATENCY, [this, rsp, nRequestID]()mutable->void {
+		if (auto spi = _spi.load())
+		{
+			spi->OnRspSettlementInfoConfirm(&rsp, nullptr, nRequestID, true);
+		}
+	});
+	return 0;
+}
+
+int loopback_trader::ReqQryOrder(CThostFtdcQryOrderField* pQryOrder, int nRequestID)
+{
+	_dispatcher.post(SESSION_LATENCY, [this, nRequestID]()->void {
+		auto spi = _spi.load();
+		if (spi == nullptr)
+		{
+			return;
+		}
+		if (_orders.empty())
+		{
+			spi->OnRspQryOrder(nullptr, nullptr, nRequestID, true);
+			return;
+		}
+		size_t index = 0;
+		for (auto& it : _orders)
+		{
+			spi->OnRspQryOrder(&it.second, nullptr, nRequestID, ++index == _orders.size());
+		}
+	});
+	return 0;
+}
+
+int loopback_trader::ReqQryInvestorPosition(CThostFtdcQryInvestorPositionField* pQryInvestorPosition, int nRequestID)
+{
+	_dispatcher.post(SESSION_LATENCY, [this, nRequestID]()->void {
+		if (auto spi = _spi.load())
+		{
+			spi->OnRspQryInvestorPosition(nullptr, nullptr, nRequestID, true);
+		}
+	});
+	return 0;
+}
+
+int loopback_trader::ReqOrderInsert(CThostFtdcInputOrderField* pInputOrder, int nRequestID)
+{
+	loopback_order_hook hook = _order_hook.load(std::memory_order_relaxed);
+	if (hook)
+	{
+		hook(pInputOrder);
+	}
+	CThostFtdcInputOrderField input = *pInputOrder;
+	_dispatcher.post(std::chrono::microseconds(_order_latency_us.load()), [this, input]()->void {
+		handle_insert(input);
+	});
+	return 0;
+}
+
+int loopback_trader::ReqOrderAction(CThostFtdcInputOrderActionField* pInputOrderAction, int nRequestID)
+{
+	CThostFtdcInputOrderActionField action = *pInputOrderAction;
+	_dispatcher.post(std::chrono::microseconds(_order_latency_us.load()), [this, action, nRequestID]()->void {
+		handle_action(action, nRequestID);
+	});
+	return 0;
+}
+
+void loopback_trader::handle_insert(const CThostFtdcInputOrderField& input)
+{
+	order_key key(_front_id, _session_id, input.OrderRef);
+	auto& order = _orders[key];
+	memset(&order, 0, sizeof(order));
+	strcpy(order.BrokerID, input.BrokerID);
+	strcpy(order.InvestorID, input.InvestorID);
+	strcpy(order.InstrumentID, input.InstrumentID);
+	strcpy(order.ExchangeID, input.ExchangeID);
+	strcpy(order.OrderRef, input.OrderRef);
+	strcpy(order.UserID, input.InvestorID);
+	order.OrderPriceType = input.OrderPriceType;
+	order.Direction = input.Direction;
+	order.CombOffsetFlag[0] = input.CombOffsetFlag[0];
+	order.CombHedgeFlag[0] = input.CombHedgeFlag[0];
+	order.LimitPrice = input.LimitPrice;
+	order.VolumeTotalOriginal = input.VolumeTotalOriginal;
+	order.TimeCondition = input.TimeCondition;
+	order.VolumeCondition = input.VolumeCondition;
+	order.MinVolume = input.MinVolume;
+	order.ContingentCondition = input.ContingentCondition;
+	order.ForceCloseReason = input.ForceCloseReason;
+	snprintf(order.OrderSysID, sizeof(order.OrderSysID), "%12d", ++_order_sysid);
+	order.OrderSubmitStatus = THOST_FTDC_OSS_Accepted;
+	order.OrderStatus = THOST_FTDC_OST_NoTradeQueueing;
+	strcpy(order.TradingDay, _trading_day);
+	strcpy(order.InsertDate, _trading_day);
+	format_now(order.InsertTime);
+	order.FrontID = _front_id;
+	order.SessionID = _session_id;
+	order.VolumeTraded = 0;
+	order.VolumeTotal = input.VolumeTotalOriginal;
+	if (auto spi = _spi.load())
+	{
+		CThostFtdcOrderField notice = order;
+		spi->OnRtnOrder(&notice);
+	}
+	if (input.TimeCondition == THOST_FTDC_TC_IOC)
+	{
+		_dispatcher.post(std::chrono::microseconds(_trade_latency_us.load()), [this, key]()->void {
+			handle_trade(key);
+		});
+	}
+}
+
+void loopback_trader::handle_trade(const order_key& key)
+{
+	auto it = _orders.find(key);
+	if (it == _orders.end())
+	{
+		return;
+	}
+	CThostFtdcOrderField order = it->second;
+	_orders.erase(it);
+	CThostFtdcTradeField trade;
+	memset(&trade, 0, sizeof(trade));
+	strcpy(trade.BrokerID, order.BrokerID);
+	strcpy(trade.InvestorID, order.InvestorID);
+	strcpy(trade.InstrumentID, order.InstrumentID);
+	strcpy(trade.ExchangeID, order.ExchangeID);
+	strcpy(trade.OrderRef, order.OrderRef);
+	strcpy(trade.UserID, order.UserID);
+	strcpy(trade.OrderSysID, order.OrderSysID);
+	snprintf(trade.TradeID, sizeof(trade.TradeID), "%20d", ++_trade_id);
+	trade.Direction = order.Direction;
+	trade.OffsetFlag = order.CombOffsetFlag[0];
+	trade.HedgeFlag = order.CombHedgeFlag[0];
+	trade.Price = order.LimitPrice;
+	trade.Volume = order.VolumeTotal;
+	strcpy(trade.TradeDate, _trading_day);
+	strcpy(trade.TradingDay, _trading_day);
+	format_now(trade.TradeTime);
+	order.VolumeTraded = order.VolumeTotalOriginal;
+	order.VolumeTotal = 0;
+	order.OrderStatus = THOST_FTDC_OST_AllTraded;
+	if (auto spi = _spi.load())
+	{
+		spi->OnRtnOrder(&order);
+		spi->OnRtnTrade(&trade);
+	}
+}
+
+void loopback_trader::handle_action(const CThostFtdcInputOrderActionField& action, int request_id)
+{
+	auto it = _orders.find(order_key(action.FrontID, action.SessionID, action.OrderRef));
+	if (it == _orders.end())
+	{
+		if (auto spi = _spi.load())
+		{
+			CThostFtdcOrderActionField notice;
+			memset(&notice, 0, sizeof(notice));
+			strcpy(notice.BrokerID, action.BrokerID);
+			strcpy(notice.InvestorID, action.InvestorID);
+			strcpy(notice.OrderRef, action.OrderRef);
+			strcpy(notice.InstrumentID, action.InstrumentID);
+			strcpy(notice.ExchangeID, action.ExchangeID);
+			notice.FrontID = action.FrontID;
+			notice.SessionID = action.SessionID;
+			notice.ActionFlag = action.ActionFlag;
+			notice.RequestID = request_id;
+			CThostFtdcRspInfoField info;
+			memset(&info, 0, sizeof(info));
+			//CTP错误码26：报单已全成交或已撤销，不能再撤
+			info.ErrorID = 26;
+			strcpy(info.ErrorMsg, "loopback order not found");
+			spi->OnErrRtnOrderAction(&notice, &info);
+		}
+		return;
+	}
+	CThostFtdcOrderField order = it->second;
+	_orders.erase(it);
+	order.OrderStatus = THOST_FTDC_OST_Canceled;
+	format_now(order.CancelTime);
+	if (auto spi = _spi.load())
+	{
+		spi->OnRtnOrder(&order);
+	}
+}
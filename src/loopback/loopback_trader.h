@@ -0,0 +1,204 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include "loopback_api.h"
+#include "callback_dispatcher.hpp"
+#include <map>
+#include <string>
+#include <tuple>
+
+namespace lt::loopback
+{
+	/*
+	*	回环交易柜台
+	*	报单、撤单在回调线程按配置的延迟回报；FAK/FOK报单回报以后全部成交，普通报单挂单直到撤销
+	*	不计算资金和持仓，查询持仓返回空，查询委托返回挂单
+	*/
+	class loopback_trader : public CThostFtdcTraderApi
+	{
+		//FrontID SessionID OrderRef
+		typedef std::tuple<int, int, std::string> order_key;
+
+	private:
+
+		std::atomic<CThostFtdcTraderSpi*> _spi;
+
+		callback_dispatcher _dispatcher;
+
+		char _trading_day[9];
+
+		int _front_id;
+
+		int _session_id;
+
+		//只在回调线程访问
+		std::map<order_key, CThostFtdcOrderField> _orders;
+
+		int _order_sysid;
+
+		int _trade_id;
+
+	public:
+
+		loopback_trader();
+
+		virtual ~loopback_trader();
+
+	public:
+
+		virtual void Release() override;
+
+		virtual void Init() override;
+
+		virtual int Join() override;
+
+		virtual const char* GetTradingDay() override;
+
+		virtual void RegisterFront(char* pszFrontAddress) override {}
+
+		virtual void RegisterSpi(CThostFtdcTraderSpi* pSpi) override;
+
+		virtual void SubscribePrivateTopic(THOST_TE_RESUME_TYPE nResumeType) override {}
+
+		virtual void SubscribePublicTopic(THOST_TE_RESUME_TYPE nResumeType) override {}
+
+		virtual int ReqAuthenticate(CThostFtdcReqAuthenticateField* pReqAuthenticateField, int nRequestID) override;
+
+		virtual int ReqUserLogin(CThostFtdcReqUserLoginField* pReqUserLoginField, int nRequestID) override;
+
+		virtual int ReqUserLogout(CThostFtdcUserLogoutField* pUserLogout, int nRequestID) override;
+
+		virtual int ReqOrderInsert(CThostFtdcInputOrderField* pInputOrder, int nRequestID) override;
+
+		virtual int ReqOrderAction(CThostFtdcInputOrderActionField* pInputOrderAction, int nRequestID) override;
+
+		virtual int ReqSettlementInfoConfirm(CThostFtdcSettlementInfoConfirmField* pSettlementInfoConfirm, int nRequestID) override;
+
+		virtual int ReqQryOrder(CThostFtdcQryOrderField* pQryOrder, int nRequestID) override;
+
+		virtual int ReqQryInvestorPosition(CThostFtdcQryInvestorPositionField* pQryInvestorPosition, int nRequestID) override;
+
+		//回环柜台不支持的接口
+	public:
+
+		virtual void RegisterNameServer(char* pszNsAddress) override {}
+		virtual void RegisterFensUserInfo(CThostFtdcFensUserInfoField* pFensUserInfo) override {}
+		virtual int RegisterUserSystemInfo(CThostFtdcUserSystemInfoField* pUserSystemInfo) override { return -1; }
+		virtual int SubmitUserSystemInfo(CThostFtdcUserSystemInfoField* pUserSystemInfo) override { return -1; }
+		virtual int ReqUserPasswordUpdate(CThostFtdcUserPasswordUpdateField* pUserPasswordUpdate, int nRequestID) override { return -1; }
+		virtual int ReqTradingAccountPasswordUpdate(CThostFtdcTradingAccountPasswordUpdateField* pTradingAccountPasswordUpdate, int nRequestID) override { return -1; }
+		virtual int ReqUserAuthMethod(CThostFtdcReqUserAuthMethodField* pReqUserAuthMethod, int nRequestID) override { return -1; }
+		virtual int ReqGenUserCaptcha(CThostFtdcReqGenUserCaptchaField* pReqGenUserCaptcha, int nRequestID) override { return -1; }
+		virtual int ReqGenUserText(CThostFtdcReqGenUserTextField* pReqGenUserText, int nRequestID) override { return -1; }
+		virtual int ReqUserLoginWithCaptcha(CThostFtdcReqUserLoginWithCaptchaField* pReqUserLoginWithCaptcha, int nRequestID) override { return -1; }
+		virtual int ReqUserLoginWithText(CThostFtdcReqUserLoginWithTextField* pReqUserLoginWithText, int nRequestID) override { return -1; }
+		virtual int ReqUserLoginWithOTP(CThostFtdcReqUserLoginWithOTPField* pReqUserLoginWithOTP, int nRequestID) override { return -1; }
+		virtual int ReqParkedOrderInsert(CThostFtdcParkedOrderField* pParkedOrder, int nRequestID) override { return -1; }
+		virtual int ReqParkedOrderAction(CThostFtdcParkedOrderActionField* pParkedOrderAction, int nRequestID) override { return -1; }
+		virtual int ReqQryMaxOrderVolume(CThostFtdcQryMaxOrderVolumeField* pQryMaxOrderVolume, int nRequestID) override { return -1; }
+		virtual int ReqRemoveParkedOrder(CThostFtdcRemoveParkedOrderField* pRemoveParkedOrder, int nRequestID) override { return -1; }
+		virtual int ReqRemoveParkedOrderAction(CThostFtdcRemoveParkedOrderActionField* pRemoveParkedOrderAction, int nRequestID) override { return -1; }
+		virtual int ReqExecOrderInsert(CThostFtdcInputExecOrderField* pInputExecOrder, int nRequestID) override { return -1; }
+		virtual int ReqExecOrderAction(CThostFtdcInputExecOrderActionField* pInputExecOrderAction, int nRequestID) override { return -1; }
+		virtual int ReqForQuoteInsert(CThostFtdcInputForQuoteField* pInputForQuote, int nRequestID) override { return -1; }
+		virtual int ReqQuoteInsert(CThostFtdcInputQuoteField* pInputQuote, int nRequestID) override { return -1; }
+		virtual int ReqQuoteAction(CThostFtdcInputQuoteActionField* pInputQuoteAction, int nRequestID) override { return -1; }
+		virtual int ReqBatchOrderAction(CThostFtdcInputBatchOrderActionField* pInputBatchOrderAction, int nRequestID) override { return -1; }
+		virtual int ReqOptionSelfCloseInsert(CThostFtdcInputOptionSelfCloseField* pInputOptionSelfClose, int nRequestID) override { return -1; }
+		virtual int ReqOptionSelfCloseAction(CThostFtdcInputOptionSelfCloseActionField* pInputOptionSelfCloseAction, int nRequestID) override { return -1; }
+		virtual int ReqCombActionInsert(CThostFtdcInputCombActionField* pInputCombAction, int nRequestID) override { return -1; }
+		virtual int ReqQryTrade(CThostFtdcQryTradeField* pQryTrade, int nRequestID) override { return -1; }
+		virtual int ReqQryTradingAccount(CThostFtdcQryTradingAccountField* pQryTradingAccount, int nRequestID) override { return -1; }
+		virtual int ReqQryInvestor(CThostFtdcQryInvestorField* pQryInvestor, int nRequestID) override { return -1; }
+		virtual int ReqQryTradingCode(CThostFtdcQryTradingCodeField* pQryTradingCode, int nRequestID) override { return -1; }
+		virtual int ReqQryInstrumentMarginRate(CThostFtdcQryInstrumentMarginRateField* pQryInstrumentMarginRate, int nRequestID) override { return -1; }
+		virtual int ReqQryInstrumentCommissionRate(CThostFtdcQryInstrumentCommissionRateField* pQryInstrumentCommissionRate, int nRequestID) override { return -1; }
+		virtual int ReqQryExchange(CThostFtdcQryExchangeField* pQryExchange, int nRequestID) override { return -1; }
+		virtual int ReqQryProduct(CThostFtdcQryProductField* pQryProduct, int nRequestID) override { return -1; }
+		virtual int ReqQryInstrument(CThostFtdcQryInstrumentField* pQryInstrument, int nRequestID) override { return -1; }
+		virtual int ReqQryDepthMarketData(CThostFtdcQryDepthMarketDataField* pQryDepthMarketData, int nRequestID) override { return -1; }
+		virtual int ReqQryTraderOffer(CThostFtdcQryTraderOfferField* pQryTraderOffer, int nRequestID) override { return -1; }
+		virtual int ReqQrySettlementInfo(CThostFtdcQrySettlementInfoField* pQrySettlementInfo, int nRequestID) override { return -1; }
+		virtual int ReqQryTransferBank(CThostFtdcQryTransferBankField* pQryTransferBank, int nRequestID) override { return -1; }
+		virtual int ReqQryInvestorPositionDetail(CThostFtdcQryInvestorPositionDetailField* pQryInvestorPositionDetail, int nRequestID) override { return -1; }
+		virtual int ReqQryNotice(CThostFtdcQryNoticeField* pQryNotice, int nRequestID) override { return -1; }
+		virtual int ReqQrySettlementInfoConfirm(CThostFtdcQrySettlementInfoConfirmField* pQrySettlementInfoConfirm, int nRequestID) override { return -1; }
+		virtual int ReqQryInvestorPositionCombineDetail(CThostFtdcQryInvestorPositionCombineDetailField* pQryInvestorPositionCombineDetail, int nRequestID) override { return -1; }
+		virtual int ReqQryCFMMCTradingAccountKey(CThostFtdcQryCFMMCTradingAccountKeyField* pQryCFMMCTradingAccountKey, int nRequestID) override { return -1; }
+		virtual int ReqQryEWarrantOffset(CThostFtdcQryEWarrantOffsetField* pQryEWarrantOffset, int nRequestID) override { return -1; }
+		virtual int ReqQryInvestorProductGroupMargin(CThostFtdcQryInvestorProductGroupMarginField* pQryInvestorProductGroupMargin, int nRequestID) override { return -1; }
+		virtual int ReqQryExchangeMarginRate(CThostFtdcQryExchangeMarginRateField* pQryExchangeMarginRate, int nRequestID) override { return -1; }
+		virtual int ReqQryExchangeMarginRateAdjust(CThostFtdcQryExchangeMarginRateAdjustField* pQryExchangeMarginRateAdjust, int nRequestID) override { return -1; }
+		virtual int ReqQryExchangeRate(CThostFtdcQryExchangeRateField* pQryExchangeRate, int nRequestID) override { return -1; }
+		virtual int ReqQrySecAgentACIDMap(CThostFtdcQrySecAgentACIDMapField* pQrySecAgentACIDMap, int nRequestID) override { return -1; }
+		virtual int ReqQryProductExchRate(CThostFtdcQryProductExchRateField* pQryProductExchRate, int nRequestID) override { return -1; }
+		virtual int ReqQryProductGroup(CThostFtdcQryProductGroupField* pQryProductGroup, int nRequestID) override { return -1; }
+		virtual int ReqQryMMInstrumentCommissionRate(CThostFtdcQryMMInstrumentCommissionRateField* pQryMMInstrumentCommissionRate, int nRequestID) override { return -1; }
+		virtual int ReqQryMMOptionInstrCommRate(CThostFtdcQryMMOptionInstrCommRateField* pQryMMOptionInstrCommRate, int nRequestID) override { return -1; }
+		virtual int ReqQryInstrumentOrderCommRate(CThostFtdcQryInstrumentOrderCommRateField* pQryInstrumentOrderCommRate, int nRequestID) override { return -1; }
+		virtual int ReqQrySecAgentTradingAccount(CThostFtdcQryTradingAccountField* pQryTradingAccount, int nRequestID) override { return -1; }
+		virtual int ReqQrySecAgentCheckMode(CThostFtdcQrySecAgentCheckModeField* pQrySecAgentCheckMode, int nRequestID) override { return -1; }
+		virtual int ReqQrySecAgentTradeInfo(CThostFtdcQrySecAgentTradeInfoField* pQrySecAgentTradeInfo, int nRequestID) override { return -1; }
+		virtual int ReqQryOptionInstrTradeCost(CThostFtdcQryOptionInstrTradeCostField* pQryOptionInstrTradeCost, int nRequestID) override { return -1; }
+		virtual int ReqQryOptionInstrCommRate(CThostFtdcQryOptionInstrCommRateField* pQryOptionInstrCommRate, int nRequestID) override { return -1; }
+		virtual int ReqQryExecOrder(CThostFtdcQryExecOrderField* pQryExecOrder, int nRequestID) override { return -1; }
+		virtual int ReqQryForQuote(CThostFtdcQryForQuoteField* pQryForQuote, int nRequestID) override { return -1; }
+		virtual int ReqQryQuote(CThostFtdcQryQuoteField* pQryQuote, int nRequestID) override { return -1; }
+		virtual int ReqQryOptionSelfClose(CThostFtdcQryOptionSelfCloseField* pQryOptionSelfClose, int nRequestID) override { return -1; }
+		virtual int ReqQryInvestUnit(CThostFtdcQryInvestUnitField* pQryInvestUnit, int nRequestID) override { return -1; }
+		virtual int ReqQryCombInstrumentGuard(CThostFtdcQryCombInstrumentGuardField* pQryCombInstrumentGuard, int nRequestID) override { return -1; }
+		virtual int ReqQryCombAction(CThostFtdcQryCombActionField* pQryCombAction, int nRequestID) override { return -1; }
+		virtual int ReqQryTransferSerial(CThostFtdcQryTransferSerialField* pQryTransferSerial, int nRequestID) override { return -1; }
+		virtual int ReqQryAccountregister(CThostFtdcQryAccountregisterField* pQryAccountregister, int nRequestID) override { return -1; }
+		virtual int ReqQryContractBank(CThostFtdcQryContractBankField* pQryContractBank, int nRequestID) override { return -1; }
+		virtual int ReqQryParkedOrder(CThostFtdcQryParkedOrderField* pQryParkedOrder, int nRequestID) override { return -1; }
+		virtual int ReqQryParkedOrderAction(CThostFtdcQryParkedOrderActionField* pQryParkedOrderAction, int nRequestID) override { return -1; }
+		virtual int ReqQryTradingNotice(CThostFtdcQryTradingNoticeField* pQryTradingNotice, int nRequestID) override { return -1; }
+		virtual int ReqQryBrokerTradingParams(CThostFtdcQryBrokerTradingParamsField* pQryBrokerTradingParams, int nRequestID) override { return -1; }
+		virtual int ReqQryBrokerTradingAlgos(CThostFtdcQryBrokerTradingAlgosField* pQryBrokerTradingAlgos, int nRequestID) override { return -1; }
+		virtual int ReqQueryCFMMCTradingAccountToken(CThostFtdcQueryCFMMCTradingAccountTokenField* pQueryCFMMCTradingAccountToken, int nRequestID) override { return -1; }
+		virtual int ReqFromBankToFutureByFuture(CThostFtdcReqTransferField* pReqTransfer, int nRequestID) override { return -1; }
+		virtual int ReqFromFutureToBankByFuture(CThostFtdcReqTransferField* pReqTransfer, int nRequestID) override { return -1; }
+		virtual int ReqQueryBankAccountMoneyByFuture(CThostFtdcReqQueryAccountField* pReqQueryAccount, int nRequestID) override { return -1; }
+		virtual int ReqQryClassifiedInstrument(CThostFtdcQryClassifiedInstrumentField* pQryClassifiedInstrument, int nRequestID) override { return -1; }
+		virtual int ReqQryCombPromotionParam(CThostFtdcQryCombPromotionParamField* pQryCombPromotionParam, int nRequestID) override { return -1; }
+		virtual int ReqQryRiskSettleInvstPosition(CThostFtdcQryRiskSettleInvstPositionField* pQryRiskSettleInvstPosition, int nRequestID) override { return -1; }
+		virtual int ReqQryRiskSettleProductStatus(CThostFtdcQryRiskSettleProductStatusField* pQryRiskSettleProductStatus, int nRequestID) override { return -1; }
+		virtual int ReqQrySPBMFutureParameter(CThostFtdcQrySPBMFutureParameterField* pQrySPBMFutureParameter, int nRequestID) override { return -1; }
+		virtual int ReqQrySPBMOptionParameter(CThostFtdcQrySPBMOptionParameterField* pQrySPBMOptionParameter, int nRequestID) override { return -1; }
+		virtual int ReqQrySPBMIntraParameter(CThostFtdcQrySPBMIntraParameterField* pQrySPBMIntraParameter, int nRequestID) override { return -1; }
+		virtual int ReqQrySPBMInterParameter(CThostFtdcQrySPBMInterParameterField* pQrySPBMInterParameter, int nRequestID) override { return -1; }
+		virtual int ReqQrySPBMPortfDefinition(CThostFtdcQrySPBMPortfDefinitionField* pQrySPBMPortfDefinition, int nRequestID) override { return -1; }
+		virtual int ReqQrySPBMInvestorPortfDef(CThostFtdcQrySPBMInvestorPortfDefField* pQrySPBMInvestorPortfDef, int nRequestID) override { return -1; }
+		virtual int ReqQryInvestorPortfMarginRatio(CThostFtdcQryInvestorPortfMarginRatioField* pQryInvestorPortfMarginRatio, int nRequestID) override { return -1; }
+		virtual int ReqQryInvestorProdSPBMDetail(CThostFtdcQryInvestorProdSPBMDetailField* pQryInvestorProdSPBMDetail, int nRequestID) override { return -1; }
+
+	private:
+
+		void handle_insert(const CThostFtdcInputOrderField& input);
+
+		void handle_trade(const order_key& key);
+
+		void handle_action(const CThostFtdcInputOrderActionField& action, int request_id);
+	};
+}
@@ -0,0 +1,244 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include <market_journal.hpp>
+#include <time_utils.hpp>
+#include <functional>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <atomic>
+
+namespace lt::loopback
+{
+	/*
+	*	回环行情源（和接口无关，CTP/TAP回环行情柜台共用）
+	*	在独立的行情线程按固定间隔输出订阅合约的行情记录，由柜台转换成各自接口的行情结构：
+	*	加载了行情日志时回放日志（间隔为0时按原始接收时间间隔），否则生成模拟行情
+	*/
+	class tick_feed
+	{
+	public:
+
+		typedef std::function<void(const journal_record&)> tick_sender;
+
+	private:
+
+		//模拟行情默认间隔
+		static constexpr uint32_t DEFAULT_INTERVAL_US = 1000;
+
+		std::thread* _thread;
+
+		std::atomic<bool> _is_runing;
+
+		std::mutex _mutex;
+
+		//合约代码 -> 交易所（CTP订阅不带交易所）
+		std::map<std::string, std::string> _subscribed;
+
+		std::vector<journal_record> _journal;
+
+	public:
+
+		tick_feed() :_thread(nullptr), _is_runing(false) {}
+
+		~tick_feed()
+		{
+			stop();
+		}
+
+		void load(const std::string& journal_path)
+		{
+			std::vector<std::filesystem::path> files;
+			for (const auto& entry : std::filesystem::directory_iterator(journal_path))
+			{
+				if (entry.is_regular_file() && entry.path().extension() == ".mj")
+				{
+					files.emplace_back(entry.path());
+				}
+			}
+			std::sort(files.begin(), files.end());
+			_journal.clear();
+			for (const auto& path : files)
+			{
+				std::ifstream file(path, std::ios::binary);
+				journal_header header;
+				if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != JOURNAL_MAGIC || header.record_size != sizeof(journal_record))
+				{
+					continue;
+				}
+				journal_record record;
+				while (file.read(reinterpret_cast<char*>(&record), sizeof(record)))
+				{
+					_journal.emplace_back(record);
+				}
+			}
+			std::stable_sort(_journal.begin(), _journal.end(), [](const journal_record& lh, const journal_record& rh)->bool {
+				return lh.receive_time < rh.receive_time;
+			});
+		}
+
+		void subscribe(const std::string& id, const std::string& excg)
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_subscribed[id] = excg;
+		}
+
+		void unsubscribe(const std::string& id)
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_subscribed.erase(id);
+		}
+
+		//sender在行情线程调用
+		void start(uint32_t trading_day, uint32_t interval_us, tick_sender sender)
+		{
+			if (_thread)
+			{
+				return;
+			}
+			_is_runing = true;
+			_thread = new std::thread([this, trading_day, interval_us, sender]()->void {
+				if (_journal.empty())
+				{
+					generate(trading_day, interval_us > 0 ? interval_us : DEFAULT_INTERVAL_US, sender);
+				}
+				else
+				{
+					replay(interval_us, sender);
+				}
+			});
+		}
+
+		void stop()
+		{
+			_is_runing = false;
+			if (_thread)
+			{
+				if (_thread->get_id() == std::this_thread::get_id())
+				{
+					_thread->detach();
+				}
+				else
+				{
+					_thread->join();
+				}
+				delete _thread;
+				_thread = nullptr;
+			}
+		}
+
+	private:
+
+		void replay(uint32_t interval_us, const tick_sender& sender)
+		{
+			auto next_time = std::chrono::steady_clock::now();
+			int64_t last_receive = _journal.front().receive_time;
+			for (size_t i = 0; i < _journal.size() && _is_runing; i++)
+			{
+				const auto& record = _journal[i];
+				if (!is_subscribed(record.code.get_id()))
+				{
+					continue;
+				}
+				//间隔为0时保持原始接收间隔
+				next_time += interval_us > 0 ? std::chrono::microseconds(interval_us) : std::chrono::microseconds((record.receive_time - last_receive) / 1000);
+				last_receive = record.receive_time;
+				next_time = wait_until(next_time);
+				sender(record);
+			}
+		}
+
+		void generate(uint32_t trading_day, uint32_t interval_us, const tick_sender& sender)
+		{
+			//模拟时钟从09:00:00开始，每轮行情前进500毫秒
+			daytm_t current_time = 9 * 3600 * ONE_SECOND_MILLISECONDS;
+			uint64_t volume = 0;
+			uint32_t round = 0;
+			auto next_time = std::chrono::steady_clock::now();
+			while (_is_runing)
+			{
+				std::vector<std::pair<std::string, std::string>> id_list;
+				{
+					std::lock_guard<std::mutex> lock(_mutex);
+					id_list.assign(_subscribed.begin(), _subscribed.end());
+				}
+				for (const auto& it : id_list)
+				{
+					next_time = wait_until(next_time + std::chrono::microseconds(interval_us));
+					if (!_is_runing)
+					{
+						break;
+					}
+					journal_record record{};
+					record.code = code_t(it.first.c_str(), it.second.c_str());
+					record.time = daytm_sequence(current_time);
+					record.trading_day = trading_day;
+					const double_t price = 4000 + static_cast<double_t>(round % 20);
+					volume += 3;
+					record.price = price;
+					record.volume = volume;
+					record.open_interest = 100000;
+					record.bid_price[0] = price - 1;
+					record.bid_volume[0] = 10;
+					record.ask_price[0] = price + 1;
+					record.ask_volume[0] = 10;
+					//开盘价 收盘价 最高价 最低价 涨停价 跌停价 昨结算价
+					const double_t extend[] = { 4000, 4000, 4020, 4000, 4400, 3600, 4000 };
+					std::copy(std::begin(extend), std::end(extend), std::begin(record.extend));
+					sender(record);
+				}
+				if (id_list.empty())
+				{
+					next_time = wait_until(next_time + std::chrono::microseconds(interval_us));
+				}
+				current_time += 500;
+				round++;
+			}
+		}
+
+		std::chrono::steady_clock::time_point wait_until(std::chrono::steady_clock::time_point next_time)
+		{
+			//落后时从当前时间重新计时，不补发积压的行情，避免突发行情影响延迟统计
+			auto now = std::chrono::steady_clock::now();
+			if (next_time <= now)
+			{
+				return now;
+			}
+			std::this_thread::sleep_until(next_time);
+			return next_time;
+		}
+
+		bool is_subscribed(const char* id)
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			return _subscribed.find(id) != _subscribed.end();
+		}
+	};
+}
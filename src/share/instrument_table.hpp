@@ -0,0 +1,315 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include <define.h>
+#include <define_types.hpp>
+#include <binary_stream.hpp>
+#include <log_wapper.hpp>
+#include <rapidcsv.h>
+#include <fstream>
+#include <filesystem>
+
+namespace lt
+{
+	enum class charge_type
+	{
+		CT_FIXED_AMOUNT = 1,//固定金额
+		CT_PRICE_RATIO = 2,//价格比例
+	};
+
+	/*
+	*	合约静态信息（最小变动价位、乘数、保证金率、手续费）
+	*/
+	struct instrument_info
+	{
+		code_t code;
+
+		//没有配置最小变动价位的合约按1处理
+		double_t price_step;
+
+		charge_type crge_type;
+		double_t open_charge;
+		double_t close_today_charge;
+		double_t close_yestoday_charge;
+
+		double_t multiple; //乘数
+		double_t margin_rate; //保证金率
+
+		instrument_info() :price_step(1.0), crge_type(charge_type::CT_FIXED_AMOUNT), open_charge(.0F), close_today_charge(.0F), close_yestoday_charge(.0F), multiple(.0F), margin_rate(.0F) {}
+
+		inline double_t get_service_charge(double_t price, offset_type offset)const
+		{
+			if (crge_type == charge_type::CT_FIXED_AMOUNT)
+			{
+				if (offset == offset_type::OT_OPEN)
+				{
+					return open_charge;
+				}
+				else if (offset == offset_type::OT_CLSTD)
+				{
+					return close_today_charge;
+				}
+				else
+				{
+					return close_yestoday_charge;
+				}
+			}
+			if (crge_type == charge_type::CT_PRICE_RATIO)
+			{
+				if (offset == offset_type::OT_OPEN)
+				{
+					return open_charge * price * multiple;
+				}
+				else if (offset == offset_type::OT_CLSTD)
+				{
+					return close_today_charge * price * multiple;
+				}
+				else
+				{
+					return close_yestoday_charge * price * multiple;
+				}
+			}
+			return .0F;
+		}
+	};
+
+	//没有配置的合约按默认值处理（最小变动价位为1）
+	const instrument_info default_instrument;
+
+	/***
+	*
+	* 合约信息表
+	* 启动时由 price_step.csv 和 contract.csv 合并生成，之后只读；
+	* 合约按稠密下标连续存放，持有下标的调用方直接按下标读取
+	* 可以保存成二进制缓存，配置没有变化时启动直接加载缓存
+	*/
+	class instrument_table
+	{
+		//缓存文件头 "LTIT"
+		static constexpr uint32_t CACHE_MAGIC = 0x5449544C;
+
+		static constexpr uint32_t CACHE_VERSION = 1;
+
+	private:
+
+		std::vector<instrument_info> _instruments;
+
+		std::map<code_t, instrument_index> _index;
+
+	public:
+
+		/*
+		*	@price_step_path	最小变动价位配置，可以为空
+		*	@contract_path	合约乘数、保证金、手续费配置，可以为空
+		*	@cache_path	二进制缓存，为空不使用缓存；缓存比两个配置都新时直接加载，否则加载配置以后重新生成
+		*/
+		bool init(const std::string& price_step_path, const std::string& contract_path, const std::string& cache_path = std::string())
+		{
+			if (!cache_path.empty() && is_cache_valid(cache_path, price_step_path, contract_path))
+			{
+				if (load_cache(cache_path))
+				{
+					LOG_INFO("instrument_table load cache :", cache_path, _instruments.size());
+					return true;
+				}
+			}
+			clear();
+			if (!price_step_path.empty())
+			{
+				load_price_step(price_step_path);
+			}
+			if (!contract_path.empty())
+			{
+				load_contract(contract_path);
+			}
+			LOG_INFO("instrument_table init :", _instruments.size());
+			if (!cache_path.empty())
+			{
+				save_cache(cache_path);
+			}
+			return true;
+		}
+
+		size_t size()const
+		{
+			return _instruments.size();
+		}
+
+		instrument_index get_index(const code_t& code)const
+		{
+			auto it = _index.find(code);
+			if (it == _index.end())
+			{
+				return INVALID_INSTRUMENT_INDEX;
+			}
+			return it->second;
+		}
+
+		const instrument_info& get_instrument(instrument_index index)const
+		{
+			return _instruments[index];
+		}
+
+		const instrument_info* get_instrument(const code_t& code)const
+		{
+			instrument_index index = get_index(code);
+			if (index == INVALID_INSTRUMENT_INDEX)
+			{
+				return nullptr;
+			}
+			return &_instruments[index];
+		}
+
+		//没有配置按1处理，提示由解析下标的调用方负责（只在解析时提示一次）
+		double_t get_price_step(const code_t& code)const
+		{
+			const instrument_info* info = get_instrument(code);
+			if (info == nullptr)
+			{
+				return default_instrument.price_step;
+			}
+			return info->price_step;
+		}
+
+		bool save_cache(const std::string& cache_path)const
+		{
+			std::vector<uint8_t> data;
+			binary_writer writer(data);
+			writer.write(CACHE_MAGIC).write(CACHE_VERSION).write(static_cast<uint32_t>(_instruments.size()));
+			writer.write(_instruments.data(), _instruments.size() * sizeof(instrument_info));
+			std::ofstream file(cache_path, std::ios::binary | std::ios::trunc);
+			if (!file.is_open())
+			{
+				LOG_ERROR("instrument_table save_cache cant open file :", cache_path);
+				return false;
+			}
+			file.write(reinterpret_cast<const char*>(data.data()), data.size());
+			return file.good();
+		}
+
+		bool load_cache(const std::string& cache_path)
+		{
+			std::ifstream file(cache_path, std::ios::binary);
+			if (!file.is_open())
+			{
+				return false;
+			}
+			std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+			binary_reader reader(data);
+			uint32_t magic = 0, version = 0, count = 0;
+			reader.read(magic);
+			reader.read(version);
+			reader.read(count);
+			if (magic != CACHE_MAGIC || version != CACHE_VERSION)
+			{
+				LOG_WARNING("instrument_table cache not match :", cache_path, version);
+				return false;
+			}
+			std::vector<instrument_info> instruments(count);
+			if (!reader.read(instruments.data(), count * sizeof(instrument_info)))
+			{
+				LOG_WARNING("instrument_table cache broken :", cache_path);
+				return false;
+			}
+			clear();
+			for (const auto& it : instruments)
+			{
+				_index[it.code] = static_cast<instrument_index>(_instruments.size());
+				_instruments.emplace_back(it);
+			}
+			return true;
+		}
+
+	private:
+
+		void clear()
+		{
+			_instruments.clear();
+			_index.clear();
+		}
+
+		instrument_info& get_or_insert(const code_t& code)
+		{
+			auto it = _index.find(code);
+			if (it != _index.end())
+			{
+				return _instruments[it->second];
+			}
+			_index[code] = static_cast<instrument_index>(_instruments.size());
+			instrument_info& info = _instruments.emplace_back();
+			info.code = code;
+			return info;
+		}
+
+		void load_price_step(const std::string& config_path)
+		{
+			rapidcsv::Document config_csv(config_path, rapidcsv::LabelParams(0, -1));
+			for (size_t i = 0; i < config_csv.GetRowCount(); i++)
+			{
+				const std::string& code_str = config_csv.GetCell<std::string>("code", i);
+				if (!code_str.empty())
+				{
+					get_or_insert(code_str.c_str()).price_step = config_csv.GetCell<double_t>("price_step", i);
+				}
+			}
+		}
+
+		void load_contract(const std::string& config_path)
+		{
+			rapidcsv::Document config_csv(config_path, rapidcsv::LabelParams(0, -1));
+			for (size_t i = 0; i < config_csv.GetRowCount(); i++)
+			{
+				const std::string& code_str = config_csv.GetCell<std::string>("code", i);
+				if (code_str.empty())
+				{
+					continue;
+				}
+				instrument_info& info = get_or_insert(code_str.c_str());
+				info.crge_type = static_cast<charge_type>(config_csv.GetCell<int32_t>("charge_type", i));
+				info.open_charge = config_csv.GetCell<double_t>("open_charge", i);
+				info.close_today_charge = config_csv.GetCell<double_t>("close_today_charge", i);
+				info.close_yestoday_charge = config_csv.GetCell<double_t>("close_yestoday_charge", i);
+				info.multiple = config_csv.GetCell<double_t>("multiple", i);
+				info.margin_rate = config_csv.GetCell<double_t>("margin_rate", i);
+			}
+		}
+
+		static bool is_cache_valid(const std::string& cache_path, const std::string& price_step_path, const std::string& contract_path)
+		{
+			std::error_code ec;
+			if (!std::filesystem::exists(cache_path, ec))
+			{
+				return false;
+			}
+			const auto cache_time = std::filesystem::last_write_time(cache_path, ec);
+			for (const auto& path : { price_step_path, contract_path })
+			{
+				if (!path.empty() && std::filesystem::exists(path, ec) && cache_time < std::filesystem::last_write_time(path, ec))
+				{
+					return false;
+				}
+			}
+			return !ec;
+		}
+	};
+}
@@ -30,6 +30,9 @@ EXPORT_FLAG lt::actual_market* create_actual_market(const lt::params& config);
 
 EXPORT_FLAG void destory_actual_market(lt::actual_market*& api);
 
+//多路行情仲裁，feeds的所有权转给返回的行情接口
+EXPORT_FLAG lt::actual_market* create_composite_market(const std::vector<lt::actual_market*>& feeds);
+
 EXPORT_FLAG lt::actual_trader* create_actual_trader(const lt::params& config);
 
 EXPORT_FLAG void destory_actual_trader(lt::actual_trader*& api);
@@ -24,12 +24,16 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include "define.h"
 #include "define_types.hpp"
 #include "event_center.hpp"
+#include "shared_types.h"
 namespace lt
 {
 	enum class market_event_type
 	{
 		MET_Invalid,
+		//参数为tick_info、tick_extend和本地接收时间（纳秒）
 		MET_TickReceived,
+		//同一时间点的一批tick，参数为const tick_frame*，回调结束后失效
+		MET_TickFrame,
 	};
 	/*
 	 *	行情解析模块接口
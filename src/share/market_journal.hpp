@@ -0,0 +1,123 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+#include <define.h>
+#include <shared_types.h>
+#include <time_utils.hpp>
+#include <chrono>
+
+namespace lt
+{
+	/*
+	*	行情日志（实盘行情落盘，回测时作为tick_loader直接回放）
+	*	文件按交易日滚动：<journal_path>/<交易日>_<序号>.mj，文件头以后是定长记录
+	*/
+
+	//文件头 "LTMJ"
+	constexpr uint32_t JOURNAL_MAGIC = 0x4A4D544C;
+
+	constexpr uint32_t JOURNAL_VERSION = 1;
+
+	constexpr size_t JOURNAL_DEPTH = std::tuple_size<price_volume_array>::value;
+
+	struct journal_header
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t record_size;
+		uint32_t trading_day;
+	};
+
+	struct journal_record
+	{
+		//本地接收时间（系统时钟纳秒）
+		int64_t receive_time;
+		code_t code;
+		daytm_t time;
+		uint32_t trading_day;
+		double_t price;
+		uint64_t volume;
+		double_t open_interest;
+		double_t bid_price[JOURNAL_DEPTH];
+		uint32_t bid_volume[JOURNAL_DEPTH];
+		double_t ask_price[JOURNAL_DEPTH];
+		uint32_t ask_volume[JOURNAL_DEPTH];
+		//和适配器发出的tick_extend顺序一致
+		double_t extend[std::tuple_size<tick_extend>::value];
+
+		journal_record() = default;
+
+		journal_record(const tick_info& tick, const tick_extend& extend_data, int64_t receive) :
+			receive_time(receive),
+			code(tick.id),
+			time(tick.time),
+			trading_day(tick.trading_day),
+			price(tick.price),
+			volume(tick.volume),
+			open_interest(tick.open_interest)
+		{
+			for (size_t i = 0; i < JOURNAL_DEPTH; i++)
+			{
+				bid_price[i] = tick.bid_order[i].first;
+				bid_volume[i] = tick.bid_order[i].second;
+				ask_price[i] = tick.ask_order[i].first;
+				ask_volume[i] = tick.ask_order[i].second;
+			}
+			std::apply([this](auto... value)->void {
+				size_t i = 0;
+				((extend[i++] = value), ...);
+			}, extend_data);
+		}
+
+		void to_tick(tick_detail& tick)const
+		{
+			tick.id = code;
+			tick.time = time;
+			tick.receive_time = get_receive_daytm();
+			tick.receive_ns = receive_time;
+			tick.trading_day = trading_day;
+			tick.price = price;
+			tick.volume = volume;
+			tick.open_interest = open_interest;
+			for (size_t i = 0; i < JOURNAL_DEPTH; i++)
+			{
+				tick.bid_order[i] = std::make_pair(bid_price[i], bid_volume[i]);
+				tick.ask_order[i] = std::make_pair(ask_price[i], ask_volume[i]);
+			}
+			tick.extend = std::make_tuple(extend[0], extend[1], extend[2], extend[3], extend[4], extend[5], extend[6]);
+		}
+
+		//接收时间换算成日内时间
+		daytm_t get_receive_daytm()const
+		{
+			const time_t second = static_cast<time_t>(receive_time / 1000000000LL);
+			const daytm_t millisecond = static_cast<daytm_t>((receive_time / 1000000LL) % ONE_SECOND_MILLISECONDS);
+			return daytm_sequence(static_cast<daytm_t>(second - get_day_begin(second)) * ONE_SECOND_MILLISECONDS + millisecond);
+		}
+	};
+
+	static inline int64_t journal_receive_time()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	}
+}
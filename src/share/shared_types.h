@@ -68,5 +68,13 @@ namespace lt
 	};
 	struct tick_detail : public tick_info {
 		std::tuple<double_t, double_t, double_t, double_t, double_t, double_t, double_t> extend;
+		//本地接收时间，回放时按这个时间分帧（没有接收时间的数据源和time一致）
+		daytm_t receive_time;
+		//本地接收时间（系统时钟纳秒），同一毫秒内按这个时间排序，没有时为0
+		int64_t receive_ns;
+
+		tick_detail() :receive_time(0), receive_ns(0) {}
 	};
+
+	typedef std::vector<const tick_detail*> tick_frame;
 }
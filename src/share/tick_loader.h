@@ -32,6 +32,8 @@ namespace lt::driver
 	{
 	public:
 
+		virtual ~tick_loader() = default;
+
 		virtual void load_tick(std::vector<tick_detail>& result, const code_t& code, uint32_t trade_day) = 0;
 	};
 }
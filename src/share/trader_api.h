@@ -78,6 +78,15 @@ namespace lt
 		*/
 		virtual std::shared_ptr<trader_data> get_trader_data() = 0;
 
+		/**
+		* 获取资金账户（不支持查询资金的接口返回空账户）
+		*/
+		virtual const account_info& get_account()
+		{
+			static account_info empty_account;
+			return empty_account;
+		}
+
 		/*
 		*	绑定事件
 		*/
@@ -111,6 +120,24 @@ namespace lt
 		*/
 		virtual bool is_idle()const = 0;
 
+		/*
+		*	热备会话设置
+		*	primary不为空时作为primary的热备：登录后只同步订单镜像，不派发事件，直到take_over接管
+		*	primary为空时作为主会话正常派发事件
+		*	不支持热备的接口返回false
+		*/
+		virtual bool set_standby(const actual_trader* /*primary*/)
+		{
+			return false;
+		}
+
+		/*
+		*	热备会话接管
+		*	known 上层已经处理到的未完成委托，按订单镜像补发上层没有收到的成交、撤销和委托回报，然后作为主会话派发事件
+		*	is_pending 上层还在等待回报的委托（已完成但不在known里的委托只对这些补发）
+		*/
+		virtual void take_over(const entrust_map& /*known*/, const std::function<bool(estid_t)>& /*is_pending*/) {}
+
 
 	protected:
 
@@ -188,7 +215,20 @@ namespace lt
 
 		virtual void crossday(uint32_t trading_day) = 0;
 
-		virtual const account_info& get_account() = 0;
+		/*
+		*	保存交易日快照（账户、持仓、挂单），用于增量回测
+		*/
+		virtual void save_snapshot(std::vector<uint8_t>& data)const = 0;
+
+		/*
+		*	从快照恢复，数据不完整返回false
+		*/
+		virtual bool load_snapshot(const std::vector<uint8_t>& data) = 0;
+
+		/*
+		*	模拟柜台里的订单，回报事件触发时订单还在（包括下单失败的订单），找不到返回default_order
+		*/
+		virtual const order_info& get_order(estid_t estid)const = 0;
 
 		virtual void bind_event(trader_event_type type, std::function<void(const std::vector<std::any>&)> handle)override
 		{
@@ -24,6 +24,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include <event_center.hpp>
 #include <thread>
 #include "tick_loader/csv_tick_loader.h"
+#include "tick_loader/journal_tick_loader.h"
 #include <log_wapper.hpp>
 
 using namespace lt;
@@ -38,21 +39,31 @@ _is_finished(false),
 _state(execute_state::ES_Idle)
 {
 	std::string loader_type;
-	std::string csv_data_path;
+	std::string data_path;
 	try
 	{
 		_interval = config.get<uint32_t>("interval");
 		loader_type = config.get<std::string>("loader_type");
-		csv_data_path = config.get<std::string>("csv_data_path");
+		//行情日志回放使用journal_data_path
+		data_path = config.get<std::string>(loader_type == "journal" ? "journal_data_path" : "csv_data_path");
 	}
 	catch (...)
 	{
 		LOG_ERROR("tick_simulator init error ");
 	}
+	try
+	{
+		tick_cache::instance().set_capacity(config.get<uint32_t>("cache_size"));
+	}
+	catch (...)
+	{
+		//不配置使用默认缓存大小
+	}
+	_data_source = loader_type + ":" + data_path;
 	if (loader_type == "csv")
 	{
 		csv_tick_loader* loader = new csv_tick_loader();
-		if (!loader->init(csv_data_path))
+		if (!loader->init(data_path))
 		{
 			delete loader;
 		}
@@ -62,6 +73,18 @@ _state(execute_state::ES_Idle)
 		}
 		
 	}
+	else if (loader_type == "journal")
+	{
+		journal_tick_loader* loader = new journal_tick_loader();
+		if (!loader->init(data_path))
+		{
+			delete loader;
+		}
+		else
+		{
+			_loader = loader;
+		}
+	}
 	
 }
 market_simulator::~market_simulator()
@@ -124,31 +147,32 @@ void market_simulator::load_data()
 {
 	if(_loader)
 	{
-		for(auto& it : _instrument_id_list)
-		{
-			_loader->load_tick(_pending_tick_info, it, _current_trading_day);
-		}
+		_pending_tick_info = tick_cache::instance().load(_loader, _data_source, _instrument_id_list, _current_trading_day);
 		_state = execute_state::ES_PublishTick;
 	}
 }
 
 void market_simulator::publish_tick()
 {	
-	if (_current_index >= _pending_tick_info.size())
+	if (_pending_tick_info == nullptr || _current_index >= _pending_tick_info->size())
 	{
+		//没有数据直接结束，避免回测一直等待
+		finish_publish();
 		return;
 	}
-	const tick_detail* tick = &(_pending_tick_info[_current_index]);
-	_current_time = tick->time;
-	std::vector<const tick_detail*> current_tick;
-	
-	while(_current_time == tick->time)
+	const auto& pending_tick_info = *_pending_tick_info;
+	const tick_detail* tick = &(pending_tick_info[_current_index]);
+	_current_time = tick->receive_time;
+	_current_frame.clear();
+	_current_tick.clear();
+	while(_current_time == tick->receive_time)
 	{
-		current_tick.emplace_back(tick);
+		_current_frame.emplace_back(tick);
+		_current_tick.emplace_back(tick);
 		_current_index++;
-		if(_current_index < _pending_tick_info.size())
+		if(_current_index < pending_tick_info.size())
 		{
-			tick = &(_pending_tick_info[_current_index]);
+			tick = &(pending_tick_info[_current_index]);
 		}
 		else
 		{
@@ -159,21 +183,13 @@ void market_simulator::publish_tick()
 
 	if (_publish_callback)
 	{
-		std::vector<const tick_info*> tick_info;
-		for (auto tick : current_tick)
-		{
-			tick_info.emplace_back(tick);
-		}
-		_publish_callback(tick_info);
-	}
-
-	for(auto tick : current_tick)
-	{
-		PROFILE_INFO(tick->id.get_id());
-		fire_event(market_event_type::MET_TickReceived, *static_cast<const tick_info*>(tick),tick->extend);
+		_publish_callback(_current_tick);
 	}
+	//整帧一次性发布，不再逐个tick打包事件参数
+	const tick_frame* frame = &_current_frame;
+	fire_event(market_event_type::MET_TickFrame, frame);
 
-	if (_current_index >= _pending_tick_info.size())
+	if (_current_index >= pending_tick_info.size())
 	{
 		finish_publish();
 	}
@@ -183,7 +199,7 @@ void market_simulator::finish_publish()
 {
 	_current_time = 0;
 	_current_index = 0;
-	_pending_tick_info.clear();
+	_pending_tick_info.reset();
 	_instrument_id_list.clear();
 	_is_finished = true;
 	_state = execute_state::ES_Idle;
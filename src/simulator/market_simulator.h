@@ -25,6 +25,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include <market_api.h>
 #include <tick_loader.h>
 #include <params.hpp>
+#include "tick_cache.h"
 
 namespace lt::driver
 {
@@ -42,11 +43,20 @@ namespace lt::driver
 
 		tick_loader* _loader;
 
+		//数据源标识，用于共享缓存
+		std::string _data_source;
+
 		std::set<code_t> _instrument_id_list;
 
 		uint32_t _current_trading_day;
 
-		std::vector<tick_detail> _pending_tick_info;
+		//只读数据，可能被同进程的其他模拟器共享
+		tick_buffer _pending_tick_info;
+
+		//当前帧，复用内存避免每帧分配
+		tick_frame _current_frame;
+
+		std::vector<const tick_info*> _current_tick;
 
 		std::function<void(const std::vector<const tick_info*>&)> _publish_callback;
 
@@ -0,0 +1,112 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "tick_cache.h"
+#include <log_wapper.hpp>
+#include <algorithm>
+
+using namespace lt;
+using namespace lt::driver;
+
+tick_buffer tick_cache::load(tick_loader* loader, const std::string& source, const std::set<code_t>& codes, uint32_t trading_day)
+{
+	std::string key = source + "|" + std::to_string(trading_day);
+	for (const auto& it : codes)
+	{
+		key.append("|");
+		key.append(it.get_excg());
+		key.append(".");
+		key.append(it.get_id());
+	}
+	std::shared_future<tick_buffer> result;
+	std::promise<tick_buffer> loading;
+	bool need_load = false;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		auto it = _cache.find(key);
+		if (it != _cache.end())
+		{
+			result = it->second;
+		}
+		else
+		{
+			result = loading.get_future().share();
+			_cache[key] = result;
+			_load_order.emplace_back(key);
+			shrink();
+			need_load = true;
+		}
+	}
+	if (need_load)
+	{
+		try
+		{
+			auto buffer = std::make_shared<std::vector<tick_detail>>();
+			if (loader)
+			{
+				for (const auto& it : codes)
+				{
+					loader->load_tick(*buffer, it, trading_day);
+				}
+			}
+			LOG_INFO("tick_cache load :", key, buffer->size());
+			loading.set_value(buffer);
+		}
+		catch (...)
+		{
+			//加载失败时唤醒所有等待者并移出缓存，下次重新加载
+			LOG_ERROR("tick_cache load failed :", key);
+			loading.set_exception(std::current_exception());
+			std::lock_guard<std::mutex> lock(_mutex);
+			auto it = _cache.find(key);
+			if (it != _cache.end())
+			{
+				_cache.erase(it);
+				_load_order.erase(std::remove(_load_order.begin(), _load_order.end(), key), _load_order.end());
+			}
+		}
+	}
+	return result.get();
+}
+
+void tick_cache::set_capacity(size_t capacity)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_capacity = capacity;
+	shrink();
+}
+
+tick_cache& tick_cache::instance()
+{
+	static tick_cache cache(2);
+	return cache;
+}
+
+void tick_cache::shrink()
+{
+	//使用中的数据由持有者的shared_ptr保证有效，这里只释放缓存的引用
+	while (_load_order.size() > _capacity && !_load_order.empty())
+	{
+		_cache.erase(_load_order.front());
+		_load_order.pop_front();
+	}
+}
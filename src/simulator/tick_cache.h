@@ -20,40 +20,51 @@ OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHE
 IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
 OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
-#include "price_step.h"
-#include <define_types.hpp>
-#include <rapidcsv.h>
-#include "log_wapper.hpp"
-#include <time_utils.hpp>
+#pragma once
+#include <define.h>
+#include <mutex>
+#include <future>
+#include <deque>
+#include <tick_loader.h>
 
-using namespace lt::hft;
-
-price_step::price_step(const std::string& config_path)
+namespace lt::driver
 {
-	LOG_INFO("price_step init ");
-	_price_step_data.clear();
-	rapidcsv::Document config_csv(config_path, rapidcsv::LabelParams(0, -1));
-	for (size_t i = 0; i < config_csv.GetRowCount(); i++)
+	typedef std::shared_ptr<const std::vector<tick_detail>> tick_buffer;
+
+	/*
+	 *	进程内共享的只读tick数据
+	 *	同一数据源、同一组合约、同一交易日只加载一次，多个market_simulator共享同一份内存
+	 */
+	class tick_cache
 	{
-		const std::string& code_str = config_csv.GetCell<std::string>("code", i);
-		if(!code_str.empty())
-		{
-			double_t price_step = config_csv.GetCell<double_t>("price_step", i);
-			_price_step_data[code_str.c_str()] = price_step;
-		}
-	}
-}
-price_step::~price_step()
-{
 
-}
+	private:
 
-double_t price_step::get_price_step(const code_t& code)const
-{
-	auto it = _price_step_data.find(code);
-	if(it != _price_step_data.end())
-	{
-		return it->second;
-	}
-	return 1.0;
+		std::mutex _mutex;
+
+		std::map<std::string, std::shared_future<tick_buffer>> _cache;
+
+		//按加载顺序淘汰
+		std::deque<std::string> _load_order;
+
+		size_t _capacity;
+
+	public:
+
+		tick_cache(size_t capacity) :_capacity(capacity) {}
+
+		/*
+		 *	获取交易日数据，缓存中没有时用loader加载
+		 *	正在被其他线程加载的数据会等待加载完成
+		 */
+		tick_buffer load(tick_loader* loader, const std::string& source, const std::set<code_t>& codes, uint32_t trading_day);
+
+		void set_capacity(size_t capacity);
+
+		static tick_cache& instance();
+
+	private:
+
+		void shrink();
+	};
 }
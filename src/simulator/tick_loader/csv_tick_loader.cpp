@@ -77,6 +77,7 @@ void csv_tick_loader::load_tick(std::vector<tick_detail>& result , const code_t&
 			last_second = current_second;
 		}
 		tick.time = make_daytm(time_str.c_str(), current_tick);
+		tick.receive_time = tick.time;
 		tick.price = std::stod(cell[4]);
 		tick.volume = std::stoi(cell[11]);
 		tick.open_interest = std::stoi(cell[13]);
@@ -0,0 +1,119 @@
+﻿/*
+Distributed under the MIT License(MIT)
+
+Copyright(c) 2023 Jihua Zou EMail: ghuazo@qq.com QQ:137336521
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files(the "Software"), to deal in the
+Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and /or sell copies
+of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "journal_tick_loader.h"
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <market_journal.hpp>
+#include <log_wapper.hpp>
+
+using namespace lt::driver;
+
+bool journal_tick_loader::init(const std::string& root_path)
+{
+	if (!std::filesystem::is_directory(root_path))
+	{
+		LOG_ERROR("journal path not exists :", root_path);
+		return false;
+	}
+	_root_path = root_path;
+	return true;
+}
+
+void journal_tick_loader::load_tick(std::vector<tick_detail>& result, const code_t& code, uint32_t trade_day)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (_cache_day != trade_day)
+	{
+		load_day(trade_day);
+	}
+	auto it = _cache.find(code);
+	if (it == _cache.end())
+	{
+		return;
+	}
+	const size_t middle = result.size();
+	result.insert(result.end(), it->second.begin(), it->second.end());
+	//多个合约的日志混在一起，按纳秒接收时间合并，同一毫秒内也保持到达顺序，接收时间相同前面的合约在前
+	std::inplace_merge(result.begin(), result.begin() + middle, result.end(), [](const auto& lh, const auto& rh)->bool {
+		return lh.receive_ns < rh.receive_ns;
+	});
+}
+
+void journal_tick_loader::load_day(uint32_t trade_day)
+{
+	_cache.clear();
+	_cache_day = trade_day;
+	//同一个交易日的文件按序号顺序读取
+	const std::string prefix = std::to_string(trade_day) + "_";
+	std::vector<std::filesystem::path> files;
+	for (const auto& entry : std::filesystem::directory_iterator(_root_path))
+	{
+		const auto& filename = entry.path().filename().string();
+		if (entry.is_regular_file() && filename.compare(0, prefix.size(), prefix) == 0 && entry.path().extension() == ".mj")
+		{
+			files.emplace_back(entry.path());
+		}
+	}
+	if (files.empty())
+	{
+		LOG_ERROR("cant find journal in path:", _root_path, trade_day);
+		return;
+	}
+	std::sort(files.begin(), files.end());
+	std::vector<journal_record> buffer(1024);
+	for (const auto& path : files)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file.is_open())
+		{
+			LOG_ERROR("cant open file :", path.string());
+			continue;
+		}
+		journal_header header;
+		if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != JOURNAL_MAGIC || header.version != JOURNAL_VERSION || header.record_size != sizeof(journal_record))
+		{
+			LOG_ERROR("journal file header error :", path.string());
+			continue;
+		}
+		while (file)
+		{
+			file.read(reinterpret_cast<char*>(buffer.data()), sizeof(journal_record) * buffer.size());
+			//最后一条可能是进程退出时没写完的半条记录，直接丢弃
+			const size_t count = static_cast<size_t>(file.gcount()) / sizeof(journal_record);
+			for (size_t i = 0; i < count; i++)
+			{
+				tick_detail tick;
+				buffer[i].to_tick(tick);
+				_cache[buffer[i].code].emplace_back(tick);
+			}
+		}
+	}
+	//按纳秒接收时间稳定排序，接收时间相同保持落盘顺序
+	for (auto& it : _cache)
+	{
+		std::stable_sort(it.second.begin(), it.second.end(), [](const auto& lh, const auto& rh)->bool {
+			return lh.receive_ns < rh.receive_ns;
+		});
+	}
+}
@@ -21,26 +21,37 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
 OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 #pragma once
-#include <rapidcsv.h>
-#include <define.h>
-
-namespace lt::hft{
-
-	class price_step
+#include <tick_loader.h>
+#include <map>
+#include <mutex>
+namespace lt::driver
+{
+	/*
+	*	行情日志回放（读取实盘落盘的 <交易日>_<序号>.mj 文件）
+	*	按本地接收时间排序，回放时保留实盘收到行情的先后和间隔
+	*	同一个交易日的日志只解码一次，按合约拆开缓存，后面的合约直接从缓存取
+	*/
+	class journal_tick_loader : public tick_loader
 	{
+	public:
+		bool init(const std::string& root_path);
 
 	public:
-		price_step(const std::string& config_path);
-		virtual ~price_step();
+		virtual void load_tick(std::vector<tick_detail>& result, const code_t& code, uint32_t trade_day) override;
 
 	private:
 
-		std::map<code_t, double_t> _price_step_data;
+		//解码一个交易日的所有日志，按合约拆开
+		void load_day(uint32_t trade_day);
 
-	public:
+	private:
 
-		double_t get_price_step(const code_t& code)const;
-	};
+		std::string _root_path;
 
-}
+		std::mutex _mutex;
+
+		uint32_t _cache_day = 0U;
 
+		std::map<code_t, std::vector<tick_detail>> _cache;
+	};
+}
@@ -22,9 +22,9 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 */
 #include "trader_simulator.h"
 #include <event_center.hpp>
-#include "contract_parser.h"
 #include "./tick_loader/csv_tick_loader.h"
 #include <log_wapper.hpp>
+#include <binary_stream.hpp>
 
 using namespace lt;
 using namespace lt::driver;
@@ -39,7 +39,7 @@ trader_simulator::trader_simulator(const params& config) :
 	{
 		_account_info.money = config.get<double_t>("initial_capital");
 		auto contract_file = config.get<std::string>("contract_config");
-		_contract_parser.init(contract_file);
+		_instrument_table.init(std::string(), contract_file);
 		_interval = config.get<uint32_t>("interval");
 	}
 	catch (...)
@@ -53,13 +53,45 @@ trader_simulator::~trader_simulator()
 }
 
 
+size_t trader_simulator::frame_data::add_slot(const code_t& id)
+{
+	size_t slot = code.size();
+	code.emplace_back(id);
+	time.emplace_back(0);
+	price.emplace_back(.0F);
+	volume.emplace_back(0);
+	last_volume.emplace_back(0);
+	deal_volume.emplace_back(0);
+	bid_price.emplace_back();
+	bid_volume.emplace_back();
+	ask_price.emplace_back();
+	ask_volume.emplace_back();
+	ready.emplace_back(0);
+	return slot;
+}
+
+void trader_simulator::frame_data::assign(size_t slot, const tick_info& tick)
+{
+	time[slot] = tick.time;
+	price[slot] = tick.price;
+	volume[slot] = tick.volume;
+	for (size_t i = 0; i < PRICE_VOLUME_SIZE; i++)
+	{
+		bid_price[slot][i] = tick.bid_order[i].first;
+		bid_volume[slot][i] = tick.bid_order[i].second;
+		ask_price[slot][i] = tick.ask_order[i].first;
+		ask_volume[slot][i] = tick.ask_order[i].second;
+	}
+	ready[slot] = 1;
+}
+
 void trader_simulator::push_tick(const std::vector<const tick_info*>& current_tick)
 {
 	for(auto tick : current_tick)
 	{
 		if(tick)
 		{
-			_current_tick_info[tick->id] = *tick;
+			_frame.assign(get_slot(tick->id), *tick);
 		}
 	}
 	
@@ -68,6 +100,9 @@ void trader_simulator::push_tick(const std::vector<const tick_info*>& current_ti
 void trader_simulator::crossday(uint32_t trading_day)
 {
 	_trading_day = trading_day;
+	//成交量按交易日累计，换日以后从零开始算增量
+	std::fill(_frame.volume.begin(), _frame.volume.end(), 0);
+	std::fill(_frame.last_volume.begin(), _frame.last_volume.end(), 0);
 	std::vector<order_info> order;
 	for (auto& it : _order_info)
 	{
@@ -103,12 +138,21 @@ uint32_t trader_simulator::get_trading_day()const
 
 void trader_simulator::update()
 {
-	for (const auto& tk_it : _current_tick_info)
+	const size_t slot_count = _frame.size();
+	//整帧计算成交量增量
+	for (size_t i = 0; i < slot_count; i++)
 	{
-		_current_time = tk_it.second.time;
-		match_entrust(tk_it.second);
-		_last_frame_volume[tk_it.second.id] = tk_it.second.volume;
+		_frame.deal_volume[i] = static_cast<uint32_t>(_frame.volume[i] - _frame.last_volume[i]);
+	}
+	for (size_t i = 0; i < slot_count; i++)
+	{
+		if (_frame.ready[i] && !_order_match[i].empty())
+		{
+			_current_time = _frame.time[i];
+			match_entrust(i);
+		}
 	}
+	std::copy(_frame.volume.begin(), _frame.volume.end(), _frame.last_volume.begin());
 	/*
 	double_t frozen_monery = .0;
 	for(const auto& it : _order_info)
@@ -132,7 +176,7 @@ void trader_simulator::update()
 		{
 			continue;
 		}
-		auto contract_info = _contract_parser.get_contract_info(it.second.code);
+		auto contract_info = _instrument_table.get_instrument(it.second.code);
 		if (contract_info == nullptr)
 		{
 			LOG_ERROR("tick_simulator frozen_deduction cant find the contract_info for", it.second.code.get_id());
@@ -142,7 +186,7 @@ void trader_simulator::update()
 	}
 	for (const auto& it : _position_info)
 	{
-		auto contract_info = _contract_parser.get_contract_info(it.first);
+		auto contract_info = _instrument_table.get_instrument(it.first);
 		if (contract_info == nullptr)
 		{
 			LOG_ERROR("tick_simulator frozen_deduction cant find the contract_info for", it.first.get_id());
@@ -161,6 +205,114 @@ void trader_simulator::update()
 	*/
 }
 
+void trader_simulator::save_snapshot(std::vector<uint8_t>& data)const
+{
+	binary_writer writer(data);
+	writer.write(_trading_day).write(_current_time).write(_order_ref).write(_account_info);
+	writer.write(static_cast<uint32_t>(_position_info.size()));
+	for (const auto& it : _position_info)
+	{
+		writer.write(it.first).write(it.second);
+	}
+	//挂单按槽位保存，恢复以后撮合队列顺序不变
+	uint32_t order_count = 0;
+	for (const auto& match : _order_match)
+	{
+		order_count += static_cast<uint32_t>(match.size());
+	}
+	writer.write(order_count);
+	for (const auto& match : _order_match)
+	{
+		for (const auto& mch : match)
+		{
+			auto odit = _order_info.find(mch.estid);
+			if (odit == _order_info.end())
+			{
+				//只有撮合信息没有订单，写一个无效订单占位，恢复时跳过
+				writer.write(INVALID_ESTID);
+				continue;
+			}
+			const auto& order = odit->second;
+			writer.write(order.estid).write(order.code).write(order.unit_id);
+			writer.write(order.total_volume).write(order.last_volume).write(order.create_time);
+			writer.write(order.offset).write(order.direction).write(order.price);
+			writer.write(mch.queue_seat).write(mch.state).write(mch.flag);
+		}
+	}
+}
+
+bool trader_simulator::load_snapshot(const std::vector<uint8_t>& data)
+{
+	binary_reader reader(data);
+	uint32_t trading_day = 0;
+	daytm_t current_time = 0;
+	uint32_t order_ref = 0;
+	account_info account;
+	reader.read(trading_day);
+	reader.read(current_time);
+	reader.read(order_ref);
+	reader.read(account);
+	std::map<code_t, position_detail> position_info;
+	uint32_t position_count = 0;
+	reader.read(position_count);
+	for (uint32_t i = 0; i < position_count && reader.good(); i++)
+	{
+		code_t code;
+		position_detail pos;
+		reader.read(code);
+		reader.read(pos);
+		position_info[code] = pos;
+	}
+	std::vector<std::pair<order_info, order_match>> orders;
+	uint32_t order_count = 0;
+	reader.read(order_count);
+	for (uint32_t i = 0; i < order_count && reader.good(); i++)
+	{
+		order_info order;
+		reader.read(order.estid);
+		if (order.estid == INVALID_ESTID)
+		{
+			continue;
+		}
+		order_flag flag = order_flag::OF_NOR;
+		order_match match(order.estid, flag);
+		reader.read(order.code);
+		reader.read(order.unit_id);
+		reader.read(order.total_volume);
+		reader.read(order.last_volume);
+		reader.read(order.create_time);
+		reader.read(order.offset);
+		reader.read(order.direction);
+		reader.read(order.price);
+		reader.read(match.queue_seat);
+		reader.read(match.state);
+		reader.read(match.flag);
+		orders.emplace_back(order, match);
+	}
+	if (!reader.good())
+	{
+		LOG_ERROR("tick_simulator load_snapshot data broken", data.size());
+		return false;
+	}
+	_trading_day = trading_day;
+	_current_time = current_time;
+	_order_ref = order_ref;
+	_account_info = account;
+	_position_info.swap(position_info);
+	_order_info.clear();
+	for (auto& match : _order_match)
+	{
+		match.clear();
+	}
+	for (const auto& it : orders)
+	{
+		_order_info[it.first.estid] = it.first;
+		_order_match[get_slot(it.first.code)].emplace_back(it.second);
+	}
+	LOG_INFO("tick_simulator load_snapshot", _trading_day, _position_info.size(), _order_info.size());
+	return true;
+}
+
 bool trader_simulator::is_usable()const
 {
 	return true ;
@@ -183,12 +335,12 @@ estid_t trader_simulator::place_order(offset_type offset, direction_type directi
 	order.direction = direction;
 	order.total_volume = count;
 	order.last_volume = count;
+	size_t slot = get_slot(code);
 	if (price == .0F)
 	{
-		auto tick_it = _current_tick_info.find(code);
-		if (tick_it != _current_tick_info.end())
+		if (_frame.ready[slot])
 		{
-			order.price = tick_it->second.price;
+			order.price = _frame.price[slot];
 		}
 	}
 	else
@@ -197,7 +349,7 @@ estid_t trader_simulator::place_order(offset_type offset, direction_type directi
 	}
 	_order_info[order.estid] = order;
 	LOG_TRACE("order_container add_order", order.code.get_id(), order.estid, _order_info.size());
-	_order_match[order.code].emplace_back(order_match(order.estid, flag));
+	_order_match[slot].emplace_back(order_match(order.estid, flag));
 	return order.estid;
 }
 
@@ -209,16 +361,17 @@ bool trader_simulator::cancel_order(estid_t estid)
 	{
 		return false;
 	}
-	auto it = _order_match.find(odit->second.code);
-	if (it == _order_match.end())
+	auto it = _slot_index.find(odit->second.code);
+	if (it == _slot_index.end())
 	{
 		return false;
 	}
-	auto od_it = std::find_if(it->second.begin(), it->second.end(), [estid](const order_match& cur) ->bool {
+	auto& match = _order_match[it->second];
+	auto od_it = std::find_if(match.begin(), match.end(), [estid](const order_match& cur) ->bool {
 
 		return cur.estid == estid;
 		});
-	if (od_it == it->second.end())
+	if (od_it == match.end())
 	{
 		return false;
 	}
@@ -234,6 +387,16 @@ bool trader_simulator::cancel_order(estid_t estid)
 }
 
 
+const order_info& trader_simulator::get_order(estid_t estid)const
+{
+	auto it = _order_info.find(estid);
+	if (it == _order_info.end())
+	{
+		return default_order;
+	}
+	return it->second;
+}
+
 std::shared_ptr<trader_data> trader_simulator::get_trader_data()
 {
 	auto result = std::make_shared<trader_data>();
@@ -270,134 +433,128 @@ estid_t trader_simulator::make_estid()
 	return v1 + v2 + v3;
 }
 
-uint32_t trader_simulator::get_buy_front(const code_t& code,double_t price)
+size_t trader_simulator::get_slot(const code_t& code)
 {
-	auto tick_it = _current_tick_info.find(code);
-	if(tick_it == _current_tick_info.end())
+	auto it = _slot_index.find(code);
+	if (it != _slot_index.end())
 	{
-		return 0U;
+		return it->second;
 	}
-	const auto& tick = tick_it->second;
-	auto buy_it = std::find_if(tick.bid_order.begin(), tick.bid_order.end(), [price](const std::pair<double_t, uint32_t>& cur) ->bool {
+	size_t slot = _frame.add_slot(code);
+	_order_match.emplace_back();
+	_slot_instrument.emplace_back(_instrument_table.get_index(code));
+	_slot_index[code] = slot;
+	return slot;
+}
 
-		return cur.first == price;
-		});
-	if (buy_it != tick.bid_order.end())
+const instrument_info* trader_simulator::get_instrument(size_t slot)const
+{
+	const instrument_index index = _slot_instrument[slot];
+	if (index == INVALID_INSTRUMENT_INDEX)
 	{
-		return buy_it->second;
+		return nullptr;
 	}
-
-	return 0U;
+	return &_instrument_table.get_instrument(index);
 }
-uint32_t trader_simulator::get_sell_front(const code_t& code, double_t price)
+
+uint32_t trader_simulator::get_buy_front(size_t slot, double_t price)const
 {
-	auto tick_it = _current_tick_info.find(code);
-	if (tick_it == _current_tick_info.end())
+	const auto& bid_price = _frame.bid_price[slot];
+	for (size_t i = 0; i < PRICE_VOLUME_SIZE; i++)
 	{
-		return 0U;
+		if (bid_price[i] == price)
+		{
+			return _frame.bid_volume[slot][i];
+		}
 	}
-	const auto& tick = tick_it->second;
-	auto sell_it = std::find_if(tick.ask_order.begin(), tick.ask_order.end(), [price](const std::pair<double_t, uint32_t>& cur) ->bool {
-
-		return cur.first == price;
-		});
-	if (sell_it != tick.ask_order.end())
+	return 0U;
+}
+uint32_t trader_simulator::get_sell_front(size_t slot, double_t price)const
+{
+	const auto& ask_price = _frame.ask_price[slot];
+	for (size_t i = 0; i < PRICE_VOLUME_SIZE; i++)
 	{
-		return sell_it->second;
+		if (ask_price[i] == price)
+		{
+			return _frame.ask_volume[slot][i];
+		}
 	}
 	return 0U;
 }
 
-void trader_simulator::match_entrust(const tick_info& tick)
+void trader_simulator::match_entrust(size_t slot)
 {
-	uint32_t current_volume = static_cast<uint32_t>(tick.volume);
-	auto last_volume = _last_frame_volume.find(tick.id);
-	if(last_volume != _last_frame_volume.end())
+	uint32_t current_volume = _frame.deal_volume[slot];
+	//撮合过程中回调可能继续下单（同一个合约追加订单、新合约追加槽位都会让容器重新分配），
+	//这里不持有引用，每次按槽位和下标重新取
+	for (size_t i = 0; i < _order_match[slot].size(); i++)
 	{
-		current_volume = static_cast<uint32_t>(tick.volume - last_volume->second);
-	}
-	auto it = _order_match.find(tick.id);
-	if (it != _order_match.end())
-	{
-		for (order_match& mc_it : it->second)
+		auto od_it = _order_info.find(_order_match[slot][i].estid);
+		if(od_it != _order_info.end())
 		{
-			auto od_it = _order_info.find(mc_it.estid);
-			if(od_it != _order_info.end())
-			{
-				handle_entrust(tick, mc_it, od_it->second, current_volume);
-			}
+			handle_entrust(slot, i, od_it->second, current_volume);
 		}
 	}
-	
-	for(auto mc_it = _order_match.begin();mc_it != _order_match.end();){
-		for(auto it = mc_it->second.begin();it!= mc_it->second.end();){
-			if(it->state == OS_DELETE)
+	auto& match = _order_match[slot];
+	for(auto it = match.begin();it!= match.end();){
+		if(it->state == OS_DELETE)
+		{
+			auto odit = _order_info.find(it->estid);
+			if (odit != _order_info.end())
 			{
-				auto odit = _order_info.find(it->estid);
-				if (odit != _order_info.end())
-				{
 
-					LOG_INFO("remove_order", it->estid);
-					_order_info.erase(odit);
-				}
-				it = mc_it->second.erase(it);
-			}
-			else
-			{
-				++it;
+				LOG_INFO("remove_order", it->estid);
+				_order_info.erase(odit);
 			}
-		}
-		if(mc_it->second.empty())
-		{
-			mc_it = _order_match.erase(mc_it);
+			it = match.erase(it);
 		}
 		else
 		{
-			mc_it++;
+			++it;
 		}
 	}
 }
 
-void trader_simulator::handle_entrust(const tick_info& tick, order_match& match, order_info& order, uint32_t max_volume)
+void trader_simulator::handle_entrust(size_t slot, size_t index, order_info& order, uint32_t max_volume)
 {
-	if (match.state == OS_CANELED)
+	order_match* match = &_order_match[slot][index];
+	if (match->state == OS_CANELED)
 	{
 		//撤单
-		order_cancel(order);
+		order_cancel(slot, order);
 		return;
 	}
-	if(match.state == OS_INVALID)
+	if(match->state == OS_INVALID)
 	{
-		error_code err = frozen_deduction(order.estid, order.code, order.offset, order.direction, order.last_volume, order.price);
+		error_code err = frozen_deduction(slot, order.estid, order.code, order.offset, order.direction, order.last_volume, order.price);
 		if (err != error_code::EC_Success)
 		{
 			order_error(error_type::ET_PLACE_ORDER,order.estid, err);
 			return;
 		}
 		this->fire_event(trader_event_type::TET_OrderPlace, order);
-
-		visit_match_info(order.estid, [this, &order](order_match& mh)->void {
-			if (order.is_buy())
-			{
-				mh.queue_seat = this->get_buy_front(order.code, order.price);
-			}
-			else if (order.is_sell())
-			{
-				mh.queue_seat = this->get_sell_front(order.code, order.price);
-			}
-			mh.state = OS_IN_MATCH;
-		});
+		//回调里可能下单，重新取
+		match = &_order_match[slot][index];
+		if (order.is_buy())
+		{
+			match->queue_seat = get_buy_front(slot, order.price);
+		}
+		else if (order.is_sell())
+		{
+			match->queue_seat = get_sell_front(slot, order.price);
+		}
+		match->state = OS_IN_MATCH;
 	}
 
 	if (order.direction == direction_type::DT_LONG)
 	{	
 		if(order.offset == offset_type::OT_OPEN)
 		{
-			handle_buy(tick, match, order, max_volume);
+			handle_buy(slot, *match, order, max_volume);
 		}
 		else
 		{
-			handle_sell(tick, match, order, max_volume);
+			handle_sell(slot, *match, order, max_volume);
 		}
 		
 	}
@@ -405,64 +562,66 @@ void trader_simulator::handle_entrust(const tick_info& tick, order_match& match,
 	{
 		if (order.offset == offset_type::OT_OPEN)
 		{
-			handle_sell(tick, match, order, max_volume);
+			handle_sell(slot, *match, order, max_volume);
 		}
 		else
 		{
-			handle_buy(tick, match, order, max_volume);
+			handle_buy(slot, *match, order, max_volume);
 		}
 	}
 }
-void trader_simulator::handle_sell(const tick_info& tick,order_match& match, order_info& order, uint32_t max_volume)
+void trader_simulator::handle_sell(size_t slot, order_match& match, order_info& order, uint32_t max_volume)
 {
+	const double_t buy_price = _frame.bid_price[slot][0];
+	const double_t last_price = _frame.price[slot];
 
 	if (match.flag == order_flag::OF_FOK)
 	{
-		if (order.last_volume <= max_volume && order.price <= tick.buy_price())
+		if (order.last_volume <= max_volume && order.price <= buy_price)
 		{
 			//全成
-			order_deal(order, order.last_volume);
+			order_deal(slot, order, order.last_volume);
 		}
 		else
 		{
 			//全撤
-			order_cancel(order);
+			order_cancel(slot, order);
 		}
 	}
 	else if (match.flag == order_flag::OF_FAK)
 	{
-		if(order.price <= tick.buy_price())
+		if(order.price <= buy_price)
 		{
 			//部成
 			uint32_t deal_volume = order.last_volume > max_volume ? max_volume : order.last_volume;
 			if (deal_volume > 0)
 			{
-				order_deal(order, deal_volume);
+				order_deal(slot, order, deal_volume);
 			}
 			uint32_t cancel_volume = order.last_volume - max_volume;
 			if (cancel_volume > 0)
 			{
 				//部撤
-				order_cancel(order);
+				order_cancel(slot, order);
 			}
 		}
 		else
 		{
-			order_cancel(order);
+			order_cancel(slot, order);
 		}
 	}
 	else
 	{
-		if (order.price <= tick.buy_price())
+		if (order.price <= buy_price)
 		{
 			//不需要排队，直接降价成交
 			uint32_t deal_volume = order.last_volume > max_volume ? max_volume : order.last_volume;
 			if (deal_volume > 0)
 			{
-				order_deal(order, deal_volume);
+				order_deal(slot, order, deal_volume);
 			}
 		}
-		else if (order.price <= tick.price)
+		else if (order.price <= last_price)
 		{
 			//排队成交，移动排队位置
 			int32_t new_seat = match.queue_seat - max_volume;
@@ -475,7 +634,7 @@ void trader_simulator::handle_sell(const tick_info& tick,order_match& match, ord
 				uint32_t deal_volume = order.last_volume > can_deal_volume ? can_deal_volume : order.last_volume;
 				if (deal_volume > 0U)
 				{
-					order_deal(order, deal_volume);
+					order_deal(slot, order, deal_volume);
 				}
 			}
 			else
@@ -489,58 +648,60 @@ void trader_simulator::handle_sell(const tick_info& tick,order_match& match, ord
 
 }
 
-void trader_simulator::handle_buy(const tick_info& tick, order_match& match, order_info& order, uint32_t max_volume)
+void trader_simulator::handle_buy(size_t slot, order_match& match, order_info& order, uint32_t max_volume)
 {
+	const double_t sell_price = _frame.ask_price[slot][0];
+	const double_t last_price = _frame.price[slot];
 
 	if (match.flag == order_flag::OF_FOK)
 	{
-		if (order.last_volume <= max_volume&& order.price >= tick.sell_price())
+		if (order.last_volume <= max_volume&& order.price >= sell_price)
 		{
 			//全成
-			order_deal(order, order.last_volume);
+			order_deal(slot, order, order.last_volume);
 		}
 		else
 		{
 			//全撤
-			order_cancel(order);
+			order_cancel(slot, order);
 		}
 	}
 	else if (match.flag == order_flag::OF_FAK)
 	{
 		//部成
-		if(order.price >= tick.sell_price())
+		if(order.price >= sell_price)
 		{
 			uint32_t deal_volume = order.last_volume > max_volume ? max_volume : order.last_volume;
 			if (deal_volume > 0U)
 			{
-				order_deal(order, deal_volume);
+				order_deal(slot, order, deal_volume);
 			}
 			uint32_t cancel_volume = order.last_volume - max_volume;
 			if (cancel_volume > 0)
 			{
 				//部撤
-				order_cancel(order);
+				order_cancel(slot, order);
 			}
 		}
 		else
 		{
-			order_cancel(order);
+			order_cancel(slot, order);
 		}
 		
 	}
 	else
 	{
 		//剩下都不是第一帧自动撤销的订单
-		if (order.price >= tick.sell_price())
+		if (order.price >= sell_price)
 		{
 			//不需要排队，直接降价成交
 			uint32_t deal_volume = order.last_volume > max_volume ? max_volume : order.last_volume;
 			if (deal_volume > 0)
 			{
-				order_deal(order, deal_volume);
+				order_deal(slot, order, deal_volume);
 			}
 		}
-		else if (order.price >= tick.price)
+		else if (order.price >= last_price)
 		{
 			//有排队的情况
 			//排队成交，移动排队位置
@@ -554,7 +715,7 @@ void trader_simulator::handle_buy(const tick_info& tick, order_match& match, ord
 				uint32_t deal_volume = order.last_volume > can_deal_volume ? can_deal_volume : order.last_volume;
 				if (deal_volume > 0)
 				{
-					order_deal(order, deal_volume);
+					order_deal(slot, order, deal_volume);
 				}
 			}
 			else
@@ -565,10 +726,10 @@ void trader_simulator::handle_buy(const tick_info& tick, order_match& match, ord
 	}
 }
 
-void trader_simulator::order_deal(order_info& order, uint32_t deal_volume)
+void trader_simulator::order_deal(size_t slot, order_info& order, uint32_t deal_volume)
 {
 	
-	auto contract_info = _contract_parser.get_contract_info(order.code);
+	auto contract_info = get_instrument(slot);
 	if(contract_info == nullptr)
 	{
 		LOG_ERROR("tick_simulator order_deal cant find the contract_info for", order.code.get_id());
@@ -676,7 +837,7 @@ void trader_simulator::order_error(error_type type,estid_t estid, error_code err
 		mh.state = OS_DELETE;
 		});
 }
-void trader_simulator::order_cancel(const order_info& order)
+void trader_simulator::order_cancel(size_t slot, const order_info& order)
 {
 	auto it = _order_info.find(order.estid);
 	if(it == _order_info.end())
@@ -685,7 +846,7 @@ void trader_simulator::order_cancel(const order_info& order)
 	}
 	if(order.last_volume>0)
 	{
-		if(unfrozen_deduction(order.code, order.offset, order.direction, order.last_volume, order.price))
+		if(unfrozen_deduction(slot, order.code, order.offset, order.direction, order.last_volume, order.price))
 		{
 			LOG_INFO(" order_cancel _order_info.del_order", order.estid);
 			fire_event(trader_event_type::TET_OrderCancel, order.estid, order.code, order.offset, order.direction, order.price, order.last_volume, order.total_volume);
@@ -706,13 +867,14 @@ void trader_simulator::visit_match_info(estid_t estid,std::function<void(order_m
 	auto odit = _order_info.find(estid);
 	if (odit != _order_info.end())
 	{
-		auto match = _order_match.find(odit->second.code);
-		if (match != _order_match.end())
+		auto slot = _slot_index.find(odit->second.code);
+		if (slot != _slot_index.end())
 		{
-			auto mch_odr = std::find_if(match->second.begin(), match->second.end(), [estid](const order_match& p)->bool {
+			auto& match = _order_match[slot->second];
+			auto mch_odr = std::find_if(match.begin(), match.end(), [estid](const order_match& p)->bool {
 				return p.estid == estid;
 				});
-			if (mch_odr != match->second.end())
+			if (mch_odr != match.end())
 			{
 				cursor(*mch_odr);
 			}
@@ -720,9 +882,9 @@ void trader_simulator::visit_match_info(estid_t estid,std::function<void(order_m
 	}
 }
 
-error_code trader_simulator::frozen_deduction(estid_t estid,const code_t& code,offset_type offset, direction_type direction,uint32_t volume,double_t price)
+error_code trader_simulator::frozen_deduction(size_t slot, estid_t estid,const code_t& code,offset_type offset, direction_type direction,uint32_t volume,double_t price)
 {
-	auto contract_info = _contract_parser.get_contract_info(code);
+	auto contract_info = get_instrument(slot);
 	if (contract_info == nullptr)
 	{
 		LOG_ERROR("tick_simulator frozen_deduction cant find the contract_info for", code.get_id());
@@ -791,9 +953,9 @@ error_code trader_simulator::frozen_deduction(estid_t estid,const code_t& code,o
 	}
 	return error_code::EC_Success;
 }
-bool trader_simulator::unfrozen_deduction(const code_t& code, offset_type offset, direction_type direction, uint32_t last_volume, double_t price)
+bool trader_simulator::unfrozen_deduction(size_t slot, const code_t& code, offset_type offset, direction_type direction, uint32_t last_volume, double_t price)
 {
-	auto contract_info = _contract_parser.get_contract_info(code);
+	auto contract_info = get_instrument(slot);
 	if (contract_info == nullptr)
 	{
 		LOG_ERROR("tick_simulator frozen_deduction cant find the contract_info for ", code.get_id());
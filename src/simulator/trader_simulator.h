@@ -24,12 +24,13 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include <define.h>
 #include <trader_api.h>
 #include <params.hpp>
-#include "contract_parser.h"
+#include <instrument_table.hpp>
 
 namespace lt::driver
 {
 	class trader_simulator : public dummy_trader
 	{
+		static constexpr size_t PRICE_VOLUME_SIZE = std::tuple_size<price_volume_array>::value;
 
 		enum order_state
 		{
@@ -131,6 +132,37 @@ namespace lt::driver
 		};
 
 
+		/*
+		*	撮合帧数据（SoA），按合约槽位索引
+		*	槽位在合约第一次出现时分配，之后整帧撮合只遍历连续内存，不再按帧分配
+		*/
+		struct frame_data
+		{
+			std::vector<code_t>		code;
+			std::vector<daytm_t>	time;
+			std::vector<double_t>	price;
+			std::vector<uint64_t>	volume;
+			//上一帧的成交量，用于计算上一帧到这一帧成交了多少
+			std::vector<uint64_t>	last_volume;
+			//本帧成交量增量
+			std::vector<uint32_t>	deal_volume;
+			std::vector<std::array<double_t, PRICE_VOLUME_SIZE>>	bid_price;
+			std::vector<std::array<uint32_t, PRICE_VOLUME_SIZE>>	bid_volume;
+			std::vector<std::array<double_t, PRICE_VOLUME_SIZE>>	ask_price;
+			std::vector<std::array<uint32_t, PRICE_VOLUME_SIZE>>	ask_volume;
+			//是否收到过行情
+			std::vector<uint8_t>	ready;
+
+			size_t size()const
+			{
+				return code.size();
+			}
+
+			size_t add_slot(const code_t& id);
+
+			void assign(size_t slot, const tick_info& tick);
+		};
+
 	private:
 
 
@@ -141,20 +173,24 @@ namespace lt::driver
 		uint32_t _order_ref;
 
 		//撮合时候用
-		std::map<code_t, tick_info> _current_tick_info;
+		frame_data _frame;
 
-		//上一帧的成交量，用于计算上一帧到这一帧成交了多少
-		std::map<code_t, uint64_t> _last_frame_volume;
+		//合约到槽位的映射
+		std::map<code_t, size_t> _slot_index;
+
+		//槽位对应的合约信息下标，分配槽位时解析一次，撮合时直接按下标读取
+		std::vector<instrument_index> _slot_instrument;
 
 		account_info _account_info;
 
 		uint32_t	_interval;			//间隔毫秒数
 
-		contract_parser	_contract_parser;	//合约信息配置
+		instrument_table	_instrument_table;	//合约信息配置
 
 		std::map<estid_t, order_info> _order_info;
 
-		std::map<code_t, std::vector<order_match>> _order_match;
+		//按槽位索引
+		std::vector<std::vector<order_match>> _order_match;
 
 		std::map<code_t, position_detail> _position_info;
 
@@ -178,6 +214,12 @@ namespace lt::driver
 
 		virtual void update()override;
 
+		virtual void save_snapshot(std::vector<uint8_t>& data)const override;
+
+		virtual bool load_snapshot(const std::vector<uint8_t>& data) override;
+
+		virtual const order_info& get_order(estid_t estid)const override;
+
 	public:
 
 		virtual uint32_t get_trading_day()const override;
@@ -194,29 +236,36 @@ namespace lt::driver
 
 		estid_t make_estid();
 
-		uint32_t get_buy_front(const code_t& code, double_t price);
+		size_t get_slot(const code_t& code);
+
+		//槽位的合约信息，没有配置返回nullptr
+		const instrument_info* get_instrument(size_t slot)const;
+
+		uint32_t get_buy_front(size_t slot, double_t price)const;
 
-		uint32_t get_sell_front(const code_t& code, double_t price);
+		uint32_t get_sell_front(size_t slot, double_t price)const;
 
-		void match_entrust(const tick_info& tick);
+		void match_entrust(size_t slot);
 
-		void handle_entrust(const tick_info& tick, order_match& match, order_info& order, uint32_t max_volume);
+		//index是订单在槽位里的下标，回调以后按下标重新取撮合信息
+		void handle_entrust(size_t slot, size_t index, order_info& order, uint32_t max_volume);
 
-		void handle_sell(const tick_info& tick, order_match& match, order_info& order, uint32_t deal_volume);
+		//match只在回调（order_deal/order_cancel）之前访问
+		void handle_sell(size_t slot, order_match& match, order_info& order, uint32_t deal_volume);
 
-		void handle_buy(const tick_info& tick, order_match& match, order_info& order, uint32_t deal_volume);
+		void handle_buy(size_t slot, order_match& match, order_info& order, uint32_t deal_volume);
 
-		void order_deal(order_info& order, uint32_t deal_volume);
+		void order_deal(size_t slot, order_info& order, uint32_t deal_volume);
 
 		void order_error(error_type type, estid_t estid, error_code err);
 
-		void order_cancel(const order_info& order);
+		void order_cancel(size_t slot, const order_info& order);
 
 		void visit_match_info(estid_t estid, std::function<void(order_match&)> cursor);
 		//冻结
-		error_code frozen_deduction(estid_t estid, const code_t& code, offset_type offset, direction_type direction, uint32_t count, double_t price);
+		error_code frozen_deduction(size_t slot, estid_t estid, const code_t& code, offset_type offset, direction_type direction, uint32_t count, double_t price);
 		//解冻
-		bool unfrozen_deduction(const code_t& code, offset_type offset, direction_type direction, uint32_t last_volume, double_t price);
+		bool unfrozen_deduction(size_t slot, const code_t& code, offset_type offset, direction_type direction, uint32_t last_volume, double_t price);
 
 	};
 }